@@ -48,7 +48,7 @@ void AppBuffer_writeData( AppBuffer_Buffer *hbuffer, unsigned char data )
         
         if((hbuffer -> Head + 1) == (hbuffer -> Elements))
         {
-            hbuffer -> Head_wrap = 1;
+            hbuffer -> Head_wrap ^= 1u;   /* Toggled, so it still differs from Tail_wrap on every lap */
             hbuffer -> Head = 0;
         } 
         else
@@ -75,8 +75,8 @@ unsigned char AppBuffer_readData( AppBuffer_Buffer *hbuffer )
 
         if((hbuffer -> Tail + 1) == ( hbuffer -> Elements))
         {
-            hbuffer -> Tail_wrap = 1;
-            hbuffer -> Tail = 0; /* Set flag Tail wrap */    
+            hbuffer -> Tail_wrap ^= 1u;   /* Toggle flag Tail wrap */
+            hbuffer -> Tail = 0;
         }
         else
         {
@@ -52,7 +52,7 @@ uint8_t AppQueue_writeData( AppQue_Queue *queue, void *data )
 
         if((queue -> Head + 1) == (queue -> Elements))
         {   
-            queue -> Head_wrap = 1;
+            queue -> Head_wrap ^= 1u;   /* Toggled, so it still differs from Tail_wrap on every lap */
             queue -> Head = 0;
         }
         else
@@ -79,7 +79,7 @@ uint8_t AppQueue_readData( AppQue_Queue *queue, void *data )
         memcpy(data, read_position, queue -> Size);
         if ((queue -> Tail + 1) == (queue -> Elements))
         {
-            queue -> Tail_wrap = 1;     /* SET FLAG TAIL WRAP */
+            queue -> Tail_wrap ^= 1u;   /* TOGGLE FLAG TAIL WRAP */
             queue -> Tail = 0;           
         }
         else
@@ -0,0 +1,154 @@
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include "Scheduler.h"
+#include "Queue.h"
+#include "Task_Event.h"
+#include "Message_Bus.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define BENCH_MESSAGES          200000u     /* Messages published per measure */
+#define BENCH_SIZE              240u        /* Payload bytes, the copy queues hold at most 255 */
+#define BENCH_DEPTH             8u          /* Queue elements of every subscriber */
+
+/*----------------------------------------------------------------------------*/
+/*                               Global Variables                             */
+/*----------------------------------------------------------------------------*/
+
+static AppSched_Scheduler Loop;             /* Never started, the posts only need its time source */
+static AppBus_Bus Bus;
+static AppBus_Subscriber Subscriber[BUS_SUBSCRIBERS_N];
+static AppBus_Message *Pointers[BUS_SUBSCRIBERS_N][BENCH_DEPTH];
+static AppQue_Queue PointerQueue[BUS_SUBSCRIBERS_N];
+static AppEvt_Event CopyEvent[BUS_SUBSCRIBERS_N];
+static unsigned char Copies[BUS_SUBSCRIBERS_N][BENCH_DEPTH][BENCH_SIZE];
+static AppQue_Queue CopyQueue[BUS_SUBSCRIBERS_N];
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+double MeasureCopy(uint32_t subscribers);
+double MeasureBus(uint32_t subscribers, uint32_t size);
+
+/*----------------------------------------------------------------------------*/
+/*                                  Main                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Fans a 240 byte message out to 1 to 16 subscribers, as copies and through the bus.
+ *
+ * The bus also sends a full buffer, a queue element cannot hold more than 255 bytes.
+ *
+ * Both cost a publish and every subscriber reading the message back, in one thread. The
+ * messages are published BENCH_DEPTH at a time and then read, like an event task does.
+ */
+int main( void )
+{
+    Loop.timeSource = NULL;
+
+    printf("subscribers, copy ns/message, bus ns/message, bus %u bytes ns/message\n", (unsigned)BUS_MESSAGE_SIZE);
+    for (uint32_t subscribers = 1u; subscribers <= BUS_SUBSCRIBERS_N; subscribers *= 2u)
+    {
+        printf("%u, %.1f, %.1f, %.1f\n", (unsigned)subscribers, MeasureCopy(subscribers),
+               MeasureBus(subscribers, BENCH_SIZE), MeasureBus(subscribers, BUS_MESSAGE_SIZE));
+    }
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Helper Functions                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Writes a full copy of the message into the queue of every subscriber.
+ */
+double MeasureCopy(uint32_t subscribers)
+{
+    unsigned char message[BENCH_SIZE];
+    unsigned char received[BENCH_SIZE];
+    uint64_t start;
+    uint32_t sum = 0;
+
+    for (uint32_t s = 0; s < subscribers; s++)
+    {
+        CopyQueue[s].Buffer = Copies[s];
+        CopyQueue[s].Elements = BENCH_DEPTH;
+        CopyQueue[s].Size = BENCH_SIZE;
+        AppQueue_initQueue(&CopyQueue[s]);
+        AppEvt_initEvent(&CopyEvent[s], &CopyQueue[s]);
+    }
+    memset(message, 1, sizeof(message));
+
+    start = nanoseconds();
+    for (uint32_t m = 0; m < BENCH_MESSAGES; m += BENCH_DEPTH)
+    {
+        for (uint32_t d = 0; d < BENCH_DEPTH; d++)
+        {
+            message[0] = (unsigned char)d;
+            for (uint32_t s = 0; s < subscribers; s++)
+            {
+                AppSched_postQueue(&Loop, &CopyEvent[s], message);
+            }
+        }
+        for (uint32_t s = 0; s < subscribers; s++)
+        {
+            while (AppEvt_readQueue(&CopyEvent[s], received) == TRUE)
+            {
+                sum += received[0];
+            }
+        }
+    }
+
+    return (double)(nanoseconds() - start) / BENCH_MESSAGES + (double)(sum & 0u);
+}
+
+/**
+ * @brief Writes the message once into the pool and queues a pointer to every subscriber.
+ */
+double MeasureBus(uint32_t subscribers, uint32_t size)
+{
+    unsigned char message[BUS_MESSAGE_SIZE];
+    AppBus_Message *received;
+    uint64_t start;
+    uint32_t sum = 0;
+
+    AppBus_initBus(&Bus);
+    for (uint32_t s = 0; s < subscribers; s++)
+    {
+        PointerQueue[s].Buffer = Pointers[s];
+        PointerQueue[s].Elements = BENCH_DEPTH;
+        PointerQueue[s].Size = sizeof(AppBus_Message *);
+        AppQueue_initQueue(&PointerQueue[s]);
+        AppBus_initSubscriber(&Subscriber[s], &Loop, &PointerQueue[s]);
+        AppBus_subscribe(&Bus, 0u, &Subscriber[s]);
+    }
+    memset(message, 1, sizeof(message));
+
+    start = nanoseconds();
+    for (uint32_t m = 0; m < BENCH_MESSAGES; m += BENCH_DEPTH)
+    {
+        for (uint32_t d = 0; d < BENCH_DEPTH; d++)
+        {
+            message[0] = (unsigned char)d;
+            AppBus_publishCopy(&Bus, 0u, message, size);
+        }
+        for (uint32_t s = 0; s < subscribers; s++)
+        {
+            while ((received = AppBus_receive(&Subscriber[s])) != NULL)
+            {
+                sum += received->data[0];
+                AppBus_release(&Bus, received);
+            }
+        }
+    }
+
+    return (double)(nanoseconds() - start) / BENCH_MESSAGES + (double)(sum & 0u);
+}
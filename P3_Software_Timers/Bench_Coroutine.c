@@ -0,0 +1,218 @@
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include "Scheduler.h"
+#include "Software_Timers.h"
+#include "Queue.h"
+#include "Task_Event.h"
+#include "Task_Coroutine.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define CO_TIMEOUT              1000u       /* Run time of the scheduler in ms */
+#define CO_PERIOD               100u        /* Period of the coroutines in ms */
+#define POST_INTERVAL           7u          /* Time between two posts of the producer in ms */
+#define REQUEST_DEPTH           16u
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/* State of one waiting coroutine, kept across its slices */
+typedef struct _Waiter
+{
+    uint64_t request;                       /* Time the message was posted */
+    uint32_t received;
+    uint64_t totalLatency;
+    uint64_t maxLatency;
+} Waiter;
+
+/*----------------------------------------------------------------------------*/
+/*                               Global Variables                             */
+/*----------------------------------------------------------------------------*/
+
+static AppSched_Scheduler Loop;
+static uint64_t RequestMessages[ REQUEST_DEPTH ];
+static AppQue_Queue RequestQueue = { RequestMessages, REQUEST_DEPTH, sizeof(uint64_t) };
+static AppEvt_Event Requests;               /* Queue read by the coroutines */
+static AppEvt_Event Ready;                  /* Plain event, signaled with every post */
+static AppCo_Thread QueueCo;
+static AppCo_Thread EventCo;
+static Waiter QueueWaiter;
+static Waiter EventWaiter;
+static _Atomic uint64_t Signaled;           /* Time of the last signal of Ready */
+static _Atomic uint8_t Running;
+static uint32_t Posted;
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+uint8_t Co_WaitQueue(AppCo_Thread *co);
+uint8_t Co_PollQueue(AppCo_Thread *co);
+uint8_t Co_WaitEvent(AppCo_Thread *co);
+void Measure(uint8_t woken);
+void *Producer(void *arg);
+void Account(Waiter *waiter, uint64_t posted);
+
+/*----------------------------------------------------------------------------*/
+/*                                  Main                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Posts a message every 7 ms to coroutines with a period of 100 ms and measures the time
+ * from the post to the slice that gets it.
+ *
+ * Runs once with CO_WAIT_QUEUE and CO_WAIT_EVENT, which resume the body when it is posted or
+ * signaled, and once with the queue only polled by CO_WAIT_UNTIL on every release.
+ */
+int main( void )
+{
+    Measure(TRUE);
+    Measure(FALSE);
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Coroutine Functions                             */
+/*----------------------------------------------------------------------------*/
+
+uint8_t Co_WaitQueue(AppCo_Thread *co)
+{
+    Waiter *waiter = co->ctx;
+
+    CO_BEGIN(co);
+    for (;;)
+    {
+        CO_WAIT_QUEUE(co, &Requests, &waiter->request);
+        Account(waiter, waiter->request);
+    }
+    CO_END(co);
+}
+
+uint8_t Co_PollQueue(AppCo_Thread *co)
+{
+    Waiter *waiter = co->ctx;
+
+    CO_BEGIN(co);
+    for (;;)
+    {
+        CO_WAIT_UNTIL(co, AppEvt_readQueue(&Requests, &waiter->request) == TRUE);
+        Account(waiter, waiter->request);
+    }
+    CO_END(co);
+}
+
+uint8_t Co_WaitEvent(AppCo_Thread *co)
+{
+    Waiter *waiter = co->ctx;
+
+    CO_BEGIN(co);
+    for (;;)
+    {
+        CO_WAIT_EVENT(co, &Ready);
+        Account(waiter, Signaled);
+    }
+    CO_END(co);
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Helper Functions                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Runs the coroutines for CO_TIMEOUT ms and prints the latencies.
+ */
+void Measure(uint8_t woken)
+{
+    pthread_t producer;
+
+    Loop.tick = TICK_VAL;
+    Loop.timeout = CO_TIMEOUT;
+    Loop.taskPtr = NULL;
+    Loop.timerPtr = NULL;
+    Loop.timeSource = NULL;
+    Loop.mode = APPSCHED_MODE_TICKLESS;
+    AppSched_initScheduler(&Loop);
+
+    AppQueue_initQueue(&RequestQueue);
+    AppEvt_initEvent(&Requests, &RequestQueue);
+    AppEvt_initEvent(&Ready, NULL);
+    QueueWaiter = (Waiter){ 0 };
+    EventWaiter = (Waiter){ 0 };
+    Posted = 0;
+    AppSched_registerCoroutine(&Loop, &QueueCo, (woken == TRUE) ? Co_WaitQueue : Co_PollQueue, &QueueWaiter, CO_PERIOD);
+    if (woken == TRUE)
+    {
+        AppSched_registerCoroutine(&Loop, &EventCo, Co_WaitEvent, &EventWaiter, CO_PERIOD);
+    }
+
+    atomic_store(&Running, TRUE);
+    pthread_create(&producer, NULL, Producer, NULL);
+    AppSched_startScheduler(&Loop);
+    atomic_store(&Running, FALSE);
+    pthread_join(producer, NULL);
+
+    printf("%s: posted %u, received %u in %u slices, latency avg/max %llu/%llu us\n",
+           (woken == TRUE) ? "CO_WAIT_QUEUE" : "CO_WAIT_UNTIL polled", (unsigned)Posted,
+           (unsigned)QueueWaiter.received, (unsigned)QueueCo.slices,
+           (QueueWaiter.received > 0u) ? (unsigned long long)(QueueWaiter.totalLatency / QueueWaiter.received / 1000u) : 0ull,
+           (unsigned long long)(QueueWaiter.maxLatency / 1000u));
+    if (woken == TRUE)
+    {
+        printf("CO_WAIT_EVENT: signaled %u, received %u in %u slices, latency avg/max %llu/%llu us\n",
+               (unsigned)Posted, (unsigned)EventWaiter.received, (unsigned)EventCo.slices,
+               (EventWaiter.received > 0u) ? (unsigned long long)(EventWaiter.totalLatency / EventWaiter.received / 1000u) : 0ull,
+               (unsigned long long)(EventWaiter.maxLatency / 1000u));
+    }
+
+    AppSched_releaseTasks(&Loop);
+    AppSched_releaseTimers(&Loop);
+}
+
+/**
+ * @brief Posts the time now every POST_INTERVAL ms and signals the plain event after it.
+ *
+ * Starts after the first release, the bodies only reach their wait in their first slice.
+ */
+void *Producer(void *arg)
+{
+    struct timespec first = { 0, (long)(CO_PERIOD + POST_INTERVAL) * (long)NS_PER_MS };
+    struct timespec interval = { 0, (long)POST_INTERVAL * (long)NS_PER_MS };
+    uint64_t now;
+
+    (void)arg;
+    nanosleep(&first, NULL);
+    while (atomic_load(&Running) == TRUE)
+    {
+        nanosleep(&interval, NULL);
+        now = nanoseconds();
+        if (AppSched_postQueue(&Loop, &Requests, &now) == TRUE)
+        {
+            Posted++;
+        }
+        Signaled = now;
+        AppSched_signalEvent(&Loop, &Ready);
+    }
+
+    return NULL;
+}
+
+void Account(Waiter *waiter, uint64_t posted)
+{
+    uint64_t latency = nanoseconds() - posted;
+
+    waiter->received++;
+    waiter->totalLatency += latency;
+    if (latency > waiter->maxLatency)
+    {
+        waiter->maxLatency = latency;
+    }
+}
@@ -0,0 +1,128 @@
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "Scheduler.h"
+#include "Software_Timers.h"
+#include "Time_Source.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define BENCH_TASKS_N           4u
+#define BENCH_TIMERS_N          1u
+#define BENCH_TIMEOUT           (24u * 60u * 60u * 1000u)  /* One simulated day in ms */
+
+/*----------------------------------------------------------------------------*/
+/*                               Global Variables                             */
+/*----------------------------------------------------------------------------*/
+
+static AppSched_Scheduler Bench;
+static AppSched_Task BenchTasks[BENCH_TASKS_N];
+static AppSched_Timer BenchTimers[BENCH_TIMERS_N];
+static AppTime_Source Virtual;
+static uint64_t Hash;           /* Fingerprint of the order and time of every callback */
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+void Task_A(void);
+void Task_B(void);
+void Task_C(void);
+void Task_D(void);
+void Callback_T(void);
+uint64_t Simulate(uint8_t mode);
+
+/*----------------------------------------------------------------------------*/
+/*                                  Main                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Runs one day of schedule on the virtual clock, twice per mode, and compares the runs.
+ *
+ * The time per dispatch is the cost of the dispatch path alone, without any sleep.
+ */
+int main( void )
+{
+    uint8_t modes[2] = { APPSCHED_MODE_TICK, APPSCHED_MODE_TICKLESS };
+
+    for (uint8_t m = 0; m < 2u; m++)
+    {
+        uint64_t first = Simulate(modes[m]);
+        uint64_t start = nanoseconds();
+        uint64_t second = Simulate(modes[m]);
+        uint64_t wall = nanoseconds() - start;
+
+        printf("%s: %u dispatches, %u wakeups, %.3f ms wall, %.1f ns/dispatch, runs %s\n",
+               (modes[m] == APPSCHED_MODE_TICK) ? "tick" : "tickless",
+               (unsigned)Bench.dispatches, (unsigned)Bench.wakeups, wall / 1e6,
+               (double)wall / Bench.dispatches, (first == second) ? "identical" : "DIFFERENT");
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Simulates BENCH_TIMEOUT ms of schedule and returns the fingerprint of the run.
+ */
+uint64_t Simulate(uint8_t mode)
+{
+    uint32_t timer;
+
+    Bench.tick = TICK_VAL;
+    Bench.tasks = BENCH_TASKS_N;
+    Bench.timeout = BENCH_TIMEOUT;
+    Bench.taskPtr = BenchTasks;
+    Bench.timers = BENCH_TIMERS_N;
+    Bench.timerPtr = BenchTimers;
+    Bench.mode = mode;
+    Bench.timeSource = &Virtual;
+    AppTime_initVirtual(&Virtual, 0u);
+    AppSched_initScheduler(&Bench);
+    Hash = 0;
+
+    /* Tickless mode takes any period, tick mode only multiples of the tick */
+    AppSched_registerTask(&Bench, NULL, Task_A, (mode == APPSCHED_MODE_TICK) ? 100u : 7u);
+    AppSched_registerTask(&Bench, NULL, Task_B, (mode == APPSCHED_MODE_TICK) ? 200u : 13u);
+    AppSched_registerTask(&Bench, NULL, Task_C, 500u);
+    AppSched_registerTask(&Bench, NULL, Task_D, 1000u);
+    timer = AppSched_registerTimer(&Bench, 300u, Callback_T);
+    AppSched_startTimer(&Bench, timer);
+
+    AppSched_startScheduler(&Bench);
+    AppSched_releaseTasks(&Bench);
+
+    return Hash;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Task Functions                                  */
+/*----------------------------------------------------------------------------*/
+
+void Task_A(void)
+{
+    Hash = (Hash * 31u) ^ (Bench.now + 1u);
+}
+
+void Task_B(void)
+{
+    Hash = (Hash * 31u) ^ (Bench.now + 2u);
+}
+
+void Task_C(void)
+{
+    Hash = (Hash * 31u) ^ (Bench.now + 3u);
+}
+
+void Task_D(void)
+{
+    Hash = (Hash * 31u) ^ (Bench.now + 4u);
+}
+
+void Callback_T(void)
+{
+    Hash = (Hash * 31u) ^ (Bench.now + 5u);
+}
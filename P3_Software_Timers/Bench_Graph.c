@@ -0,0 +1,176 @@
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "Scheduler.h"
+#include "Software_Timers.h"
+#include "Worker_Pool.h"
+#include "Task_Graph.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define GRAPH_TIMEOUT           1000u       /* Run time of the scheduler in ms */
+#define FAST_PERIOD             10u         /* Period of the fast input in ms */
+#define SLOW_PERIOD             30u         /* Period of the slow input in ms */
+#define STOP_AFTER              500u        /* The join is stopped after this time in ms */
+#define GRAPH_WORKERS           2u
+
+/*----------------------------------------------------------------------------*/
+/*                               Global Variables                             */
+/*----------------------------------------------------------------------------*/
+
+static AppSched_Scheduler Loop;
+static AppPool_Pool Pool;
+static uint32_t JoinID;
+static _Atomic uint32_t FastRuns;
+static _Atomic uint32_t SlowRuns;
+static _Atomic uint32_t JoinRuns;
+static _Atomic uint32_t LastRuns;
+static _Atomic uint32_t LastStopped;        /* Runs of the last task while the join was stopped */
+static _Atomic uint32_t Early;              /* Joins that ran without a new run of one of their inputs */
+static _Atomic uint8_t Stopped;
+static uint32_t FastSeen;                   /* Input runs at the previous join, only the join uses them */
+static uint32_t SlowSeen;
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+void Task_Fast(void);
+void Task_Slow(void);
+void Task_Join(void);
+void Task_Last(void);
+void Callback_Stop(void *ctx);
+void Measure(uint8_t workers);
+
+/*----------------------------------------------------------------------------*/
+/*                                  Main                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Runs a join of a 10 ms and a 30 ms task followed by a last task, inline and on the pool.
+ *
+ * The join must never run before both inputs ran again. Halfway the join is stopped, the last
+ * task keeps running once per cycle. Build with -DAPPSCHED_PROFILING=1u (see make bench) for
+ * the cycle times and the critical path.
+ */
+int main( void )
+{
+    Measure(0u);
+    Measure(GRAPH_WORKERS);
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Task Functions                                  */
+/*----------------------------------------------------------------------------*/
+
+void Task_Fast(void)
+{
+    atomic_fetch_add(&FastRuns, 1u);
+}
+
+void Task_Slow(void)
+{
+    atomic_fetch_add(&SlowRuns, 1u);
+}
+
+void Task_Join(void)
+{
+    uint32_t fast = atomic_load(&FastRuns);
+    uint32_t slow = atomic_load(&SlowRuns);
+
+    if ((fast == FastSeen) || (slow == SlowSeen))
+    {
+        atomic_fetch_add(&Early, 1u);
+    }
+    FastSeen = fast;
+    SlowSeen = slow;
+    atomic_fetch_add(&JoinRuns, 1u);
+}
+
+void Task_Last(void)
+{
+    atomic_fetch_add(&LastRuns, 1u);
+    if (atomic_load(&Stopped) == TRUE)
+    {
+        atomic_fetch_add(&LastStopped, 1u);
+    }
+}
+
+void Callback_Stop(void *ctx)
+{
+    (void)ctx;
+    AppSched_stopTask(&Loop, JoinID);
+    atomic_store(&Stopped, TRUE);
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Helper Functions                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Runs the graph for GRAPH_TIMEOUT ms and prints the runs of every task.
+ */
+void Measure(uint8_t workers)
+{
+    uint32_t fast;
+    uint32_t slow;
+    uint32_t last;
+    uint32_t timer;
+
+    Loop.tick = TICK_VAL;
+    Loop.timeout = GRAPH_TIMEOUT;
+    Loop.taskPtr = NULL;
+    Loop.timerPtr = NULL;
+    Loop.timeSource = NULL;
+    Loop.mode = APPSCHED_MODE_TICKLESS;
+    AppSched_initScheduler(&Loop);
+    if (workers > 0u)
+    {
+        AppSched_initPool(&Loop, &Pool, workers);
+    }
+
+    fast = AppSched_registerTask(&Loop, NULL, Task_Fast, FAST_PERIOD);
+    slow = AppSched_registerTask(&Loop, NULL, Task_Slow, SLOW_PERIOD);
+    JoinID = AppSched_registerTask(&Loop, NULL, Task_Join, FAST_PERIOD);
+    last = AppSched_registerTask(&Loop, NULL, Task_Last, FAST_PERIOD);
+    AppSched_dependTask(&Loop, JoinID, fast);
+    AppSched_dependTask(&Loop, JoinID, slow);
+    AppSched_dependTask(&Loop, last, JoinID);
+    timer = AppSched_createTimer(&Loop, STOP_AFTER, TIMER_MODE_ONE_SHOT, Callback_Stop, NULL);
+    AppSched_startTimer(&Loop, timer);
+
+    atomic_store(&FastRuns, 0u);
+    atomic_store(&SlowRuns, 0u);
+    atomic_store(&JoinRuns, 0u);
+    atomic_store(&LastRuns, 0u);
+    atomic_store(&LastStopped, 0u);
+    atomic_store(&Early, 0u);
+    atomic_store(&Stopped, FALSE);
+    FastSeen = 0;
+    SlowSeen = 0;
+
+    AppSched_startScheduler(&Loop);
+    if (workers > 0u)
+    {
+        AppPool_waitIdle(&Pool);
+        AppPool_stopPool(&Pool);
+    }
+
+    printf("%u workers: fast %u, slow %u, join %u (early %u, skipped %u), last %u (%u with the join stopped)\n",
+           (unsigned)workers, (unsigned)atomic_load(&FastRuns), (unsigned)atomic_load(&SlowRuns),
+           (unsigned)atomic_load(&JoinRuns), (unsigned)atomic_load(&Early),
+           (unsigned)atomic_load(&AppSched_getTask(&Loop, JoinID)->skipped),
+           (unsigned)atomic_load(&LastRuns), (unsigned)atomic_load(&LastStopped));
+#if (APPSCHED_PROFILING == TRUE)
+    AppSched_dumpGraph(&Loop, stdout);
+#endif
+
+    AppSched_releaseTasks(&Loop);
+    AppSched_releaseTimers(&Loop);
+}
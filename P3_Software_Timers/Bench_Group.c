@@ -0,0 +1,163 @@
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "Scheduler.h"
+#include "Software_Timers.h"
+#include "Scheduler_Group.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define GROUP_N                 2u          /* Instances, pinned to CPU 0 and 1 */
+#define GROUP_TIMEOUT           1000u       /* Run time of every instance in ms */
+#define PING_PERIOD             5u          /* Period of Task_Ping in ms */
+#define PINGS_N                 (GROUP_TIMEOUT / PING_PERIOD)
+#define MIGRATE_AT              100u        /* Ping that moves Task_Counter to instance 1 */
+
+/*----------------------------------------------------------------------------*/
+/*                               Global Variables                             */
+/*----------------------------------------------------------------------------*/
+
+static AppGrp_Instance Group[GROUP_N];
+static _Thread_local uint8_t Self;          /* Instance of the calling thread */
+static uint64_t Sent[PINGS_N];              /* Time every ping was posted */
+static uint64_t LatencyTotal;
+static uint64_t LatencyMax;
+static uint32_t Pongs;
+static uint32_t Pings;
+static uint32_t CounterID;
+static uint8_t Migrated;
+static uint32_t Runs[GROUP_N];              /* Runs of Task_Counter on every instance */
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+void Init_0(void);
+void Init_1(void);
+void Task_Ping(void);
+void Task_Counter(void);
+void Task_Idle(void);
+void Pong(AppSched_Scheduler *scheduler, void *ctx);
+
+/*----------------------------------------------------------------------------*/
+/*                                  Main                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Runs two pinned tickless instances, one posts to the other and moves a task over.
+ *
+ * The latency is the time from the post to the call in the target thread, which sleeps in
+ * between, so it includes the wake of its time source.
+ *
+ * Usage: bench_group.exe [SCHED_FIFO priority]
+ */
+int main( int argc, char *argv[] )
+{
+    uint8_t priority = (argc > 1) ? (uint8_t)atoi(argv[1]) : 0u;
+
+    for (uint32_t i = 0; i < GROUP_N; i++)
+    {
+        Group[i].scheduler.tick = TICK_VAL;
+        Group[i].scheduler.timeout = GROUP_TIMEOUT;
+        Group[i].scheduler.taskPtr = NULL;  /* Every instance grows its own tables */
+        Group[i].scheduler.timerPtr = NULL;
+        Group[i].scheduler.timeSource = NULL;
+        Group[i].scheduler.mode = APPSCHED_MODE_TICKLESS;
+        AppGrp_initInstance(&Group[i], (uint16_t)i, priority);
+    }
+
+    /* The init functions run in the thread of their instance */
+    AppSched_registerTask(&Group[0].scheduler, Init_0, Task_Ping, PING_PERIOD);
+    CounterID = AppSched_registerTask(&Group[0].scheduler, NULL, Task_Counter, 10u);
+    AppSched_registerTask(&Group[1].scheduler, Init_1, Task_Idle, GROUP_TIMEOUT);
+
+    if (AppGrp_startGroup(Group, GROUP_N) == FALSE)
+    {
+        printf("Could not start the instances\n");
+        return 1;
+    }
+    AppGrp_joinGroup(Group, GROUP_N);
+
+    for (uint32_t i = 0; i < GROUP_N; i++)
+    {
+        printf("instance %u: cpu %u, pinned %s, realtime %s, wakeups %u, dispatches %u, received %u\n",
+               (unsigned)i, (unsigned)Group[i].cpu, (Group[i].pinned == TRUE) ? "yes" : "no",
+               (Group[i].realtime == TRUE) ? "yes" : "no", (unsigned)Group[i].scheduler.wakeups,
+               (unsigned)Group[i].scheduler.dispatches, (unsigned)Group[i].inbox.received);
+        AppSched_releaseTasks(&Group[i].scheduler);
+        AppSched_releaseTimers(&Group[i].scheduler);
+    }
+
+    printf("posts to instance 1: %u of %u run, latency avg %.0f ns, max %llu ns, full %u\n",
+           (unsigned)Pongs, (unsigned)Pings, (Pongs > 0u) ? (double)LatencyTotal / Pongs : 0.0,
+           (unsigned long long)LatencyMax, (unsigned)atomic_load(&Group[1].inbox.queue.full));
+    printf("Task_Counter: %u runs on instance 0, %u runs on instance 1, moved %s\n",
+           (unsigned)Runs[0], (unsigned)Runs[1], (Migrated == TRUE) ? "yes" : "no");
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Task Functions                                  */
+/*----------------------------------------------------------------------------*/
+
+void Init_0(void)
+{
+    Self = 0;
+}
+
+void Init_1(void)
+{
+    Self = 1;
+}
+
+/**
+ * @brief Posts one ping to instance 1, and moves Task_Counter there half way.
+ */
+void Task_Ping(void)
+{
+    if (Pings < PINGS_N)
+    {
+        Sent[Pings] = nanoseconds();
+        if (AppGrp_post(&Group[1].scheduler, Pong, &Sent[Pings]) == TRUE)
+        {
+            Pings++;
+        }
+    }
+
+    if ((Pings == MIGRATE_AT) && (Migrated == FALSE))
+    {
+        Migrated = AppGrp_migrateTask(&Group[0].scheduler, CounterID, &Group[1].scheduler);
+    }
+}
+
+void Task_Counter(void)
+{
+    Runs[Self]++;
+}
+
+void Task_Idle(void)
+{
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Callback Functions                              */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Runs in the thread of instance 1, ctx is the time of the post.
+ */
+void Pong(AppSched_Scheduler *scheduler, void *ctx)
+{
+    uint64_t latency = nanoseconds() - *(uint64_t *)ctx;
+
+    (void)scheduler;
+    LatencyTotal += latency;
+    LatencyMax = (latency > LatencyMax) ? latency : LatencyMax;
+    Pongs++;
+}
@@ -0,0 +1,111 @@
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "Scheduler.h"
+#include "Log.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define BENCH_CALLS             200000u     /* Log calls of every thread */
+#define BENCH_THREADS_N         4u
+#define BENCH_BURST             200u        /* Calls between two pauses, below what a ring holds */
+
+/*----------------------------------------------------------------------------*/
+/*                               Global Variables                             */
+/*----------------------------------------------------------------------------*/
+
+static uint64_t Cost[BENCH_THREADS_N];      /* ns spent in the log calls of every thread */
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+void *Logger(void *arg);
+
+/*----------------------------------------------------------------------------*/
+/*                                  Main                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Measures the cost of a log call against fprintf and dprintf, all to /dev/null.
+ *
+ * The threads log in bursts with a short pause, like tasks, so the flush thread keeps up.
+ */
+int main( void )
+{
+    pthread_t thread[BENCH_THREADS_N];
+    int null = open("/dev/null", O_WRONLY);
+    FILE *file = fdopen(dup(null), "w");
+    uint64_t start;
+    uint64_t total = 0;
+
+    AppLog_init(null);
+    AppLog_startThread(1u);
+
+    for (uint32_t t = 0; t < BENCH_THREADS_N; t++)
+    {
+        pthread_create(&thread[t], NULL, Logger, &Cost[t]);
+    }
+    for (uint32_t t = 0; t < BENCH_THREADS_N; t++)
+    {
+        pthread_join(thread[t], NULL);
+        total += Cost[t];
+    }
+    AppLog_stopThread();
+    printf("AppLog_write: %.1f ns/call, %u threads, dropped %u\n",
+           (double)total / (BENCH_CALLS * BENCH_THREADS_N), (unsigned)BENCH_THREADS_N, (unsigned)AppLog_dropped());
+
+    /* The same line formatted in the calling thread */
+    setvbuf(file, NULL, _IOLBF, 0);
+    start = nanoseconds();
+    for (uint32_t c = 0; c < BENCH_CALLS; c++)
+    {
+        fprintf(file, "[%6u.%06u] task %u ran in %llu ns on %s\n", 0u, c, c, (unsigned long long)c * 3u, "worker");
+    }
+    printf("fprintf line buffered: %.1f ns/call\n", (double)(nanoseconds() - start) / BENCH_CALLS);
+
+    start = nanoseconds();
+    for (uint32_t c = 0; c < BENCH_CALLS; c++)
+    {
+        dprintf(null, "[%6u.%06u] task %u ran in %llu ns on %s\n", 0u, c, c, (unsigned long long)c * 3u, "worker");
+    }
+    printf("dprintf: %.1f ns/call\n", (double)(nanoseconds() - start) / BENCH_CALLS);
+
+    fclose(file);
+    close(null);
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Helper Functions                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Logs BENCH_CALLS lines and adds the time spent in the calls to *arg.
+ */
+void *Logger(void *arg)
+{
+    struct timespec ts = { 0, 2000000L };
+    uint64_t start;
+
+    for (uint32_t c = 0; c < BENCH_CALLS; c += BENCH_BURST)
+    {
+        start = nanoseconds();
+        for (uint32_t b = c; b < (c + BENCH_BURST); b++)
+        {
+            AppLog_write("task %u ran in %llu ns on %s", b, (unsigned long long)b * 3u, "worker");
+        }
+        *(uint64_t *)arg += nanoseconds() - start;
+        nanosleep(&ts, NULL);
+    }
+
+    return NULL;
+}
@@ -0,0 +1,188 @@
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <sched.h>
+#include <pthread.h>
+#include "Scheduler.h"
+#include "Software_Timers.h"
+#include "Queue.h"
+#include "Worker_Pool.h"
+#include "Task_Event.h"
+#include "Task_Pipeline.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define PIPE_TIMEOUT            500u        /* Run time of the scheduler in ms */
+#define PIPE_DEPTH              32u         /* Queue elements of every stage */
+#define PARSE_ROUNDS            20u         /* Work per message of every stage */
+#define FILTER_ROUNDS           2000u       /* The filter is the slow stage */
+#define STORE_ROUNDS            50u
+#define PIPE_WORKERS            3u          /* One worker per stage */
+
+/*----------------------------------------------------------------------------*/
+/*                               Global Variables                             */
+/*----------------------------------------------------------------------------*/
+
+static AppSched_Scheduler Loop;
+static AppPool_Pool Pool;                  /* The stages run at the same time */
+static AppPipe_Stage Parse;
+static AppPipe_Stage Filter;
+static AppPipe_Stage Store;
+static uint32_t ParseMessages[ PIPE_DEPTH ];
+static uint32_t FilterMessages[ PIPE_DEPTH ];
+static uint32_t StoreMessages[ PIPE_DEPTH ];
+static AppQue_Queue ParseQueue = { ParseMessages, PIPE_DEPTH, sizeof(uint32_t) };
+static AppQue_Queue FilterQueue = { FilterMessages, PIPE_DEPTH, sizeof(uint32_t) };
+static AppQue_Queue StoreQueue = { StoreMessages, PIPE_DEPTH, sizeof(uint32_t) };
+static _Atomic uint8_t Running;
+static uint32_t Pushed;
+static uint32_t Refused;
+static uint32_t Stored;
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+uint8_t Process_Parse(void *ctx, const void *in, void *out);
+uint8_t Process_Filter(void *ctx, const void *in, void *out);
+uint8_t Process_Store(void *ctx, const void *in, void *out);
+void Measure(uint32_t batch);
+void *Producer(void *arg);
+uint32_t Work(uint32_t value, uint32_t rounds);
+
+/*----------------------------------------------------------------------------*/
+/*                                  Main                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Runs a parse, filter and store pipeline fed by a producer thread as fast as it can.
+ *
+ * The stages run on the worker pool. The filter is the slow stage: the parse stage waits for
+ * it, suspended, instead of dropping messages, and the producer sees a full input. Runs once
+ * with one message per dispatch and once with batches of 16.
+ */
+int main( void )
+{
+    Measure(1u);
+    Measure(16u);
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Stage Functions                                 */
+/*----------------------------------------------------------------------------*/
+
+uint8_t Process_Parse(void *ctx, const void *in, void *out)
+{
+    (void)ctx;
+    *(uint32_t *)out = Work(*(const uint32_t *)in, PARSE_ROUNDS);
+    return TRUE;
+}
+
+uint8_t Process_Filter(void *ctx, const void *in, void *out)
+{
+    (void)ctx;
+    *(uint32_t *)out = Work(*(const uint32_t *)in, FILTER_ROUNDS);
+    return TRUE;
+}
+
+uint8_t Process_Store(void *ctx, const void *in, void *out)
+{
+    (void)ctx;
+    (void)out;
+    (void)Work(*(const uint32_t *)in, STORE_ROUNDS);
+    Stored++;
+    return FALSE;   /* Last stage */
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Helper Functions                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Runs the pipeline for PIPE_TIMEOUT ms and prints the stage report.
+ */
+void Measure(uint32_t batch)
+{
+    pthread_t producer;
+    uint32_t dropped;
+
+    Loop.tick = TICK_VAL;
+    Loop.timeout = PIPE_TIMEOUT;
+    Loop.taskPtr = NULL;
+    Loop.timerPtr = NULL;
+    Loop.timeSource = NULL;
+    Loop.mode = APPSCHED_MODE_TICKLESS;
+    AppSched_initScheduler(&Loop);
+    AppSched_initPool(&Loop, &Pool, PIPE_WORKERS);
+
+    AppQueue_initQueue(&ParseQueue);
+    AppQueue_initQueue(&FilterQueue);
+    AppQueue_initQueue(&StoreQueue);
+    AppPipe_registerStage(&Loop, &Parse, &ParseQueue, Process_Parse, NULL, batch);
+    AppPipe_registerStage(&Loop, &Filter, &FilterQueue, Process_Filter, NULL, batch);
+    AppPipe_registerStage(&Loop, &Store, &StoreQueue, Process_Store, NULL, batch);
+    AppPipe_connect(&Parse, &Filter);
+    AppPipe_connect(&Filter, &Store);
+    Pushed = 0;
+    Refused = 0;
+    Stored = 0;
+
+    atomic_store(&Running, TRUE);
+    pthread_create(&producer, NULL, Producer, NULL);
+    AppSched_startScheduler(&Loop);
+    atomic_store(&Running, FALSE);
+    pthread_join(producer, NULL);
+    AppPool_waitIdle(&Pool);
+    AppPool_stopPool(&Pool);
+
+    dropped = atomic_load(&Parse.input.dropped) - Refused + atomic_load(&Filter.input.dropped) +
+              atomic_load(&Store.input.dropped);
+    printf("batch %u: pushed %u, refused %u, stored %u, lost between stages %u, wakeups %u, dispatches %u\n",
+           (unsigned)batch, (unsigned)Pushed, (unsigned)Refused, (unsigned)Stored, (unsigned)dropped,
+           (unsigned)Loop.wakeups, (unsigned)Loop.dispatches);
+    AppPipe_dumpStats(&Parse, (uint64_t)PIPE_TIMEOUT * NS_PER_MS, stdout, PROF_FORMAT_TEXT);
+
+    AppSched_releaseTasks(&Loop);
+    AppSched_releaseTimers(&Loop);
+}
+
+/**
+ * @brief Pushes numbered messages, a full input makes it yield and try again.
+ */
+void *Producer(void *arg)
+{
+    uint32_t message = 0;
+
+    (void)arg;
+    while (atomic_load(&Running) == TRUE)
+    {
+        if (AppPipe_push(&Parse, &message) == TRUE)
+        {
+            Pushed++;
+            message++;
+        }
+        else
+        {
+            Refused++;
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+uint32_t Work(uint32_t value, uint32_t rounds)
+{
+    for (uint32_t r = 0; r < rounds; r++)
+    {
+        value = (value * 2654435761u) ^ (value >> 13);
+    }
+
+    return value;
+}
@@ -0,0 +1,82 @@
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include "Scheduler.h"
+#include "Queue.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define BENCH_ELEMENTS          4000000u    /* Elements written and read per measure */
+#define BENCH_DEPTH             8u          /* Queue elements, written then read in turn */
+#define BENCH_SIZE_MAX          16u
+
+/*----------------------------------------------------------------------------*/
+/*                               Global Variables                             */
+/*----------------------------------------------------------------------------*/
+
+static unsigned char Elements[ BENCH_DEPTH * BENCH_SIZE_MAX ];
+static AppQue_Queue Queue = { Elements, BENCH_DEPTH, 0u };
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+double Measure(uint8_t size);
+
+/*----------------------------------------------------------------------------*/
+/*                                  Main                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Writes and reads elements of 4 to 16 bytes through one queue.
+ *
+ * A pointer-sized element is copied as one word, the other sizes with a memcpy of the
+ * size of the queue.
+ */
+int main( void )
+{
+    printf("element bytes, ns per write and read\n");
+    for (uint8_t size = 4u; size <= BENCH_SIZE_MAX; size += 4u)
+    {
+        printf("%u%s, %.1f\n", (unsigned)size, (size == sizeof(void *)) ? " (pointer)" : "", Measure(size));
+    }
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Helper Functions                                */
+/*----------------------------------------------------------------------------*/
+
+double Measure(uint8_t size)
+{
+    unsigned char in[BENCH_SIZE_MAX];
+    unsigned char out[BENCH_SIZE_MAX];
+    uint64_t start;
+    uint32_t sum = 0;
+
+    Queue.Size = size;
+    AppQueue_initQueue(&Queue);
+    memset(in, 1, sizeof(in));
+
+    start = nanoseconds();
+    for (uint32_t e = 0; e < BENCH_ELEMENTS; e += BENCH_DEPTH)
+    {
+        for (uint32_t d = 0; d < BENCH_DEPTH; d++)
+        {
+            in[0] = (unsigned char)d;
+            AppQueue_writeData(&Queue, in);
+        }
+        while (AppQueue_readData(&Queue, out) == TRUE)
+        {
+            sum += out[0];
+        }
+    }
+
+    return ((double)(nanoseconds() - start) / BENCH_ELEMENTS) + (double)(sum & 0u);
+}
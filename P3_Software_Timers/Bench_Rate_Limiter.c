@@ -0,0 +1,137 @@
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include "Scheduler.h"
+#include "Software_Timers.h"
+#include "Time_Source.h"
+#include "Rate_Limiter.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define BENCH_BUCKETS           4096u       /* Independent buckets, 64 kB */
+#define BENCH_TAKES             4000000u    /* Takes per measure */
+#define SHARED_THREADS          4u          /* Threads taking from the same bucket */
+#define SHARED_TIME             200u        /* Time they take for in ms */
+#define SHARED_RATE             100000u     /* Tokens per second of the shared bucket */
+#define SHARED_BURST            100u
+
+/*----------------------------------------------------------------------------*/
+/*                               Global Variables                             */
+/*----------------------------------------------------------------------------*/
+
+static AppSched_Scheduler Loop;             /* Never started, it only holds the refill timer */
+static AppRate_Bucket Buckets[ BENCH_BUCKETS ];
+static AppRate_Limiter Limiter;
+static _Atomic uint8_t Running;
+static _Atomic uint32_t Granted;
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+double MeasureTakes(void);
+void *Taker(void *arg);
+
+/*----------------------------------------------------------------------------*/
+/*                                  Main                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Measures a take from 4096 buckets, with the clock read on every take and with the
+ * clock refreshed by a timer, then checks that threads sharing a bucket get its rate.
+ */
+int main( void )
+{
+    pthread_t thread[SHARED_THREADS];
+    uint64_t start;
+    uint64_t elapsed;
+    double expected;
+    struct timespec sleep = { 0, (long)SHARED_TIME * (long)NS_PER_MS };
+
+    AppRate_initLimiter(&Limiter, Buckets, BENCH_BUCKETS, NULL);
+    printf("clock read on every take: %.1f ns/take\n", MeasureTakes());
+
+    Loop.tick = TICK_VAL;
+    Loop.timeout = 0u;
+    Loop.taskPtr = NULL;
+    Loop.timerPtr = NULL;
+    Loop.timeSource = NULL;
+    Loop.mode = APPSCHED_MODE_TICKLESS;
+    AppSched_initScheduler(&Loop);
+    AppSched_initRateTick(&Loop, &Limiter, 1u);
+    printf("clock refreshed by a timer: %.1f ns/take\n", MeasureTakes());
+    AppSched_releaseTimers(&Loop);
+
+    /* Threads racing on one bucket, the clock read on every take */
+    AppRate_initLimiter(&Limiter, Buckets, 1u, NULL);
+    AppRate_setBucket(&Limiter, 0u, SHARED_RATE, SHARED_BURST);
+    atomic_store(&Running, TRUE);
+    start = nanoseconds();
+    for (uint32_t t = 0; t < SHARED_THREADS; t++)
+    {
+        pthread_create(&thread[t], NULL, Taker, NULL);
+    }
+    nanosleep(&sleep, NULL);
+    atomic_store(&Running, FALSE);
+    elapsed = nanoseconds() - start;
+    for (uint32_t t = 0; t < SHARED_THREADS; t++)
+    {
+        pthread_join(thread[t], NULL);
+    }
+
+    expected = ((double)elapsed * SHARED_RATE / NS_PER_S) + SHARED_BURST;
+    printf("%u threads, one bucket of %u/s: %u tokens granted in %.1f ms, at most %.0f expected\n",
+           (unsigned)SHARED_THREADS, (unsigned)SHARED_RATE, (unsigned)atomic_load(&Granted),
+           (double)elapsed / NS_PER_MS, expected);
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Helper Functions                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Takes one token from every bucket in turn, the buckets never run out.
+ */
+double MeasureTakes(void)
+{
+    uint64_t start;
+    uint32_t taken = 0;
+
+    for (uint32_t b = 0; b < BENCH_BUCKETS; b++)
+    {
+        AppRate_setBucket(&Limiter, b, 1000u + b, BENCH_TAKES);
+    }
+
+    start = nanoseconds();
+    for (uint32_t i = 0; i < BENCH_TAKES; i++)
+    {
+        taken += AppRate_tryAcquire(&Limiter, (i * 2654435761u) % BENCH_BUCKETS, 1u);
+    }
+
+    return ((double)(nanoseconds() - start) / BENCH_TAKES) + (double)(taken & 0u);
+}
+
+/**
+ * @brief Takes one token at a time from the shared bucket until the time is up.
+ */
+void *Taker(void *arg)
+{
+    uint32_t taken = 0;
+
+    (void)arg;
+    while (atomic_load_explicit(&Running, memory_order_relaxed) == TRUE)
+    {
+        taken += AppRate_tryAcquire(&Limiter, 0u, 1u);
+    }
+    atomic_fetch_add(&Granted, taken);
+
+    return NULL;
+}
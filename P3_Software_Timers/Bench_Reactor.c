@@ -0,0 +1,195 @@
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#define _GNU_SOURCE     /* pipe2 */
+#include <stdio.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include "Scheduler.h"
+#include "Software_Timers.h"
+#include "Task_Event.h"
+#include "Scheduler_Reactor.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define REACTOR_TIMEOUT         1000u       /* Run time of the scheduler in ms */
+#define SEND_PERIOD             (2u * NS_PER_MS) /* The producer sends a message and writes the pipe */
+#define SENDS_N                 400u
+
+/*----------------------------------------------------------------------------*/
+/*                               Global Variables                             */
+/*----------------------------------------------------------------------------*/
+
+static AppSched_Scheduler Loop;
+static AppRct_Reactor Reactor;
+static uint64_t Messages[ 64 ];             /* Post times of the queued messages */
+static AppQue_Queue Queue = { Messages, 64u, sizeof(uint64_t) };
+static AppEvt_Event Event;                  /* Releases Task_Queue */
+static int Pipe[2];
+static uint32_t Ticks;
+static uint32_t Expired;
+static uint32_t QueueCount;
+static uint64_t QueueLatency;
+static uint32_t PipeCount;
+static uint64_t PipeLatency;
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+void Task_10ms(void);
+void Task_Queue(void);
+void Callback_Timer(void *ctx);
+void Callback_Pipe(int fd, uint32_t events, void *ctx);
+void *Producer(void *arg);
+uint64_t ThreadTime(void);
+
+/*----------------------------------------------------------------------------*/
+/*                                  Main                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Runs a periodic task, a timer, a queue consumer and a pipe in one reactor thread.
+ *
+ * A producer thread posts a message and writes the pipe every 2 ms. The latencies are from
+ * the post or write to the task or callback, which includes the wake of the sleeping loop.
+ * The CPU time is the one of the scheduler thread only.
+ */
+int main( void )
+{
+    pthread_t producer;
+    uint64_t cpu;
+
+    Loop.tick = TICK_VAL;
+    Loop.timeout = REACTOR_TIMEOUT;
+    Loop.taskPtr = NULL;
+    Loop.timerPtr = NULL;
+    Loop.timeSource = NULL;
+    Loop.mode = APPSCHED_MODE_TICKLESS;
+    AppSched_initScheduler(&Loop);
+
+    if ((AppRct_initReactor(&Reactor) == FALSE) || (pipe2(Pipe, O_NONBLOCK) != 0))
+    {
+        printf("Could not create the reactor\n");
+        return 1;
+    }
+    AppSched_initReactor(&Loop, &Reactor);
+    AppRct_addFd(&Reactor, Pipe[0], EPOLLIN, Callback_Pipe, NULL);
+
+    AppSched_registerTask(&Loop, NULL, Task_10ms, 10u);
+    AppSched_startTimer(&Loop, AppSched_createTimer(&Loop, 50u, TIMER_MODE_AUTO_RELOAD, Callback_Timer, NULL));
+    AppQueue_initQueue(&Queue);
+    AppEvt_initEvent(&Event, &Queue);
+    AppSched_registerEventTask(&Loop, NULL, Task_Queue, &Event, TRUE);
+
+    pthread_create(&producer, NULL, Producer, NULL);
+    cpu = ThreadTime();
+    AppSched_startScheduler(&Loop);
+    cpu = ThreadTime() - cpu;
+    pthread_join(producer, NULL);
+
+    printf("ticks %u, timers %u, wakeups %u, epoll_wait %u, deadline %u, posts %u, io %u\n",
+           (unsigned)Ticks, (unsigned)Expired, (unsigned)Loop.wakeups, (unsigned)Reactor.waits,
+           (unsigned)Reactor.timerWakes, (unsigned)Reactor.postWakes, (unsigned)Reactor.ioCalls);
+    printf("queue: %u messages, latency avg %.0f ns\n", (unsigned)QueueCount,
+           (QueueCount > 0u) ? (double)QueueLatency / QueueCount : 0.0);
+    printf("pipe: %u writes, latency avg %.0f ns\n", (unsigned)PipeCount,
+           (PipeCount > 0u) ? (double)PipeLatency / PipeCount : 0.0);
+    printf("scheduler thread cpu: %.2f ms in %u ms\n", (double)cpu / NS_PER_MS, (unsigned)REACTOR_TIMEOUT);
+
+    AppRct_closeReactor(&Reactor);
+    close(Pipe[0]);
+    close(Pipe[1]);
+    AppSched_releaseTasks(&Loop);
+    AppSched_releaseTimers(&Loop);
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Task Functions                                  */
+/*----------------------------------------------------------------------------*/
+
+void Task_10ms(void)
+{
+    Ticks++;
+}
+
+/**
+ * @brief Reads every message posted since its last run, a message is its post time.
+ */
+void Task_Queue(void)
+{
+    uint64_t sent;
+
+    while (AppEvt_readQueue(&Event, &sent) == TRUE)
+    {
+        QueueLatency += nanoseconds() - sent;
+        QueueCount++;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Callback Functions                              */
+/*----------------------------------------------------------------------------*/
+
+void Callback_Timer(void *ctx)
+{
+    (void)ctx;
+    Expired++;
+}
+
+/**
+ * @brief Reads the write times from the pipe, in the scheduler thread.
+ */
+void Callback_Pipe(int fd, uint32_t events, void *ctx)
+{
+    uint64_t sent;
+
+    (void)events;
+    (void)ctx;
+    while (read(fd, &sent, sizeof(sent)) == (ssize_t)sizeof(sent))
+    {
+        PipeLatency += nanoseconds() - sent;
+        PipeCount++;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Helper Functions                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Posts a message and writes the pipe every SEND_PERIOD, both carry the current time.
+ */
+void *Producer(void *arg)
+{
+    struct timespec ts = { 0, (long)SEND_PERIOD };
+    uint64_t now;
+
+    (void)arg;
+    for (uint32_t s = 0; s < SENDS_N; s++)
+    {
+        nanosleep(&ts, NULL);
+        now = nanoseconds();
+        AppSched_postQueue(&Loop, &Event, &now);
+        now = nanoseconds();
+        (void)!write(Pipe[1], &now, sizeof(now));
+    }
+
+    return NULL;
+}
+
+uint64_t ThreadTime(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
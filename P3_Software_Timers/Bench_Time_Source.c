@@ -0,0 +1,94 @@
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "Scheduler.h"
+#include "Time_Source.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define BENCH_CALLS             10000000u   /* Reads of every time source */
+#define BENCH_SLEEPS            50u         /* Sleeps of 1 ms to measure how late they end */
+#define BENCH_CALIBRATION       (10u * NS_PER_MS)
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+void Measure(const char *name, AppTime_Source *source);
+
+/*----------------------------------------------------------------------------*/
+/*                                  Main                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Measures the cost of one read, the resolution and the sleep precision of every backend.
+ */
+int main( void )
+{
+    AppTime_Source monotonic;
+    AppTime_Source coarse;
+    AppTime_Source tsc;
+    uint8_t tscUsed;
+
+    AppTime_initMonotonic(&monotonic);
+    AppTime_initCoarse(&coarse);
+    tscUsed = AppTime_initTsc(&tsc, BENCH_CALIBRATION);
+
+    printf("source, ns/call, resolution ns, smallest step ns, backward steps, sleep late avg ns, offset to monotonic ns\n");
+    Measure("monotonic", &monotonic);
+    Measure("coarse", &coarse);
+    Measure((tscUsed == TRUE) ? "tsc" : "tsc (fell back to monotonic)", &tsc);
+
+    return 0;
+}
+
+/**
+ * @brief Prints one line of measurements of a time source.
+ */
+void Measure(const char *name, AppTime_Source *source)
+{
+    uint64_t begin;
+    uint64_t wall;
+    uint64_t last = source->now(source);
+    uint64_t now;
+    uint64_t step = 0;
+    uint32_t backward = 0;
+    uint64_t late = 0;
+    uint64_t deadline;
+    int64_t offset;
+
+    begin = nanoseconds();
+    for (uint32_t c = 0; c < BENCH_CALLS; c++)
+    {
+        now = source->now(source);
+        if (now < last)
+        {
+            backward++;
+        }
+        else if ((now > last) && ((step == 0u) || ((now - last) < step)))
+        {
+            step = now - last;
+        }
+        last = now;
+    }
+    wall = nanoseconds() - begin;
+
+    /* Late by the time source itself, what the scheduler sees after a sleep */
+    for (uint32_t s = 0; s < BENCH_SLEEPS; s++)
+    {
+        deadline = source->now(source) + NS_PER_MS;
+        source->sleepUntil(source, deadline);
+        now = source->now(source);
+        late += (now > deadline) ? (now - deadline) : 0u;
+    }
+
+    offset = (int64_t)(source->now(source) - nanoseconds());
+
+    printf("%s, %.1f, %llu, %llu, %u, %llu, %lld\n", name, (double)wall / BENCH_CALLS,
+           (unsigned long long)source->resolution, (unsigned long long)step, (unsigned)backward,
+           (unsigned long long)(late / BENCH_SLEEPS), (long long)offset);
+}
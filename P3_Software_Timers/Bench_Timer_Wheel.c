@@ -0,0 +1,137 @@
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "Scheduler.h"
+#include "Software_Timers.h"
+#include "Timer_Wheel.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define BENCH_TIMERS            1000000u    /* Timers alive during the whole benchmark */
+#define BENCH_TICKS             100000u     /* Ticks of churn */
+#define BENCH_RELOADS           1000u       /* Timers reloaded on every tick, like connections with traffic */
+#define BENCH_STOPS             100u        /* Timers stopped and started again on every tick */
+#define BENCH_MAX_TICKS         30000u      /* Longest timeout in ticks */
+#define BENCH_SCAN_TICKS        100u        /* Ticks measured for the linear scan */
+
+/*----------------------------------------------------------------------------*/
+/*                               Global Variables                             */
+/*----------------------------------------------------------------------------*/
+
+static AppSched_Wheel Wheel;
+static AppSched_Timer *Timers;
+static uint32_t Seed = 12345u;
+static uint32_t Expired;
+static uint32_t Errors;     /* Timers that expired on a tick other than their expiry */
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+uint32_t Random(void);
+void Expire(void *ctx, uint32_t index);
+
+/*----------------------------------------------------------------------------*/
+/*                                  Main                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Timer churn with 1M timers on the wheel, compared with the linear scan per tick.
+ */
+int main( void )
+{
+    uint64_t start;
+    uint64_t wall;
+    uint64_t ops = 0;
+
+    Timers = calloc(BENCH_TIMERS, sizeof(AppSched_Timer));
+    if (Timers == NULL)
+    {
+        printf("Not enough memory\n");
+        return 1;
+    }
+    AppWheel_initWheel(&Wheel);
+
+    start = nanoseconds();
+    for (uint32_t i = 0; i < BENCH_TIMERS; i++)
+    {
+        Timers[i].wheelSlot = WHEEL_IDLE;
+        Timers[i].timeout = 1u + (Random() % BENCH_MAX_TICKS);
+        AppWheel_insert(&Wheel, Timers, i, Timers[i].timeout);
+    }
+    wall = nanoseconds() - start;
+    printf("start:  %u timers, %.1f ns/start\n", BENCH_TIMERS, (double)wall / BENCH_TIMERS);
+
+    start = nanoseconds();
+    for (uint32_t t = 0; t < BENCH_TICKS; t++)
+    {
+        for (uint32_t r = 0; r < BENCH_RELOADS; r++)
+        {
+            uint32_t index = Random() % BENCH_TIMERS;
+            AppWheel_insert(&Wheel, Timers, index, Timers[index].timeout);
+        }
+        for (uint32_t r = 0; r < BENCH_STOPS; r++)
+        {
+            uint32_t index = Random() % BENCH_TIMERS;
+            AppWheel_remove(&Wheel, Timers, index);
+            AppWheel_insert(&Wheel, Timers, index, Timers[index].timeout);
+        }
+        ops += BENCH_RELOADS + (2u * BENCH_STOPS);
+        AppWheel_advance(&Wheel, &Timers, Expire, NULL);
+    }
+    wall = nanoseconds() - start;
+    printf("churn:  %u ticks, %llu operations, %u expired, %u errors, %.1f ns/operation (tick included), %.1f us/tick\n",
+           BENCH_TICKS, (unsigned long long)ops, (unsigned)Expired, (unsigned)Errors,
+           (double)wall / ops, (double)wall / BENCH_TICKS / 1000.0);
+
+    /* Same work per tick as the scheduler scan: count every timer and check it */
+    start = nanoseconds();
+    for (uint32_t t = 0; t < BENCH_SCAN_TICKS; t++)
+    {
+        for (uint32_t i = 0; i < BENCH_TIMERS; i++)
+        {
+            Timers[i].count++;
+            if ((Timers[i].timeout - Timers[i].count) == 0u)
+            {
+                Timers[i].count = 0;
+                Expired++;
+            }
+        }
+    }
+    wall = nanoseconds() - start;
+    printf("scan:   %.1f us/tick for %u timers\n", (double)wall / BENCH_SCAN_TICKS / 1000.0, BENCH_TIMERS);
+
+    free(Timers);
+
+    return 0;
+}
+
+/**
+ * @brief xorshift32 random numbers, the same sequence on every run.
+ */
+uint32_t Random(void)
+{
+    Seed ^= Seed << 13;
+    Seed ^= Seed >> 17;
+    Seed ^= Seed << 5;
+    return Seed;
+}
+
+/**
+ * @brief Expired timers start again, the number of live timers stays the same.
+ */
+void Expire(void *ctx, uint32_t index)
+{
+    (void)ctx;
+    if (Timers[index].expiry != Wheel.now)
+    {
+        Errors++;
+    }
+    Expired++;
+    AppWheel_insert(&Wheel, Timers, index, Timers[index].timeout);
+}
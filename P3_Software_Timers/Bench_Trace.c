@@ -0,0 +1,110 @@
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include "Scheduler.h"
+#include "Trace.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define BENCH_EVENTS            4000000u    /* Events recorded per measure, the ring wraps many times */
+#define BENCH_THREADS_N         4u          /* Threads recording at the same time, one ring each */
+
+/*----------------------------------------------------------------------------*/
+/*                               Global Variables                             */
+/*----------------------------------------------------------------------------*/
+
+static uint64_t Cost[BENCH_THREADS_N];      /* CPU time in ns spent recording in every thread */
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+double MeasureClock(void);
+void *Recorder(void *arg);
+uint64_t ThreadTime(void);
+
+/*----------------------------------------------------------------------------*/
+/*                                  Main                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Measures the cost of one recorded event, from one thread and from four at once.
+ *
+ * Build with -DAPPSCHED_TRACE=1u (see make bench). Every thread counts its own CPU time, so
+ * the threads sharing fewer CPUs do not count each other. The clock read alone is printed
+ * too, it is most of the cost of an event.
+ */
+int main( void )
+{
+    pthread_t thread[BENCH_THREADS_N];
+    uint64_t total = 0;
+
+    printf("clock read: %.1f ns\n", MeasureClock());
+
+    Recorder(&Cost[0]);
+    printf("1 thread: %.1f ns/event\n", (double)Cost[0] / BENCH_EVENTS);
+
+    for (uint32_t t = 0; t < BENCH_THREADS_N; t++)
+    {
+        pthread_create(&thread[t], NULL, Recorder, &Cost[t]);
+    }
+    for (uint32_t t = 0; t < BENCH_THREADS_N; t++)
+    {
+        pthread_join(thread[t], NULL);
+        total += Cost[t];
+    }
+    printf("%u threads: %.1f ns/event\n", (unsigned)BENCH_THREADS_N, (double)total / (BENCH_THREADS_N * BENCH_EVENTS));
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                            Helper Functions                                */
+/*----------------------------------------------------------------------------*/
+
+double MeasureClock(void)
+{
+    uint64_t start = nanoseconds();
+    uint64_t sum = 0;
+
+    for (uint32_t e = 0; e < BENCH_EVENTS; e++)
+    {
+        sum += nanoseconds();
+    }
+
+    return ((double)(nanoseconds() - start) / BENCH_EVENTS) + (double)(sum & 0u);
+}
+
+/**
+ * @brief Records task start and end events, the CPU time spent goes to *arg.
+ */
+void *Recorder(void *arg)
+{
+    uint64_t start;
+
+    AppTrace_record(TRACE_TICK, 0u, 0u);    /* The ring of the thread is allocated here, not measured */
+    start = ThreadTime();
+    for (uint32_t e = 0; e < BENCH_EVENTS; e += 2u)
+    {
+        AppTrace_record(TRACE_TASK_START, e, 0u);
+        AppTrace_record(TRACE_TASK_END, e, 0u);
+    }
+    *(uint64_t *)arg = ThreadTime() - start;
+
+    return NULL;
+}
+
+uint64_t ThreadTime(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000000ull) + (uint64_t)now.tv_nsec;
+}
@@ -0,0 +1,104 @@
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "Scheduler.h"
+#include "Worker_Pool.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define BENCH_JOBS              1000000u    /* Jobs dispatched for every thread count */
+#define BENCH_WORK              200u        /* Loop iterations done by every job */
+
+/*----------------------------------------------------------------------------*/
+/*                               Global Variables                             */
+/*----------------------------------------------------------------------------*/
+
+static AppPool_Pool Pool;
+static _Atomic uint64_t Done;
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+void Job(void *owner, uint64_t job);
+
+/*----------------------------------------------------------------------------*/
+/*                                  Main                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Measures how many jobs per second the pool dispatches for 1 to N workers.
+ *
+ * Usage: bench_pool.exe [max workers]
+ */
+int main( int argc, char *argv[] )
+{
+    uint8_t maxWorkers = (argc > 1) ? (uint8_t)atoi(argv[1]) : POOL_WORKERS_N;
+
+    printf("workers, jobs, seconds, jobs/s, stolen\n");
+
+    for (uint8_t workers = 1; workers <= maxWorkers; workers++)
+    {
+        uint64_t start;
+        uint64_t stop;
+        uint64_t stolen = 0;
+
+        Pool.workers = workers;
+        Pool.owner = NULL;
+        Pool.runFunc = Job;
+        atomic_store(&Done, 0u);
+        if (AppPool_initPool(&Pool) == FALSE)
+        {
+            printf("Could not start %u workers\n", (unsigned)workers);
+            return 1;
+        }
+
+        start = nanoseconds();
+        for (uint32_t j = 0; j < BENCH_JOBS; j++)
+        {
+            /* Signal every batch, and when an inbox is full let the workers catch up */
+            while (AppPool_submit(&Pool, j, POOL_ANY_WORKER) == FALSE)
+            {
+                AppPool_signal(&Pool);
+            }
+            if ((j % 256u) == 255u)
+            {
+                AppPool_signal(&Pool);
+            }
+        }
+        AppPool_signal(&Pool);
+        AppPool_waitIdle(&Pool);
+        stop = nanoseconds();
+
+        AppPool_stopPool(&Pool);
+        for (uint8_t w = 0; w < workers; w++)
+        {
+            stolen += Pool.worker[w].stolen;
+        }
+
+        printf("%u, %u, %.3f, %.0f, %llu\n", (unsigned)workers, BENCH_JOBS, (stop - start) / 1e9,
+               BENCH_JOBS / ((stop - start) / 1e9), (unsigned long long)stolen);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Job with a small fixed amount of work.
+ */
+void Job(void *owner, uint64_t job)
+{
+    volatile uint64_t acc = job;
+
+    (void)owner;
+    for (uint32_t i = 0; i < BENCH_WORK; i++)
+    {
+        acc = acc * 31u + i;
+    }
+    atomic_fetch_add_explicit(&Done, 1u, memory_order_relaxed);
+}
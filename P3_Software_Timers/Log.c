@@ -0,0 +1,618 @@
+/**
+ * \file       Log.c
+ * \brief      Implementation for the asynchronous Logger
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/uio.h>
+#include "Scheduler.h"
+#include "Log.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define LOG_MASK                (LOG_RING_N - 1u)
+#define LOG_PAD                 0xFFFFFFFFu /* count of the filler that ends the ring before a wrap */
+#define LOG_WORDS_N             (LOG_ARGS_N * (1u + (LOG_STRING_N / 8u)))  /* Argument words of the largest record */
+#define LOG_SPEC_N              24u         /* Longest conversion kept, %-+08.3llx is 10 */
+#define LOG_SHAPES_N            64u         /* Formats whose conversions a thread remembers, power of two */
+
+/* States of a ring */
+#define LOG_RING_USED           0u          /* Its thread may still log */
+#define LOG_RING_EXITED         1u          /* Its thread ended, the flush frees it once it is empty */
+#define LOG_RING_FREE           2u          /* Ready for the next thread that logs */
+
+/* Argument kinds, the type va_arg reads and the formatter passes back to snprintf */
+#define LOG_NONE                0u          /* Unknown conversion, the rest of the format is copied as is */
+#define LOG_INT                 1u          /* int, also char and short after the promotion */
+#define LOG_LONG                2u          /* long, ptrdiff_t */
+#define LOG_LLONG               3u          /* long long, intmax_t */
+#define LOG_SIZE                4u          /* size_t */
+#define LOG_DOUBLE              5u          /* double, also float after the promotion */
+#define LOG_LDOUBLE             6u          /* long double, kept as a double */
+#define LOG_PTR                 7u          /* void * */
+#define LOG_STR                 8u          /* const char *, copied into the record */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/* Start of every record, the arguments follow in 8 byte words */
+typedef struct _AppLog_Record
+{
+    uint32_t size;                      /* Bytes of the record, a multiple of 8 */
+    uint32_t count;                     /* Arguments stored, LOG_PAD for the filler */
+    uint64_t time;                      /* ns since AppLog_init */
+    const char *format;                 /* printf format given to AppLog_write */
+} AppLog_Record;
+
+/* Argument kinds of one format, parsed on its first use by a thread */
+typedef struct _AppLog_Shape
+{
+    const char *format;                 /* Format parsed, NULL if the entry is free */
+    uint8_t count;                      /* Arguments read */
+    uint8_t kind[LOG_ARGS_N];           /* LOG_INT, LOG_DOUBLE, ... of every argument */
+} AppLog_Shape;
+
+/* One argument, a string is its length followed by its bytes in the next words */
+typedef union _AppLog_Word
+{
+    int64_t i;
+    double d;
+    const void *p;
+    unsigned char c[8];
+} AppLog_Word;
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of Global Variables                      */
+/*----------------------------------------------------------------------------*/
+
+static AppLog_Ring *_Atomic Rings[LOG_THREADS_N];  /* Rings of every thread that logged something */
+static _Atomic uint32_t RingsCount;
+static _Thread_local AppLog_Ring *Ring;             /* Ring of the calling thread */
+static _Thread_local uint8_t Lost;                  /* TRUE when the thread could not get a ring */
+static _Thread_local AppLog_Shape Shapes[LOG_SHAPES_N]; /* Formats used by the calling thread */
+static pthread_key_t RingKey;                       /* Its destructor gives the ring of an ending thread back */
+static pthread_once_t RingOnce = PTHREAD_ONCE_INIT;
+static uint8_t KeyReady;                            /* FALSE if the key could not be created */
+static int Output = STDOUT_FILENO;
+static uint64_t Start;                              /* Time of AppLog_init */
+static atomic_flag Flushing = ATOMIC_FLAG_INIT;     /* Held by the thread that flushes */
+static char Lines[LOG_IOV_N][LOG_LINE_N];           /* Text of one writev, used under Flushing */
+static pthread_t Flusher;
+static atomic_uchar Running;
+static uint32_t Period;                             /* Flush period of the thread in ms */
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of local functions                       */
+/*----------------------------------------------------------------------------*/
+static uint8_t AppLog_attach( void );
+static void AppLog_createKey( void );
+static void AppLog_detach( void *ring );
+static const AppLog_Shape *AppLog_shape( const char *format );
+static const char *AppLog_conversion( const char *spec, uint8_t *kind );
+static uint32_t AppLog_format( const AppLog_Record *record, char *line );
+static void AppLog_writeLines( struct iovec *iov, uint32_t count );
+static void *AppLog_thread( void *arg );
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+void AppLog_init( int fd )
+{
+    Output = fd;
+    Start = nanoseconds();
+}
+
+uint8_t AppLog_write( const char *format, ... )
+{
+    AppLog_Word args[LOG_WORDS_N];
+    AppLog_Record record;
+    const AppLog_Shape *shape;
+    const char *text;
+    uint32_t words = 0;
+    uint32_t length;
+    uint64_t head;
+    uint64_t pad;
+    va_list ap;
+
+    if ((Ring == NULL) && (AppLog_attach() == FALSE))
+    {
+        return FALSE;
+    }
+
+    /* Only the arguments are read, the text is formatted at the flush */
+    shape = AppLog_shape(format);
+    va_start(ap, format);
+    for (uint32_t a = 0; a < shape->count; a++)
+    {
+        switch (shape->kind[a])
+        {
+        case LOG_INT:       args[words++].i = va_arg(ap, int);                  break;
+        case LOG_LONG:      args[words++].i = va_arg(ap, long);                 break;
+        case LOG_LLONG:     args[words++].i = va_arg(ap, long long);            break;
+        case LOG_SIZE:      args[words++].i = (int64_t)va_arg(ap, size_t);      break;
+        case LOG_DOUBLE:    args[words++].d = va_arg(ap, double);               break;
+        case LOG_LDOUBLE:   args[words++].d = (double)va_arg(ap, long double);  break;
+        case LOG_PTR:       args[words++].p = va_arg(ap, void *);               break;
+        default:
+            text = va_arg(ap, const char *);
+            text = (text == NULL) ? "(null)" : text;
+            length = (uint32_t)strnlen(text, LOG_STRING_N);
+            args[words++].i = length;
+            memcpy(&args[words], text, length);
+            words += (length + 7u) / 8u;
+            break;
+        }
+    }
+    va_end(ap);
+
+    record.size = (uint32_t)(sizeof(AppLog_Record) + (words * sizeof(AppLog_Word)));
+    record.count = shape->count;
+    record.time = nanoseconds() - Start;
+    record.format = format;
+
+    /* A record never wraps, the end of the ring is filled when it does not fit there */
+    head = atomic_load_explicit(&Ring->Head, memory_order_relaxed);
+    pad = ((LOG_RING_N - (head & LOG_MASK)) < record.size) ? (LOG_RING_N - (head & LOG_MASK)) : 0u;
+    if ((head + pad + record.size - atomic_load_explicit(&Ring->Tail, memory_order_acquire)) > Ring->Elements)
+    {
+        atomic_fetch_add_explicit(&Ring->dropped, 1u, memory_order_relaxed);
+        return FALSE;
+    }
+
+    if (pad > 0u)
+    {
+        ((AppLog_Record *)&Ring->Buffer[head & LOG_MASK])->size = (uint32_t)pad;
+        ((AppLog_Record *)&Ring->Buffer[head & LOG_MASK])->count = LOG_PAD;
+        head += pad;
+    }
+    memcpy(&Ring->Buffer[head & LOG_MASK], &record, sizeof(record));
+    memcpy(&Ring->Buffer[(head & LOG_MASK) + sizeof(record)], args, words * sizeof(AppLog_Word));
+    atomic_store_explicit(&Ring->Head, head + record.size, memory_order_release);
+
+    return TRUE;
+}
+
+uint32_t AppLog_flush( void )
+{
+    struct iovec iov[LOG_IOV_N];
+    AppLog_Ring *ring[LOG_THREADS_N];
+    uint64_t tail[LOG_THREADS_N];
+    uint64_t head[LOG_THREADS_N];
+    uint8_t exited[LOG_THREADS_N];
+    uint32_t lines = 0;
+    uint32_t count = 0;
+    uint32_t rings;
+    uint32_t next;
+    AppLog_Record *record;
+    AppLog_Record *first = NULL;
+
+    if (atomic_flag_test_and_set_explicit(&Flushing, memory_order_acquire))
+    {
+        return 0; /* Another thread is flushing */
+    }
+
+    /* The state is read before the head, the head of an ended thread is its last one */
+    rings = atomic_load(&RingsCount);
+    rings = (rings > LOG_THREADS_N) ? LOG_THREADS_N : rings;
+    for (uint32_t r = 0; r < rings; r++)
+    {
+        ring[r] = atomic_load_explicit(&Rings[r], memory_order_acquire);
+        tail[r] = 0;
+        head[r] = 0;    /* Counted but not published yet, nothing to write */
+        if (ring[r] != NULL)
+        {
+            exited[r] = (atomic_load_explicit(&ring[r]->state, memory_order_acquire) == LOG_RING_EXITED) ? TRUE : FALSE;
+            tail[r] = atomic_load_explicit(&ring[r]->Tail, memory_order_relaxed);
+            head[r] = atomic_load_explicit(&ring[r]->Head, memory_order_acquire);
+        }
+    }
+
+    /* The lines of one thread are in order already, the oldest first record of all the rings
+       goes next. LOG_THREADS_N rings are few enough to compare them all every time */
+    for (;;)
+    {
+        next = LOG_THREADS_N;
+        for (uint32_t r = 0; r < rings; r++)
+        {
+            while ((tail[r] < head[r]) && (((AppLog_Record *)&ring[r]->Buffer[tail[r] & LOG_MASK])->count == LOG_PAD))
+            {
+                tail[r] += ((AppLog_Record *)&ring[r]->Buffer[tail[r] & LOG_MASK])->size;
+            }
+            if (tail[r] < head[r])
+            {
+                record = (AppLog_Record *)&ring[r]->Buffer[tail[r] & LOG_MASK];
+                if ((next == LOG_THREADS_N) || (record->time < first->time))
+                {
+                    next = r;
+                    first = record;
+                }
+            }
+        }
+        if (next == LOG_THREADS_N)
+        {
+            break;
+        }
+
+        iov[count].iov_base = Lines[count];
+        iov[count].iov_len = AppLog_format(first, Lines[count]);
+        count++;
+        tail[next] += first->size;
+
+        /* The line holds a copy of everything, the space goes back to the thread at once */
+        atomic_store_explicit(&ring[next]->Tail, tail[next], memory_order_release);
+        if (count == LOG_IOV_N)
+        {
+            AppLog_writeLines(iov, count);
+            lines += count;
+            count = 0;
+        }
+    }
+
+    AppLog_writeLines(iov, count);
+    lines += count;
+
+    /* An ended thread wrote nothing after its last head, its empty ring is free for a new one */
+    for (uint32_t r = 0; r < rings; r++)
+    {
+        if (ring[r] != NULL)
+        {
+            atomic_store_explicit(&ring[r]->Tail, tail[r], memory_order_release);
+            if (exited[r] == TRUE)
+            {
+                atomic_store_explicit(&ring[r]->state, LOG_RING_FREE, memory_order_release);
+            }
+        }
+    }
+    atomic_flag_clear_explicit(&Flushing, memory_order_release);
+
+    return lines;
+}
+
+void AppLog_flushTask( void )
+{
+    (void)AppLog_flush();
+}
+
+uint8_t AppLog_startThread( uint32_t period )
+{
+    Period = period;
+    atomic_store(&Running, TRUE);
+    if (pthread_create(&Flusher, NULL, AppLog_thread, NULL) != 0)
+    {
+        atomic_store(&Running, FALSE);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void AppLog_stopThread( void )
+{
+    if (atomic_exchange(&Running, FALSE) == TRUE)
+    {
+        pthread_join(Flusher, NULL);
+    }
+    (void)AppLog_flush();
+}
+
+uint32_t AppLog_dropped( void )
+{
+    uint32_t dropped = 0;
+    uint32_t rings = atomic_load(&RingsCount);
+    AppLog_Ring *ring;
+
+    rings = (rings > LOG_THREADS_N) ? LOG_THREADS_N : rings;
+    for (uint32_t r = 0; r < rings; r++)
+    {
+        ring = atomic_load_explicit(&Rings[r], memory_order_acquire);
+        if (ring != NULL)
+        {
+            dropped += atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+        }
+    }
+
+    return dropped;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of local functions                      */
+/*----------------------------------------------------------------------------*/
+
+static uint8_t AppLog_attach( void )
+{
+    uint32_t index;
+    uint32_t rings;
+    uint32_t state;
+    AppLog_Ring *ring;
+
+    if (Lost == TRUE)
+    {
+        return FALSE;
+    }
+
+    (void)pthread_once(&RingOnce, AppLog_createKey);
+
+    /* The ring of an ended thread first, it keeps its place in Rings and its counters */
+    rings = atomic_load(&RingsCount);
+    rings = (rings > LOG_THREADS_N) ? LOG_THREADS_N : rings;
+    for (uint32_t r = 0; (r < rings) && (Ring == NULL); r++)
+    {
+        ring = atomic_load_explicit(&Rings[r], memory_order_acquire);
+        state = LOG_RING_FREE;
+        if ((ring != NULL) &&
+            atomic_compare_exchange_strong_explicit(&ring->state, &state, LOG_RING_USED,
+                                                    memory_order_acquire, memory_order_relaxed))
+        {
+            Ring = ring;
+        }
+    }
+
+    if (Ring == NULL)
+    {
+        index = atomic_fetch_add(&RingsCount, 1u);
+        if (index >= LOG_THREADS_N)
+        {
+            Lost = TRUE;    /* Too many threads, this one does not log */
+            return FALSE;
+        }
+
+        Ring = calloc(1, sizeof(AppLog_Ring));
+        if (Ring == NULL)
+        {
+            Lost = TRUE;
+            return FALSE;
+        }
+        Ring->Elements = LOG_RING_N;
+        atomic_init(&Ring->state, LOG_RING_USED);
+        atomic_store_explicit(&Rings[index], Ring, memory_order_release);
+    }
+
+    /* Without the key the ring stays taken after the thread ends */
+    if (KeyReady == TRUE)
+    {
+        (void)pthread_setspecific(RingKey, Ring);
+    }
+
+    return TRUE;
+}
+
+static void AppLog_createKey( void )
+{
+    KeyReady = (pthread_key_create(&RingKey, AppLog_detach) == 0) ? TRUE : FALSE;
+}
+
+static void AppLog_detach( void *ring )
+{
+    /* Runs at the end of the thread, after its last record. The flush frees the ring once it
+       wrote the records left */
+    atomic_store_explicit(&((AppLog_Ring *)ring)->state, LOG_RING_EXITED, memory_order_release);
+}
+
+static const AppLog_Shape *AppLog_shape( const char *format )
+{
+    AppLog_Shape *shape = &Shapes[((uintptr_t)format >> 3u) & (LOG_SHAPES_N - 1u)];
+    const char *c = format;
+    uint8_t kind = LOG_INT;
+
+    /* A format is a literal at a fixed address, its pointer is the key */
+    if (shape->format == format)
+    {
+        return shape;
+    }
+
+    shape->format = format;
+    shape->count = 0;
+    while ((*c != '\0') && (shape->count < LOG_ARGS_N) && (kind != LOG_NONE))
+    {
+        if (*c++ != '%')
+        {
+            continue;
+        }
+        if (*c == '%')
+        {
+            c++;
+            continue;
+        }
+
+        c = AppLog_conversion(c, &kind);
+        if (kind != LOG_NONE)
+        {
+            shape->kind[shape->count] = kind;
+            shape->count++;
+        }
+    }
+
+    return shape;
+}
+
+static const char *AppLog_conversion( const char *spec, uint8_t *kind )
+{
+    const char *start = spec;
+    uint8_t longs = 0;
+    uint8_t size = FALSE;
+    uint8_t ldouble = FALSE;
+
+    /* Flags, width and precision, a * width is not supported */
+    while ((*spec != '\0') && (strchr("-+ #0123456789.", *spec) != NULL))
+    {
+        spec++;
+    }
+
+    /* Length modifier */
+    while ((*spec != '\0') && (strchr("hljztL", *spec) != NULL))
+    {
+        longs += (*spec == 'l') ? 1u : ((*spec == 'j') ? 2u : ((*spec == 't') ? 1u : 0u));
+        size = (*spec == 'z') ? TRUE : size;
+        ldouble = (*spec == 'L') ? TRUE : ldouble;
+        spec++;
+    }
+
+    /* %lc and %ls read a wint_t and a wchar_t *, the record keeps no wide text. A conversion
+       of LOG_SPEC_N bytes or more with its % does not fit the copy the flush formats it from,
+       the writer stops there so both see the same arguments */
+    if (((longs > 0u) && ((*spec == 'c') || (*spec == 's'))) || (((size_t)(spec - start) + 2u) >= LOG_SPEC_N))
+    {
+        *kind = LOG_NONE;
+        return spec;
+    }
+
+    switch (*spec)
+    {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+        *kind = (size == TRUE) ? LOG_SIZE : ((longs >= 2u) ? LOG_LLONG : ((longs == 1u) ? LOG_LONG : LOG_INT));
+        break;
+    case 'c':
+        *kind = LOG_INT;
+        break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        *kind = (ldouble == TRUE) ? LOG_LDOUBLE : LOG_DOUBLE;
+        break;
+    case 'p':
+        *kind = LOG_PTR;
+        break;
+    case 's':
+        *kind = LOG_STR;
+        break;
+    default:
+        *kind = LOG_NONE;   /* %n, * widths */
+        return spec;
+    }
+
+    return spec + 1;
+}
+
+static uint32_t AppLog_format( const AppLog_Record *record, char *line )
+{
+    const AppLog_Word *args = (const AppLog_Word *)(record + 1);
+    const char *c = record->format;
+    const char *begin;
+    char spec[LOG_SPEC_N];
+    char text[LOG_STRING_N + 1u];
+    uint32_t length;
+    uint32_t count = 0;
+    uint32_t room;
+    uint32_t copy;
+    uint8_t kind = LOG_INT;
+    int n;
+
+    n = snprintf(line, LOG_LINE_N, "[%6llu.%06llu] ", (unsigned long long)(record->time / 1000000000ull),
+                 (unsigned long long)((record->time % 1000000000ull) / 1000ull));
+    length = (uint32_t)n;
+
+    /* The text between the conversions is copied, every conversion is formatted on its own */
+    while ((*c != '\0') && (length < (LOG_LINE_N - 1u)))
+    {
+        if ((*c != '%') || (c[1] == '%') || (count == record->count))
+        {
+            /* Also the conversions past the stored arguments are copied as they are */
+            line[length++] = *c;
+            c += ((*c == '%') && (c[1] == '%')) ? 2 : 1;
+            continue;
+        }
+
+        begin = c;
+        c = AppLog_conversion(c + 1, &kind);
+        if ((kind == LOG_NONE) || ((size_t)(c - begin) >= LOG_SPEC_N))
+        {
+            line[length++] = *begin;
+            c = begin + 1;
+            continue;
+        }
+        memcpy(spec, begin, (size_t)(c - begin));
+        spec[c - begin] = '\0';
+
+        room = LOG_LINE_N - 1u - length;
+        switch (kind)
+        {
+        case LOG_INT:       n = snprintf(&line[length], room + 1u, spec, (int)args->i);             break;
+        case LOG_LONG:      n = snprintf(&line[length], room + 1u, spec, (long)args->i);            break;
+        case LOG_LLONG:     n = snprintf(&line[length], room + 1u, spec, (long long)args->i);       break;
+        case LOG_SIZE:      n = snprintf(&line[length], room + 1u, spec, (size_t)args->i);          break;
+        case LOG_DOUBLE:    n = snprintf(&line[length], room + 1u, spec, args->d);                  break;
+        case LOG_LDOUBLE:   n = snprintf(&line[length], room + 1u, spec, (long double)args->d);     break;
+        case LOG_PTR:       n = snprintf(&line[length], room + 1u, spec, args->p);                  break;
+        default:
+            /* The copy in the record has no terminator, its length is never above LOG_STRING_N */
+            copy = ((uint64_t)args->i > LOG_STRING_N) ? LOG_STRING_N : (uint32_t)args->i;
+            memcpy(text, &args[1], copy);
+            text[copy] = '\0';
+            n = snprintf(&line[length], room + 1u, spec, text);
+            args += (copy + 7u) / 8u;
+            break;
+        }
+        args++;
+        count++;
+        length += ((n > 0) && ((uint32_t)n < room)) ? (uint32_t)n : ((n > 0) ? room : 0u);
+    }
+
+    line[length++] = '\n';
+    return length;
+}
+
+static void AppLog_writeLines( struct iovec *iov, uint32_t count )
+{
+    ssize_t n;
+
+    /* A pipe or a terminal may take only a part, the rest is written again */
+    while (count > 0u)
+    {
+        n = writev(Output, iov, (int)count);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;  /* The lines are lost, the logger never blocks the threads that log */
+        }
+
+        while ((count > 0u) && ((size_t)n >= iov->iov_len))
+        {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0u)
+        {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+}
+
+static void *AppLog_thread( void *arg )
+{
+    struct timespec ts;
+
+    (void)arg;
+    ts.tv_sec = (time_t)(Period / 1000u);
+    ts.tv_nsec = (long)(Period % 1000u) * 1000000L;
+
+    while (atomic_load(&Running) == TRUE)
+    {
+        nanosleep(&ts, NULL);
+        (void)AppLog_flush();
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,119 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef LOG_H_
+#define LOG_H_
+
+/**
+ * \file       Log.h
+ * \brief      Header file for the asynchronous Logger.
+ *
+ * A log call does not format anything. It stores the pointer to the format string, the time
+ * and the raw arguments as a binary record in a byte ring owned by the calling thread, so it
+ * needs no lock and no system call. The flush, from a background thread or a low priority
+ * task, formats the records of every ring and writes them in batches with writev. A full ring
+ * drops the record and counts it, the hot path never waits for the output. The ring of a
+ * thread that ends goes to the next thread that logs once the flush emptied it.
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdatomic.h>
+#include "Scheduler.h"
+
+/*----------------------------------------------------------------------------*/
+/*                             Defines and macros                             */
+/*----------------------------------------------------------------------------*/
+
+#ifndef LOG_RING_N
+#define LOG_RING_N              65536u      /*!< Bytes of every thread ring, power of two */
+#endif
+#define LOG_THREADS_N           16u         /*!< Maximum number of threads that log at the same time */
+#define LOG_ARGS_N              8u          /*!< Arguments kept per record, the rest are dropped */
+#define LOG_STRING_N            64u         /*!< Bytes of a %s argument copied into the record */
+#define LOG_LINE_N              256u        /*!< Longest formatted line, longer lines are cut */
+#define LOG_IOV_N               64u         /*!< Lines written by one writev */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Structure to represent the ring of one thread
+ *
+ * Same fields as AppBuffer_Buffer, but Head and Tail run freely and are atomic, only the
+ * owner thread moves Head and only the flush moves Tail.
+ */
+typedef struct _AppLog_Ring
+{
+    unsigned char Buffer[LOG_RING_N];   /*!< Records, never split at the end */
+    uint32_t Elements;                  /*!< Bytes of Buffer */
+    _Atomic uint64_t Head;              /*!< Bytes written since the thread started logging */
+    _Atomic uint64_t Tail;              /*!< Bytes flushed */
+    _Atomic uint32_t dropped;           /*!< Records lost because the ring was full */
+    _Atomic uint32_t state;             /*!< In use, left by an ended thread, or free for the next thread */
+} AppLog_Ring;
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Sets the output of the logger and the time the line timestamps count from
+ *
+ * @param fd File descriptor the lines are written to, for example STDOUT_FILENO
+ */
+void AppLog_init( int fd );
+
+/**
+ * @brief Logs one line, lock-free and safe from any thread
+ *
+ * The format is kept by pointer and used at the flush, it has to be a string literal or live
+ * as long as the logger. The arguments follow printf, without * widths, %n, %lc, %ls and
+ * conversions of more than 23 characters with their %, and the strings of %s are copied up to
+ * LOG_STRING_N bytes. The first conversion that is not supported ends the arguments, the rest
+ * of the format is copied as is. The line gets a
+ * timestamp and a newline.
+ *
+ * @param format printf format
+ * @return uint8_t TRUE if the record was stored, FALSE if the ring was full or the thread has none
+ */
+uint8_t AppLog_write( const char *format, ... ) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief Formats and writes every record stored so far, from one thread at a time
+ *
+ * The records of all the threads are written in the order of their timestamps. A record stored
+ * while the flush runs waits for the next one, so two flushes may still overlap in time. A
+ * second caller while a flush runs returns at once.
+ *
+ * @return uint32_t Number of lines written
+ */
+uint32_t AppLog_flush( void );
+
+/**
+ * @brief Task function that flushes the logger, to register as a low priority task
+ */
+void AppLog_flushTask( void );
+
+/**
+ * @brief Starts a background thread that flushes the logger periodically
+ *
+ * @param period Time between two flushes in ms
+ * @return uint8_t TRUE if the thread was started, FALSE otherwise
+ */
+uint8_t AppLog_startThread( uint32_t period );
+
+/**
+ * @brief Stops the background thread after a last flush
+ */
+void AppLog_stopThread( void );
+
+/**
+ * @brief Returns the records dropped because a ring was full, for every thread
+ *
+ * @return uint32_t Number of records dropped
+ */
+uint32_t AppLog_dropped( void );
+
+#endif /* LOG_H_ */
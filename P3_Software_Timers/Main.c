@@ -3,8 +3,23 @@
 /*----------------------------------------------------------------------------*/
 
 #include <stdio.h>
+#include <unistd.h>
 #include "Scheduler.h"
 #include "Software_Timers.h"
+#include "Worker_Pool.h"
+#include "Task_Event.h"
+#include "Task_Profiling.h"
+#include "Trace.h"
+#include "Log.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Global Variables                             */
+/*----------------------------------------------------------------------------*/
+
+static AppPool_Pool Pool;   /* Worker threads that run the tasks */
+static uint32_t Messages[ 8 ];  /* Buffer of the queue of Task_Queue */
+static AppQue_Queue Queue = { Messages, 8u, sizeof(uint32_t) };
+static AppEvt_Event Event;  /* Releases Task_Queue when the timer posts a message */
 
 /*----------------------------------------------------------------------------*/
 /*                            Function Prototypes                             */
@@ -12,8 +27,11 @@
 
 void Init_500ms(void);
 void Task_500ms(void);
+void Task_Stats(void);
+void Task_Queue(void);
 void Callback(void);
 void Callback2(void);
+void Callback_Once(void *ctx);
 
 /*----------------------------------------------------------------------------*/
 /*                                  Main                                      */
@@ -29,15 +47,39 @@ int main( void )
     Sche.taskPtr = tasks;   /* Pointer to buffer for the TCB tasks */
     Sche.timers = TIMERS_N;
     Sche.timerPtr = timers; /* Pointer to buffer for the TCB TIMERS */
+    Sche.mode = APPSCHED_MODE_TICKLESS; /* Sleep until the next deadline instead of polling every tick */
 
     AppSched_initScheduler( &Sche );
 
+    /* Tasks and callbacks only store their log records, a thread writes them every 100 ms */
+    AppLog_init( STDOUT_FILENO );
+    AppLog_startThread( 100u );
+
     /* Register task with their corresponding init functions and periodicity*/
     TaskID1 = AppSched_registerTask( &Sche, Init_500ms, Task_500ms, 500 );
+
+    /* Run the tasks on two worker threads, Task_500ms never overlaps itself */
+    AppSched_initPool( &Sche, &Pool, 2u );
+    AppSched_reentrantTask( &Sche, TaskID1, FALSE );
+
+    /* Task_Queue has no period, it runs once for all the messages posted since its last run */
+    AppQueue_initQueue( &Queue );
+    AppEvt_initEvent( &Event, &Queue );
+    TaskID3 = AppSched_registerEventTask( &Sche, NULL, Task_Queue, &Event, TRUE );
+
+#if (APPSCHED_PROFILING == TRUE)
+    /* Report the task statistics every 5 seconds */
+    TaskID2 = AppSched_registerTask( &Sche, NULL, Task_Stats, 5000 );
+#endif
+
     TimerID = AppSched_registerTimer( &Sche, 1000u, Callback );
-    printf ("This is timer ID: %d \n", TimerID);
+    AppLog_write("This is timer ID: %u", (unsigned)TimerID);
 
     AppSched_startTimer( &Sche, TimerID );
+
+    /* One-shot timer, the context tells the callback which timer expired */
+    TimerID2 = AppSched_createTimer( &Sche, 2500u, TIMER_MODE_ONE_SHOT, Callback_Once, "tim2" );
+    AppSched_startTimer( &Sche, TimerID2 );
     
     /* Uncomment to test timer reload and stop functionality */
     //AppSched_reloadTimer( &Sche, 1, 1500);
@@ -45,6 +87,17 @@ int main( void )
 
     /* Run the scheduler for the amount of time established in Sche.timeout */
     AppSched_startScheduler( &Sche );
+    AppPool_stopPool( &Pool );
+    AppLog_stopThread();
+    AppSched_releaseTasks( &Sche );
+
+#if (APPSCHED_TRACE == TRUE)
+    /* Open trace.json with ui.perfetto.dev, trace.bin can be converted later with AppTrace_convertBinary */
+    AppTrace_exportChrome( "trace.json" );
+    AppTrace_dumpBinary( "trace.bin" );
+#endif
+
+    printf("Wakeups: %u, dispatches: %u \n", (unsigned)Sche.wakeups, (unsigned)Sche.dispatches);
     
     return 0;
 }
@@ -58,7 +111,7 @@ int main( void )
  */
 void Init_500ms(void)
 {
-    printf("Init task 500 millisecond \n");
+    AppLog_write("Init task 500 millisecond");
 }
 
 /**
@@ -67,7 +120,31 @@ void Init_500ms(void)
 void Task_500ms(void)
 {
     static int loop = 0;
-    printf("This is a counter from task 500ms: %d \n", loop++);
+    AppLog_write("This is a counter from task 500ms: %d", loop++);
+}
+
+/**
+ * @brief Task function that prints the runtime statistics of every task and of the timers.
+ */
+void Task_Stats(void)
+{
+#if (APPSCHED_PROFILING == TRUE)
+    AppSched_dumpTaskStats( &Sche, stdout, PROF_FORMAT_TEXT );
+    AppSched_dumpTimerStats( &Sche, stdout, PROF_FORMAT_TEXT );
+#endif
+}
+
+/**
+ * @brief Event task that prints the messages posted by the timer callback.
+ */
+void Task_Queue(void)
+{
+    uint32_t message;
+
+    while (AppEvt_readQueue( &Event, &message ) == TRUE)
+    {
+        AppLog_write("Message from the queue: %u", (unsigned)message);
+    }
 }
 
 /*----------------------------------------------------------------------------*/
@@ -79,10 +156,10 @@ void Task_500ms(void)
  */
 void Callback(void)
 {
-    static int loop = 0;
-    printf("This is a counter from timer callback tim1: %d \n", loop++);
-    AppSched_startTimer( &Sche,TimerID);
-
+    static uint32_t loop = 0;
+    AppLog_write("This is a counter from timer callback tim1: %u", (unsigned)loop);
+    AppSched_postQueue( &Sche, &Event, &loop );     /* Task_Queue runs right after */
+    loop++;
 }
 
 /**
@@ -91,8 +168,14 @@ void Callback(void)
 void Callback2(void)
 {
     static int loop = 0;
-    printf("This is a counter from timer callback tim2: %d \n", loop++);
-    AppSched_startTimer( &Sche,TimerID2);
+    AppLog_write("This is a counter from timer callback tim2: %d", loop++);
+}
 
+/**
+ * @brief Callback function for a one-shot timer, ctx is the name of the timer.
+ */
+void Callback_Once(void *ctx)
+{
+    AppLog_write("One-shot timer %s expired", (const char *)ctx);
 }
 
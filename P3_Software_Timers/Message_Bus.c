@@ -0,0 +1,238 @@
+/**
+ * \file       Message_Bus.c
+ * \brief      Implementation for the publish/subscribe Message Bus
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include "Scheduler.h"
+#include "Task_Event.h"
+#include "Message_Bus.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define FREE_INDEX(top)         ((uint32_t)(top))
+#define FREE_TAG(top)           ((top) >> 32u)
+#define FREE_TOP(tag, index)    (((uint64_t)(tag) << 32u) | (uint64_t)(index))
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of local functions                       */
+/*----------------------------------------------------------------------------*/
+static void AppBus_free( AppBus_Bus *bus, AppBus_Message *message );
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+void AppBus_initBus( AppBus_Bus *bus )
+{
+    for (uint32_t m = 0; m < BUS_MESSAGES_N; m++)
+    {
+        atomic_init(&bus->message[m].refs, 0u);
+        atomic_init(&bus->message[m].nextFree, ((m + 1u) < BUS_MESSAGES_N) ? (m + 1u) : BUS_NONE);
+    }
+    atomic_init(&bus->freeTop, FREE_TOP(0u, 0u));
+
+    for (uint32_t t = 0; t < BUS_TOPICS_N; t++)
+    {
+        bus->topic[t].count = 0;
+    }
+
+    atomic_init(&bus->published, 0u);
+    atomic_init(&bus->delivered, 0u);
+    atomic_init(&bus->exhausted, 0u);
+}
+
+uint8_t AppBus_initSubscriber( AppBus_Subscriber *subscriber, AppSched_Scheduler *scheduler, AppQue_Queue *queue )
+{
+    /* A wider element would make AppEvt_readQueue write past the pointer of the reader */
+    if ((queue == NULL) || (queue->Size != sizeof(AppBus_Message *)))
+    {
+        return FALSE;
+    }
+
+    AppEvt_initEvent(&subscriber->event, queue);
+    subscriber->scheduler = scheduler;
+
+    return TRUE;
+}
+
+uint8_t AppBus_subscribe( AppBus_Bus *bus, uint32_t topic, AppBus_Subscriber *subscriber )
+{
+    AppBus_Topic *entry;
+
+    if ((topic >= BUS_TOPICS_N) || (subscriber == NULL))
+    {
+        return FALSE;
+    }
+
+    entry = &bus->topic[topic];
+    if (entry->count == BUS_SUBSCRIBERS_N)
+    {
+        return FALSE; /* No space left */
+    }
+    entry->subscriber[entry->count] = subscriber;
+    entry->count++;
+
+    return TRUE;
+}
+
+uint8_t AppBus_unsubscribe( AppBus_Bus *bus, uint32_t topic, AppBus_Subscriber *subscriber )
+{
+    AppBus_Topic *entry;
+
+    if (topic >= BUS_TOPICS_N)
+    {
+        return FALSE;
+    }
+
+    /* The order of the subscribers does not matter, the last one takes the place */
+    entry = &bus->topic[topic];
+    for (uint32_t s = 0; s < entry->count; s++)
+    {
+        if (entry->subscriber[s] == subscriber)
+        {
+            entry->count--;
+            entry->subscriber[s] = entry->subscriber[entry->count];
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+AppBus_Message *AppBus_alloc( AppBus_Bus *bus )
+{
+    uint64_t top = atomic_load_explicit(&bus->freeTop, memory_order_acquire);
+    AppBus_Message *message;
+    uint32_t next;
+
+    /* Lock-free stack, the change counter keeps a buffer freed and taken again in between from
+       passing the compare */
+    do
+    {
+        if (FREE_INDEX(top) == BUS_NONE)
+        {
+            atomic_fetch_add_explicit(&bus->exhausted, 1u, memory_order_relaxed);
+            return NULL;
+        }
+        message = &bus->message[FREE_INDEX(top)];
+        next = atomic_load_explicit(&message->nextFree, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&bus->freeTop, &top, FREE_TOP(FREE_TAG(top) + 1u, next),
+                                                    memory_order_acquire, memory_order_acquire));
+
+    atomic_store_explicit(&message->refs, 1u, memory_order_relaxed);    /* Held by the publisher */
+
+    return message;
+}
+
+uint32_t AppBus_publish( AppBus_Bus *bus, uint32_t topic, AppBus_Message *message, uint32_t length )
+{
+    AppBus_Topic *entry;
+    uint32_t delivered = 0;
+
+    if ((topic >= BUS_TOPICS_N) || (length > BUS_MESSAGE_SIZE))
+    {
+        AppBus_release(bus, message);
+        return 0;
+    }
+
+    entry = &bus->topic[topic];
+    message->topic = topic;
+    message->length = length;
+
+    /* Every subscriber gets its reference before the first one can release it. The publisher
+       keeps its own until the end, so a fast subscriber cannot free the buffer during the loop */
+    atomic_fetch_add_explicit(&message->refs, entry->count, memory_order_relaxed);
+    for (uint32_t s = 0; s < entry->count; s++)
+    {
+        /* The queue lock of the event publishes the payload to the subscriber */
+        if (AppSched_postQueue(entry->subscriber[s]->scheduler, &entry->subscriber[s]->event, &message) == TRUE)
+        {
+            delivered++;
+        }
+        else
+        {
+            AppBus_release(bus, message);   /* Counted in the dropped field of the event */
+        }
+    }
+    AppBus_release(bus, message);
+
+    atomic_fetch_add_explicit(&bus->published, 1u, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bus->delivered, delivered, memory_order_relaxed);
+
+    return delivered;
+}
+
+uint32_t AppBus_publishCopy( AppBus_Bus *bus, uint32_t topic, const void *data, uint32_t length )
+{
+    AppBus_Message *message;
+
+    if (length > BUS_MESSAGE_SIZE)
+    {
+        return 0;
+    }
+
+    message = AppBus_alloc(bus);
+    if (message == NULL)
+    {
+        return 0;
+    }
+
+    /* The only copy of the payload */
+    memcpy(message->data, data, length);
+
+    return AppBus_publish(bus, topic, message, length);
+}
+
+AppBus_Message *AppBus_receive( AppBus_Subscriber *subscriber )
+{
+    AppBus_Message *message = NULL;
+
+    if (AppEvt_readQueue(&subscriber->event, &message) == FALSE)
+    {
+        return NULL;
+    }
+
+    return message;
+}
+
+void AppBus_retain( AppBus_Message *message )
+{
+    atomic_fetch_add_explicit(&message->refs, 1u, memory_order_relaxed);
+}
+
+void AppBus_release( AppBus_Bus *bus, AppBus_Message *message )
+{
+    /* The last reader sees the writes of the others before the buffer is reused */
+    if (atomic_fetch_sub_explicit(&message->refs, 1u, memory_order_acq_rel) == 1u)
+    {
+        AppBus_free(bus, message);
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of local functions                      */
+/*----------------------------------------------------------------------------*/
+
+static void AppBus_free( AppBus_Bus *bus, AppBus_Message *message )
+{
+    uint64_t top = atomic_load_explicit(&bus->freeTop, memory_order_relaxed);
+    uint32_t index = (uint32_t)(message - bus->message);
+
+    do
+    {
+        atomic_store_explicit(&message->nextFree, FREE_INDEX(top), memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&bus->freeTop, &top, FREE_TOP(FREE_TAG(top) + 1u, index),
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
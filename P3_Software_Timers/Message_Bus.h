@@ -0,0 +1,189 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef MESSAGE_BUS_H_
+#define MESSAGE_BUS_H_
+
+/**
+ * \file       Message_Bus.h
+ * \brief      Header file for the publish/subscribe Message Bus.
+ *
+ * A publisher writes a message once into a buffer of the pool of the bus. Every subscriber of
+ * the topic gets only a pointer to it, through the queue of its event, so an event task runs
+ * on arrival. The buffer counts its references atomically and goes back to the pool when the
+ * last subscriber releases it, so fanning out costs one pointer per subscriber, whatever the
+ * size of the message.
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdatomic.h>
+#include "Scheduler.h"
+#include "Queue.h"
+#include "Task_Event.h"
+
+/*----------------------------------------------------------------------------*/
+/*                             Defines and macros                             */
+/*----------------------------------------------------------------------------*/
+
+#ifndef BUS_MESSAGES_N
+#define BUS_MESSAGES_N          256u        /*!< Buffers of the pool */
+#endif
+#ifndef BUS_MESSAGE_SIZE
+#define BUS_MESSAGE_SIZE        1024u       /*!< Payload bytes of a buffer */
+#endif
+#define BUS_TOPICS_N            32u         /*!< Topics of a bus, the topic ID is the index */
+#define BUS_SUBSCRIBERS_N       16u         /*!< Subscribers of one topic */
+#define BUS_NONE                0xFFFFFFFFu /*!< End of the free list */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Structure to represent a message buffer of the pool
+ */
+typedef struct _AppBus_Message
+{
+    _Atomic uint32_t refs;                  /*!< References not released yet, 0 while in the pool */
+    _Atomic uint32_t nextFree;              /*!< Next buffer of the free list */
+    uint32_t topic;                         /*!< Topic the message was published on */
+    uint32_t length;                        /*!< Payload bytes used */
+    unsigned char data[BUS_MESSAGE_SIZE];   /*!< Payload, written once by the publisher */
+} AppBus_Message;
+
+/**
+ * @brief Structure to represent a subscriber, its event task reads the messages
+ *
+ * The queue of the event holds AppBus_Message pointers, its Size is sizeof(AppBus_Message *).
+ */
+typedef struct _AppBus_Subscriber
+{
+    AppEvt_Event event;                     /*!< Signaled once per message, to register with the task */
+    AppSched_Scheduler *scheduler;          /*!< Scheduler of the event task, woken by a publish */
+} AppBus_Subscriber;
+
+/**
+ * @brief Structure to represent a topic
+ */
+typedef struct _AppBus_Topic
+{
+    AppBus_Subscriber *subscriber[BUS_SUBSCRIBERS_N]; /*!< Subscribers of the topic */
+    uint32_t count;                         /*!< Subscribers in use */
+} AppBus_Topic;
+
+/**
+ * @brief Structure to represent a bus, its pool and its topics
+ */
+typedef struct _AppBus_Bus
+{
+    AppBus_Message message[BUS_MESSAGES_N]; /*!< Pool of buffers */
+    _Atomic uint64_t freeTop;               /*!< First free buffer in the low 32 bits, a change counter in the high ones */
+    AppBus_Topic topic[BUS_TOPICS_N];       /*!< Topics */
+    _Atomic uint32_t published;             /*!< Messages published */
+    _Atomic uint32_t delivered;             /*!< Pointers queued to the subscribers */
+    _Atomic uint32_t exhausted;             /*!< Allocations refused because the pool was empty */
+} AppBus_Bus;
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes a bus with every buffer free and no subscriber
+ *
+ * @param bus Pointer to the bus
+ */
+void AppBus_initBus( AppBus_Bus *bus );
+
+/**
+ * @brief Initializes a subscriber
+ *
+ * Register an event task on &subscriber->event to run it on every message.
+ *
+ * @param subscriber Pointer to the subscriber
+ * @param scheduler Scheduler of the event task
+ * @param queue Initialized queue with Size sizeof(AppBus_Message *), it bounds the messages pending
+ * @return uint8_t TRUE if the subscriber was initialized, FALSE if the queue is missing or of another Size
+ */
+uint8_t AppBus_initSubscriber( AppBus_Subscriber *subscriber, AppSched_Scheduler *scheduler, AppQue_Queue *queue );
+
+/**
+ * @brief Adds a subscriber to a topic, not while the topic is being published to
+ *
+ * @param bus Pointer to the bus
+ * @param topic Topic ID, below BUS_TOPICS_N
+ * @param subscriber Pointer to an initialized subscriber
+ * @return uint8_t TRUE if the subscriber was added, FALSE if the topic is invalid or full
+ */
+uint8_t AppBus_subscribe( AppBus_Bus *bus, uint32_t topic, AppBus_Subscriber *subscriber );
+
+/**
+ * @brief Removes a subscriber from a topic, not while the topic is being published to
+ *
+ * The messages already queued to it still have to be released.
+ *
+ * @param bus Pointer to the bus
+ * @param topic Topic ID
+ * @param subscriber Pointer to the subscriber
+ * @return uint8_t TRUE if the subscriber was removed, FALSE if it was not subscribed
+ */
+uint8_t AppBus_unsubscribe( AppBus_Bus *bus, uint32_t topic, AppBus_Subscriber *subscriber );
+
+/**
+ * @brief Takes a buffer from the pool, lock-free and safe from any thread
+ *
+ * @param bus Pointer to the bus
+ * @return AppBus_Message* Buffer to write the payload to, NULL if the pool is empty
+ */
+AppBus_Message *AppBus_alloc( AppBus_Bus *bus );
+
+/**
+ * @brief Queues a message to every subscriber of a topic, safe from any thread
+ *
+ * The publisher gives its buffer away, it must not touch it afterwards. A subscriber with a
+ * full queue misses the message, its event counts it in dropped.
+ *
+ * @param bus Pointer to the bus
+ * @param topic Topic ID
+ * @param message Buffer from AppBus_alloc with the payload written
+ * @param length Payload bytes, up to BUS_MESSAGE_SIZE
+ * @return uint32_t Number of subscribers the message was queued to
+ */
+uint32_t AppBus_publish( AppBus_Bus *bus, uint32_t topic, AppBus_Message *message, uint32_t length );
+
+/**
+ * @brief Copies data into a buffer of the pool and publishes it
+ *
+ * @param bus Pointer to the bus
+ * @param topic Topic ID
+ * @param data Payload to copy
+ * @param length Payload bytes, up to BUS_MESSAGE_SIZE
+ * @return uint32_t Number of subscribers the message was queued to, 0 also if the pool is empty
+ */
+uint32_t AppBus_publishCopy( AppBus_Bus *bus, uint32_t topic, const void *data, uint32_t length );
+
+/**
+ * @brief Takes the oldest message queued to a subscriber, called by its event task
+ *
+ * @param subscriber Pointer to the subscriber
+ * @return AppBus_Message* Message to read and then release, NULL if none is pending
+ */
+AppBus_Message *AppBus_receive( AppBus_Subscriber *subscriber );
+
+/**
+ * @brief Adds a reference to a message, for a subscriber that keeps it or hands it on
+ *
+ * @param message Message the caller holds a reference to
+ */
+void AppBus_retain( AppBus_Message *message );
+
+/**
+ * @brief Drops a reference, the last one returns the buffer to the pool
+ *
+ * @param bus Pointer to the bus
+ * @param message Message the caller holds a reference to
+ */
+void AppBus_release( AppBus_Bus *bus, AppBus_Message *message );
+
+#endif /* MESSAGE_BUS_H_ */
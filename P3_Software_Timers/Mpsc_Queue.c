@@ -0,0 +1,93 @@
+/**
+ * \file       Mpsc_Queue.c
+ * \brief      Implementation for the bounded lock-free queue of many producers and one consumer
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include "Scheduler.h"
+#include "Mpsc_Queue.h"
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+void AppMpsc_initQueue( AppMpsc_Queue *queue, _Atomic uint32_t *sequence, uint32_t count )
+{
+    atomic_init(&queue->head, 0u);
+    queue->tail = 0;
+    queue->sequence = sequence;
+    queue->count = count;
+    for (uint32_t c = 0; c < count; c++)
+    {
+        atomic_init(&sequence[c], c);
+    }
+    atomic_init(&queue->full, 0u);
+}
+
+uint8_t AppMpsc_claim( AppMpsc_Queue *queue, uint32_t *pos )
+{
+    uint32_t claim = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    int32_t diff;
+
+    for (;;)
+    {
+        diff = (int32_t)(atomic_load_explicit(&queue->sequence[claim & (queue->count - 1u)], memory_order_acquire) - claim);
+
+        if (diff == 0)
+        {
+            /* The cell is free, claim the position against the other producers */
+            if (atomic_compare_exchange_weak_explicit(&queue->head, &claim, claim + 1u,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            /* The consumer has not taken the element of the previous round yet */
+            atomic_fetch_add_explicit(&queue->full, 1u, memory_order_relaxed);
+            return FALSE;
+        }
+        else
+        {
+            claim = atomic_load_explicit(&queue->head, memory_order_relaxed);  /* Another producer won */
+        }
+    }
+
+    *pos = claim;
+
+    return TRUE;
+}
+
+void AppMpsc_publish( AppMpsc_Queue *queue, uint32_t pos )
+{
+    atomic_store_explicit(&queue->sequence[pos & (queue->count - 1u)], pos + 1u, memory_order_release);
+}
+
+uint8_t AppMpsc_peek( AppMpsc_Queue *queue, uint32_t *slot )
+{
+    uint32_t index = queue->tail & (queue->count - 1u);
+
+    if (atomic_load_explicit(&queue->sequence[index], memory_order_acquire) != (queue->tail + 1u))
+    {
+        return FALSE;
+    }
+
+    *slot = index;
+
+    return TRUE;
+}
+
+void AppMpsc_release( AppMpsc_Queue *queue )
+{
+    atomic_store_explicit(&queue->sequence[queue->tail & (queue->count - 1u)], queue->tail + queue->count,
+                          memory_order_release);
+    queue->tail++;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
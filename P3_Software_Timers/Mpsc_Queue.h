@@ -0,0 +1,88 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef MPSC_QUEUE_H_
+#define MPSC_QUEUE_H_
+
+/**
+ * \file       Mpsc_Queue.h
+ * \brief      Header file for the bounded lock-free queue of many producers and one consumer.
+ *
+ * The queue only hands out positions, the owner keeps the elements in an array of its own type
+ * next to the sequence array and copies them in and out at pos & (count - 1). Every cell has a
+ * sequence that tells who owns it: the cell at position pos is free for a producer when
+ * sequence == pos, and holds an element for the consumer when sequence == pos + 1. Used by the
+ * command queue of the timer service and by the inbox of a scheduler group instance.
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdatomic.h>
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Structure to represent the positions of a queue
+ */
+typedef struct _AppMpsc_Queue
+{
+    _Atomic uint32_t head;                  /*!< Next position to post, shared by the producers */
+    uint32_t tail;                          /*!< Next position to take (consumer thread) */
+    _Atomic uint32_t *sequence;             /*!< Sequence of every cell */
+    uint32_t count;                         /*!< Cells of the queue, power of two */
+    _Atomic uint32_t full;                  /*!< Posts refused because the queue was full */
+} AppMpsc_Queue;
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes an empty queue
+ *
+ * @param queue Pointer to the queue
+ * @param sequence Array of count sequences, one per element of the owner
+ * @param count Cells of the queue, power of two
+ */
+void AppMpsc_initQueue( AppMpsc_Queue *queue, _Atomic uint32_t *sequence, uint32_t count );
+
+/**
+ * @brief Claims the next free cell, safe from any thread and lock-free
+ *
+ * The producer copies its element to pos & (count - 1) and calls AppMpsc_publish with pos.
+ *
+ * @param queue Pointer to the queue
+ * @param pos Where to store the claimed position
+ * @return uint8_t TRUE if a cell was claimed, FALSE if the queue is full
+ */
+uint8_t AppMpsc_claim( AppMpsc_Queue *queue, uint32_t *pos );
+
+/**
+ * @brief Hands a claimed cell to the consumer once its element is written
+ *
+ * @param queue Pointer to the queue
+ * @param pos Position returned by AppMpsc_claim
+ */
+void AppMpsc_publish( AppMpsc_Queue *queue, uint32_t pos );
+
+/**
+ * @brief Tells if the oldest cell holds an element, consumer thread only
+ *
+ * A claimed cell still being written counts as empty, it is taken on the next call.
+ *
+ * @param queue Pointer to the queue
+ * @param slot Where to store the index of the element
+ * @return uint8_t TRUE if there is an element at slot, FALSE if the queue is empty
+ */
+uint8_t AppMpsc_peek( AppMpsc_Queue *queue, uint32_t *slot );
+
+/**
+ * @brief Gives the oldest cell back to the producers once its element is copied, consumer thread only
+ *
+ * @param queue Pointer to the queue
+ */
+void AppMpsc_release( AppMpsc_Queue *queue );
+
+#endif /* MPSC_QUEUE_H_ */
@@ -0,0 +1,216 @@
+/**
+ * \file       Rate_Limiter.c
+ * \brief      Implementation for the token bucket Rate Limiter
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "Scheduler.h"
+#include "Software_Timers.h"
+#include "Time_Source.h"
+#include "Rate_Limiter.h"
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of local functions                       */
+/*----------------------------------------------------------------------------*/
+static inline uint64_t AppRate_now( AppRate_Limiter *limiter );
+static void AppRate_refill( void *ctx );
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+void AppRate_initLimiter( AppRate_Limiter *limiter, AppRate_Bucket *bucket, uint32_t count, AppTime_Source *source )
+{
+    limiter->bucket = bucket;
+    limiter->count = count;
+    limiter->source = (source != NULL) ? source : &AppTime_monotonic;
+    atomic_init(&limiter->clock, 0u);
+    limiter->tickSource = NULL;
+    limiter->scheduler = NULL;
+    limiter->timer = FALSE;
+
+    for (uint32_t b = 0; b < count; b++)
+    {
+        atomic_init(&bucket[b].full, 0u);
+        bucket[b].interval = 0;
+        bucket[b].burst = 0;
+    }
+}
+
+uint8_t AppSched_initRateTick( AppSched_Scheduler *scheduler, AppRate_Limiter *limiter, uint32_t period )
+{
+    AppTime_Source *source = (scheduler->timeSource != NULL) ? scheduler->timeSource : &AppTime_monotonic;
+    uint32_t timer = AppSched_createTimer(scheduler, period, TIMER_MODE_AUTO_RELOAD, AppRate_refill, limiter);
+
+    if ((timer == FALSE) || (AppSched_startTimer(scheduler, timer) == FALSE))
+    {
+        return FALSE;
+    }
+
+    /* The buckets keep their fill times, the scheduler clock has to have the same time base */
+    limiter->tickSource = source;
+    limiter->scheduler = scheduler;
+    limiter->timer = timer;
+    atomic_store_explicit(&limiter->clock, source->now(source), memory_order_relaxed);
+    limiter->source = NULL;
+
+    return TRUE;
+}
+
+uint8_t AppRate_setBucket( AppRate_Limiter *limiter, uint32_t bucket, uint32_t rate, uint32_t burst )
+{
+    if ((bucket >= limiter->count) || (rate == 0u) || (burst == 0u))
+    {
+        return FALSE;
+    }
+
+    limiter->bucket[bucket].interval = (uint32_t)((NS_PER_S + rate - 1u) / rate);   /* Never above the rate */
+    limiter->bucket[bucket].burst = burst;
+    atomic_store_explicit(&limiter->bucket[bucket].full, 0u, memory_order_relaxed);  /* Full from the start */
+
+    return TRUE;
+}
+
+uint8_t AppRate_tryAcquire( AppRate_Limiter *limiter, uint32_t bucket, uint32_t n )
+{
+    AppRate_Bucket *entry;
+    uint64_t now;
+    uint64_t full;
+    uint64_t next;
+    uint64_t capacity;
+
+    if ((bucket >= limiter->count) || (limiter->bucket[bucket].interval == 0u))
+    {
+        return FALSE;
+    }
+
+    entry = &limiter->bucket[bucket];
+    capacity = (uint64_t)entry->burst * entry->interval;
+    now = AppRate_now(limiter);
+    full = atomic_load_explicit(&entry->full, memory_order_relaxed);
+
+    /* Taking n tokens moves the fill time n intervals later. They are there while the bucket
+       is not emptier than that, so a failed compare only retries with the new fill time */
+    do
+    {
+        next = ((full > now) ? full : now) + ((uint64_t)n * entry->interval);
+        if ((next - now) > capacity)
+        {
+            return FALSE;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&entry->full, &full, next,
+                                                    memory_order_relaxed, memory_order_relaxed));
+
+    return TRUE;
+}
+
+uint32_t AppRate_tokens( AppRate_Limiter *limiter, uint32_t bucket )
+{
+    AppRate_Bucket *entry;
+    uint64_t now;
+    uint64_t full;
+    uint64_t capacity;
+
+    if ((bucket >= limiter->count) || (limiter->bucket[bucket].interval == 0u))
+    {
+        return 0;
+    }
+
+    entry = &limiter->bucket[bucket];
+    capacity = (uint64_t)entry->burst * entry->interval;
+    now = AppRate_now(limiter);
+    full = atomic_load_explicit(&entry->full, memory_order_relaxed);
+
+    if (full <= now)
+    {
+        return entry->burst;
+    }
+    if ((full - now) >= capacity)
+    {
+        return 0;
+    }
+
+    return (uint32_t)((capacity - (full - now)) / entry->interval);
+}
+
+uint64_t AppRate_earliest( AppRate_Limiter *limiter, uint32_t bucket, uint32_t n )
+{
+    AppRate_Bucket *entry;
+    uint64_t now;
+    uint64_t ready;
+    uint64_t capacity;
+
+    if ((bucket >= limiter->count) || (limiter->bucket[bucket].interval == 0u) || (n > limiter->bucket[bucket].burst))
+    {
+        return RATE_NEVER;
+    }
+
+    entry = &limiter->bucket[bucket];
+    capacity = (uint64_t)entry->burst * entry->interval;
+    now = AppRate_now(limiter);
+
+    /* The take succeeds once the fill time after it is at most a full bucket away */
+    ready = atomic_load_explicit(&entry->full, memory_order_relaxed) + ((uint64_t)n * entry->interval);
+    if (ready <= now + capacity)
+    {
+        return 0;
+    }
+
+    return ready - capacity - now;
+}
+
+uint8_t AppRate_armTimer( AppSched_Scheduler *scheduler, AppRate_Limiter *limiter, uint32_t bucket, uint32_t n, uint32_t timer )
+{
+    uint64_t wait = AppRate_earliest(limiter, bucket, n);
+    uint32_t timeout;
+
+    if (wait == RATE_NEVER)
+    {
+        return FALSE;
+    }
+
+    /* Rounded up, the timer must not expire before the tokens are there */
+    timeout = (uint32_t)((wait + NS_PER_MS - 1u) / NS_PER_MS);
+    if (scheduler->mode == APPSCHED_MODE_TICKLESS)
+    {
+        timeout = (timeout > 0u) ? timeout : 1u;
+    }
+    else
+    {
+        timeout = ((timeout + scheduler->tick - 1u) / scheduler->tick) * scheduler->tick;
+        timeout = (timeout > scheduler->tick) ? timeout : (2u * scheduler->tick);   /* Shortest valid timeout */
+    }
+
+    return AppSched_reloadTimer(scheduler, timer, timeout);
+}
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of local functions                      */
+/*----------------------------------------------------------------------------*/
+
+static inline uint64_t AppRate_now( AppRate_Limiter *limiter )
+{
+    if (limiter->source != NULL)
+    {
+        return limiter->source->now(limiter->source);
+    }
+
+    return atomic_load_explicit(&limiter->clock, memory_order_relaxed);
+}
+
+static void AppRate_refill( void *ctx )
+{
+    AppRate_Limiter *limiter = (AppRate_Limiter *)ctx;
+    AppTime_Source *source = limiter->tickSource;
+
+    /* One clock read for every bucket of the limiter, always on the time base it was seeded with */
+    atomic_store_explicit(&limiter->clock, source->now(source), memory_order_relaxed);
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
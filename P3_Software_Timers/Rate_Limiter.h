@@ -0,0 +1,142 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef RATE_LIMITER_H_
+#define RATE_LIMITER_H_
+
+/**
+ * \file       Rate_Limiter.h
+ * \brief      Header file for the token bucket Rate Limiter.
+ *
+ * A bucket does not store its tokens, it stores the time it will be full again (the
+ * theoretical arrival time of the GCRA). The tokens refill by the passing of time alone, so a
+ * take is one compare-and-swap on one word and any number of threads can take from the same
+ * bucket without a lock. The time is read from a time source on every take, or from a clock
+ * refreshed by a software timer, so thousands of buckets share one clock read per refill.
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdatomic.h>
+#include "Scheduler.h"
+#include "Time_Source.h"
+
+/*----------------------------------------------------------------------------*/
+/*                             Defines and macros                             */
+/*----------------------------------------------------------------------------*/
+
+#define NS_PER_S                1000000000ull           /*!< Nanoseconds in one second */
+#define RATE_NEVER              0xFFFFFFFFFFFFFFFFull   /*!< More tokens asked than the bucket holds */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Structure to represent a bucket, four of them share a cache line
+ */
+typedef struct __attribute__((aligned(16))) _AppRate_Bucket
+{
+    _Atomic uint64_t full;              /*!< Time the bucket holds burst tokens again, in the past if it does */
+    uint32_t interval;                  /*!< Time to refill one token in ns, 0 for a bucket never set */
+    uint32_t burst;                     /*!< Tokens the bucket holds when full */
+} AppRate_Bucket;
+
+/**
+ * @brief Structure to represent a limiter, the buckets and the clock they are refilled with
+ */
+typedef struct _AppRate_Limiter
+{
+    AppRate_Bucket *bucket;             /*!< Array of buckets, the bucket ID is the index */
+    uint32_t count;                     /*!< Buckets in the array */
+    AppTime_Source *source;             /*!< Clock read on every take, NULL when a timer refills */
+    _Atomic uint64_t clock;             /*!< Time of the last refill, used when source is NULL */
+    AppTime_Source *tickSource;         /*!< Clock read by the refill timer, fixed when it is started */
+    AppSched_Scheduler *scheduler;      /*!< Scheduler of the refill timer */
+    uint32_t timer;                     /*!< Handle of the refill timer, FALSE if none */
+} AppRate_Limiter;
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes a limiter that reads its time source on every take, every bucket unset
+ *
+ * @param limiter Pointer to the limiter
+ * @param bucket Array of buckets
+ * @param count Buckets in the array
+ * @param source Clock of the buckets, NULL for AppTime_monotonic
+ */
+void AppRate_initLimiter( AppRate_Limiter *limiter, AppRate_Bucket *bucket, uint32_t count, AppTime_Source *source );
+
+/**
+ * @brief Refills the buckets from an auto-reload software timer instead of reading the clock
+ *
+ * The timer callback reads a clock once and every take uses that time, so the tokens come in
+ * steps of period. The clock is the time source of the scheduler when this is called,
+ * AppTime_monotonic if it has none yet, and stays the same afterwards. Call before the
+ * scheduler starts, after its timeSource is set.
+ *
+ * @param scheduler Pointer to the scheduler
+ * @param limiter Pointer to an initialized limiter
+ * @param period Time between two refills in ms, a valid timer timeout
+ * @return uint8_t TRUE if the timer was started, FALSE otherwise
+ */
+uint8_t AppSched_initRateTick( AppSched_Scheduler *scheduler, AppRate_Limiter *limiter, uint32_t period );
+
+/**
+ * @brief Sets the rate and the burst of a bucket and fills it, not while it is in use
+ *
+ * @param limiter Pointer to the limiter
+ * @param bucket Bucket ID
+ * @param rate Tokens per second, at least 1
+ * @param burst Tokens the bucket holds, at least 1
+ * @return uint8_t TRUE if the bucket was set, FALSE if a parameter is invalid
+ */
+uint8_t AppRate_setBucket( AppRate_Limiter *limiter, uint32_t bucket, uint32_t rate, uint32_t burst );
+
+/**
+ * @brief Takes n tokens if the bucket holds them, lock-free and safe from any thread
+ *
+ * @param limiter Pointer to the limiter
+ * @param bucket Bucket ID
+ * @param n Tokens to take
+ * @return uint8_t TRUE if the tokens were taken, FALSE if there were not enough and none was taken
+ */
+uint8_t AppRate_tryAcquire( AppRate_Limiter *limiter, uint32_t bucket, uint32_t n );
+
+/**
+ * @brief Returns the tokens a bucket holds now
+ *
+ * @param limiter Pointer to the limiter
+ * @param bucket Bucket ID
+ * @return uint32_t Tokens that can be taken
+ */
+uint32_t AppRate_tokens( AppRate_Limiter *limiter, uint32_t bucket );
+
+/**
+ * @brief Returns the time until a bucket holds n tokens, if nobody takes them meanwhile
+ *
+ * @param limiter Pointer to the limiter
+ * @param bucket Bucket ID
+ * @param n Tokens wanted
+ * @return uint64_t Time in ns, 0 if they are there now, RATE_NEVER if n is above the burst
+ */
+uint64_t AppRate_earliest( AppRate_Limiter *limiter, uint32_t bucket, uint32_t n );
+
+/**
+ * @brief Starts a one-shot timer that expires once a bucket holds n tokens, from the scheduler thread
+ *
+ * The timeout is rounded up to a valid one, the callback can call AppRate_tryAcquire again.
+ *
+ * @param scheduler Pointer to the scheduler of the timer
+ * @param limiter Pointer to the limiter
+ * @param bucket Bucket ID
+ * @param n Tokens wanted
+ * @param timer Handle of a one-shot timer
+ * @return uint8_t TRUE if the timer was started, FALSE if n is above the burst or the timer is invalid
+ */
+uint8_t AppRate_armTimer( AppSched_Scheduler *scheduler, AppRate_Limiter *limiter, uint32_t bucket, uint32_t n, uint32_t timer );
+
+#endif /* RATE_LIMITER_H_ */
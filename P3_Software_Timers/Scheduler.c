@@ -13,10 +13,27 @@
 #include <time.h>
 #include "Scheduler.h"
 #include "Software_Timers.h"
+#include "Worker_Pool.h"
+#include "Timer_Wheel.h"
+#include "Timer_Service.h"
+#include "Timer_HighRes.h"
+#include "Task_Event.h"
+#include "Task_Coroutine.h"
+#include "Task_Pipeline.h"
+#include "Scheduler_Group.h"
+#include "Task_Profiling.h"
+#include "Trace.h"
 
 /*----------------------------------------------------------------------------*/
 /*                               Local defines                                */
 /*----------------------------------------------------------------------------*/
+#define JOB_TASK                0u          /*!< Pool job kind, a task release */
+#define JOB_TIMER               1u          /*!< Pool job kind, a deferred timer callback */
+#define JOB_KIND_SHIFT          32u         /*!< The job kind is above the 32 bit index */
+#define TASK_SLOT(handle)       (((handle) & TASK_INDEX_MASK) - 1u)
+#define TASK_BLOCK(index)       (31u - (uint32_t)__builtin_clz(((index) >> TASK_GROW_BITS) + 1u))
+#define ACTIVE_WORD(index)      ((index) >> 6u)         /*!< Word of activeEnable for a position of activePtr */
+#define ACTIVE_BIT(index)       (1ull << ((index) & 63u))
 
 /*----------------------------------------------------------------------------*/
 /*                       Declaration of Global Variables                      */
@@ -26,11 +43,30 @@ AppSched_Scheduler Sche;
 AppSched_Task tasks[ TASKS_N ];
 
 /* Tasks IDs */
-uint8_t TaskID1, TaskID2;
+uint32_t TaskID1, TaskID2, TaskID3;
 
 /*----------------------------------------------------------------------------*/
 /*                       Declaration of local functions                       */
 /*----------------------------------------------------------------------------*/
+static uint32_t AppSched_addTask( AppSched_Scheduler *scheduler, void (*initPtr)(void), void (*taskPtr)(void), uint32_t period, AppEvt_Event *event, uint8_t batch );
+static uint32_t AppSched_allocTask( AppSched_Scheduler *scheduler );
+static uint8_t AppSched_growTasks( AppSched_Scheduler *scheduler );
+static AppSched_Task *AppSched_slotTask( AppSched_Scheduler *scheduler, uint32_t index );
+static void AppSched_compactTasks( AppSched_Scheduler *scheduler );
+static void AppSched_syncTask( AppSched_Scheduler *scheduler, AppSched_Task *task );
+static void AppSched_runEvents( AppSched_Scheduler *scheduler );
+static void AppSched_runTick( AppSched_Scheduler *scheduler );
+static void AppSched_runTickless( AppSched_Scheduler *scheduler );
+static uint8_t AppSched_admitTask( AppSched_Scheduler *scheduler, AppSched_Task *task, uint64_t late );
+static void AppSched_advanceTask( AppSched_Scheduler *scheduler, AppSched_Task *task );
+static void AppSched_dispatchTask( AppSched_Scheduler *scheduler, AppSched_Task *task );
+static void AppSched_runJob( void *owner, uint64_t job );
+static void AppSched_releaseOutputs( AppSched_Scheduler *scheduler, AppSched_Task *task, AppSched_Task *done );
+static void AppSched_expireTimer( void *ctx, uint32_t index );
+static void AppSched_fireTimer( AppSched_Scheduler *scheduler, uint32_t index, uint64_t due );
+static void AppSched_applyCommands( AppSched_Scheduler *scheduler );
+static void AppSched_runHres( AppSched_Scheduler *scheduler, uint64_t limit );
+static void AppSched_execTask( AppSched_Scheduler *scheduler, AppSched_Task *task );
 
 /*----------------------------------------------------------------------------*/
 /*                     Implementation of global functions                     */
@@ -39,60 +75,147 @@ uint8_t TaskID1, TaskID2;
 void AppSched_initScheduler( AppSched_Scheduler *scheduler )
 {
     scheduler->tasksCount = 0;        /* Initialize the task counter */
+    scheduler->freeTask = TASK_NONE;
+    scheduler->retiredTask = TASK_NONE;
+    scheduler->tasksOwned = (scheduler->taskPtr == NULL) ? TRUE : FALSE; /* Allocated on the first task */
+    if (scheduler->tasksOwned == TRUE)
+    {
+        scheduler->tasks = 0;
+        memset(scheduler->taskBlock, 0, sizeof(scheduler->taskBlock));
+    }
+    scheduler->activePtr = NULL;      /* Allocated on the first task */
+    scheduler->activeDeadline = NULL;
+    scheduler->activeEnable = NULL;
+    scheduler->activeCount = 0;
+    scheduler->activeSize = 0;
     scheduler->tickCount  = 0;        /* Initialize the tick counter */
+    scheduler->eventsCount = 0;       /* No task waits for an event */
     scheduler->timersCount = 0;       /* Initialize the timer counter */
+    scheduler->freeTimer = TIMER_NONE;
+    scheduler->timerDeadline = NULL;  /* Allocated with the first timer */
+    scheduler->timersOwned = (scheduler->timerPtr == NULL) ? TRUE : FALSE; /* Allocated on the first timer */
+    if (scheduler->timersOwned == TRUE)
+    {
+        scheduler->timers = 0;
+    }
+    scheduler->now = 0;               /* Time base for the tickless deadlines */
+    scheduler->wakeups = 0;
+    scheduler->dispatches = 0;
+    scheduler->overloaded = 0;
+    scheduler->coalesced = 0;
+    scheduler->slackDelay = 0;
+    scheduler->wakeupsSaved = 0;
+    scheduler->dueCount = 0;
+    scheduler->pool = NULL;           /* Tasks run in the scheduler thread */
+    scheduler->wheel = NULL;          /* Timers are scanned on every tick */
+    scheduler->service = NULL;        /* Timers are only changed from the scheduler thread */
+    scheduler->hres = NULL;           /* No high resolution timers */
+    scheduler->inbox = NULL;          /* Not part of a group */
+    scheduler->reactor = NULL;        /* No file descriptors to watch */
+#if (APPSCHED_PROFILING == TRUE)
+    memset(&scheduler->timerStats, 0, sizeof(scheduler->timerStats));
+    memset(&scheduler->hresStats, 0, sizeof(scheduler->hresStats));
+#endif
 }
 
-uint8_t AppSched_registerTask( AppSched_Scheduler *scheduler, void (*initPtr)(void), void (*taskPtr)(void), uint32_t period )
+uint32_t AppSched_registerTask( AppSched_Scheduler *scheduler, void (*initPtr)(void), void (*taskPtr)(void), uint32_t period )
 {
-    uint8_t register_task_status;
-    
-    /* Set the task TCB with the following parameters */
-    AppSched_Task *newTask = &scheduler->taskPtr[scheduler->tasksCount]; /* Declares a pointer to an AppSched_Task structure */
+    return AppSched_addTask(scheduler, initPtr, taskPtr, period, NULL, FALSE);
+}
 
-    /* 1. Address of the function to hold the init routine/NULL for the given task */
-    if (initPtr == NULL) /* Evaluate if the task has an init routine */
+uint32_t AppSched_registerEventTask( AppSched_Scheduler *scheduler, void (*initPtr)(void), void (*taskPtr)(void), AppEvt_Event *event, uint8_t batch )
+{
+    uint32_t register_task_status = FALSE;
+
+    if (event != NULL)
     {
-        newTask->initFunc = NULL; /* A NULL parameter should be accepted by the function */
+        register_task_status = AppSched_addTask(scheduler, initPtr, taskPtr, 0u, event, batch);
     }
-    else /* If the task HAS an init routine */
+
+    return register_task_status;
+}
+
+uint8_t AppSched_unregisterTask( AppSched_Scheduler *scheduler, uint32_t task )
+{
+    uint8_t unregister_task_status = FALSE;
+    AppSched_Task *oldTask = AppSched_getTask(scheduler, task);
+
+    /* The join counters of a graph would wait for the task forever */
+    if ((oldTask != NULL) && (oldTask->inputs == 0u) && (oldTask->outputsCount == 0u))
     {
-        newTask->initFunc = initPtr; /* Address of the function to hold the init routine for the given task */
+        oldTask->startFlag = FALSE;
+        oldTask->used = FALSE;
+        oldTask->generation = (uint16_t)((oldTask->generation + 1u) & TASK_GEN_MASK);
+        AppSched_syncTask(scheduler, oldTask);
+        if ((oldTask->event != NULL) || (oldTask->co != NULL))
+        {
+            scheduler->eventsCount--;
+        }
+
+        /* A loop may be scanning the active array right now, it is compacted on the next wakeup */
+        oldTask->nextFree = scheduler->retiredTask;
+        scheduler->retiredTask = TASK_SLOT(task);
+        unregister_task_status = TRUE;
     }
 
-    /* 2. Address for the actual routine that will run as the task */
-    newTask->taskFunc = taskPtr;
+    return unregister_task_status;
+}
+
+AppSched_Task *AppSched_getTask( AppSched_Scheduler *scheduler, uint32_t task )
+{
+    AppSched_Task *found = NULL;
+    AppSched_Task *slot;
+    uint32_t index = TASK_SLOT(task);   /* ID 0 wraps around and fails the range check */
 
-    /* Validate the periodicity */
-    if ((period >= scheduler->tick) && (TIME_OUT % period == 0)) /* Should not be less than the tick value and always be multiple */
+    /* The slot must be in use and still on the generation the ID was created with */
+    if (index < scheduler->tasksCount)
     {
-        /* 3. The periodicity in milliseconds of the task to register */
-        newTask->period = period;
-        /* Periodicity Validated */
-        /* The function shall return a Task ID which will be a number from 1 to n task registered if the operation was a success */
-        register_task_status = (scheduler->tasksCount) + 1; /* Operation was a success */
-        newTask->startFlag = TRUE; /* Start to run task */
-        scheduler->tasksCount++;
+        slot = AppSched_slotTask(scheduler, index);
+        if ((slot->used == TRUE) && (slot->generation == (task >> TASK_INDEX_BITS)))
+        {
+            found = slot;
+        }
     }
-    else
+
+    return found;
+}
+
+void AppSched_releaseTasks( AppSched_Scheduler *scheduler )
+{
+    if (scheduler->tasksOwned == TRUE)
     {
-        /* Periodicity NOT Validated */
-        register_task_status = FALSE; /* Operation was NOT successful */
+        for (uint32_t k = 0; k < TASK_BLOCKS_N; k++)
+        {
+            free(scheduler->taskBlock[k]);
+            scheduler->taskBlock[k] = NULL;
+        }
+        scheduler->tasks = 0;
     }
-    
-    return register_task_status;
+    free(scheduler->activePtr);
+    free(scheduler->activeDeadline);
+    free(scheduler->activeEnable);
+    scheduler->activePtr = NULL;
+    scheduler->activeDeadline = NULL;
+    scheduler->activeEnable = NULL;
+    scheduler->activeCount = 0;
+    scheduler->activeSize = 0;
+    scheduler->tasksCount = 0;
+    scheduler->eventsCount = 0;
+    scheduler->freeTask = TASK_NONE;
+    scheduler->retiredTask = TASK_NONE;
 }
 
-uint8_t AppSched_stopTask( AppSched_Scheduler *scheduler, uint8_t task )
+uint8_t AppSched_stopTask( AppSched_Scheduler *scheduler, uint32_t task )
 {
     uint8_t stop_task_status;
 
     /* Stop task of a specific task */
-    AppSched_Task *stopTask = &scheduler->taskPtr[task - 1];
+    AppSched_Task *stopTask = AppSched_getTask(scheduler, task);
 
-    if ((task > 0) && (task <= TASKS_N))
+    if (stopTask != NULL)
     {
         stopTask->startFlag = FALSE;
+        AppSched_syncTask(scheduler, stopTask);
         stop_task_status = TRUE;   /* The function will return TRUE if the task was stopped */
     }
     else
@@ -103,16 +226,22 @@ uint8_t AppSched_stopTask( AppSched_Scheduler *scheduler, uint8_t task )
     return stop_task_status;
 }
 
-uint8_t AppSched_startTask( AppSched_Scheduler *scheduler, uint8_t task )
+uint8_t AppSched_startTask( AppSched_Scheduler *scheduler, uint32_t task )
 {
     uint8_t start_task_status;
 
     /* Start task of a specific task */
-    AppSched_Task *startTask = &scheduler->taskPtr[task - 1];
+    AppSched_Task *startTask = AppSched_getTask(scheduler, task);
 
-    if ((task > 0) && (task <= TASKS_N))
+    if (startTask != NULL)
     {
+        if ((scheduler->mode == APPSCHED_MODE_TICKLESS) && (startTask->startFlag == FALSE))
+        {
+            /* Releases missed while stopped are not replayed, the task starts a new period from now */
+            startTask->deadline = scheduler->now + (uint64_t)startTask->period * NS_PER_MS;
+        }
         startTask->startFlag = TRUE;
+        AppSched_syncTask(scheduler, startTask);
         start_task_status = TRUE;   /* TRUE if the task was started */ 
     }
     else
@@ -123,20 +252,21 @@ uint8_t AppSched_startTask( AppSched_Scheduler *scheduler, uint8_t task )
     return start_task_status;
 }
 
-uint8_t AppSched_periodTask( AppSched_Scheduler *scheduler, uint8_t task, uint32_t period )
+uint8_t AppSched_periodTask( AppSched_Scheduler *scheduler, uint32_t task, uint32_t period )
 {
     uint8_t period_task_status;
 
-    AppSched_Task *periodTask = &scheduler->taskPtr[task - 1];
+    AppSched_Task *periodTask = AppSched_getTask(scheduler, task);
 
-    if ((task > 0) && (task <= TASKS_N))
+    if (periodTask != NULL)
     {
-        if (TICK_VAL % period == 0) /* Should not be less than the tick value and always be multiple */
+        if (AppSched_validPeriod(scheduler, period) == TRUE)
         {
             /* The periodicity in milliseconds of the task to register */
             periodTask->period = period;
             /* Periodicity Validated */
             periodTask->startFlag = TRUE; /* Start to run task */
+            AppSched_syncTask(scheduler, periodTask);
             period_task_status = TRUE;   /* TRUE if the task period was changed */
         }
         else
@@ -152,24 +282,111 @@ uint8_t AppSched_periodTask( AppSched_Scheduler *scheduler, uint8_t task, uint32
     return period_task_status;
 }
 
-long milliseconds(void)
+uint8_t AppSched_initPool( AppSched_Scheduler *scheduler, AppPool_Pool *pool, uint8_t workers )
+{
+    uint8_t init_pool_status;
+
+    pool->workers = workers;
+    pool->owner = scheduler;
+    pool->runFunc = AppSched_runJob;
+
+    init_pool_status = AppPool_initPool(pool);
+    if (init_pool_status == TRUE)
+    {
+        scheduler->pool = pool;
+    }
+
+    return init_pool_status;
+}
+
+uint8_t AppSched_pinTask( AppSched_Scheduler *scheduler, uint32_t task, uint8_t worker )
+{
+    uint8_t pin_task_status;
+    AppSched_Task *pinTask = AppSched_getTask(scheduler, task);
+
+    /* Only a worker of the pool, so the task does not end up on another one */
+    if ((pinTask != NULL) && ((worker == POOL_ANY_WORKER) || (scheduler->pool == NULL) || (worker < scheduler->pool->workers)))
+    {
+        pinTask->worker = worker;
+        pin_task_status = TRUE;
+    }
+    else
+    {
+        pin_task_status = FALSE;
+    }
+
+    return pin_task_status;
+}
+
+uint8_t AppSched_reentrantTask( AppSched_Scheduler *scheduler, uint32_t task, uint8_t reentrant )
+{
+    uint8_t reentrant_task_status;
+    AppSched_Task *reentrantTask = AppSched_getTask(scheduler, task);
+
+    if (reentrantTask != NULL)
+    {
+        reentrantTask->reentrant = reentrant;
+        reentrant_task_status = TRUE;
+    }
+    else
+    {
+        reentrant_task_status = FALSE;
+    }
+
+    return reentrant_task_status;
+}
+
+uint8_t AppSched_overrunTask( AppSched_Scheduler *scheduler, uint32_t task, uint8_t overrun )
 {
-    return clock() / (CLOCKS_PER_SEC / 1000);
+    uint8_t overrun_task_status;
+    AppSched_Task *overrunTask = AppSched_getTask(scheduler, task);
+
+    if ((overrunTask != NULL) && (overrun <= OVERRUN_REALIGN))
+    {
+        overrunTask->overrun = overrun;
+        overrun_task_status = TRUE;
+    }
+    else
+    {
+        overrun_task_status = FALSE;
+    }
+
+    return overrun_task_status;
+}
+
+uint64_t nanoseconds( void )
+{
+    return AppTime_monotonic.now(&AppTime_monotonic);
 }
 
 void AppSched_startScheduler( AppSched_Scheduler *scheduler )
 {
-    /* Get the milliseconds for the first time */
-    uint32_t tickstart = milliseconds();
-    uint32_t elapsed = 0; /* Counter of ticks */
-    uint32_t new_elapsed = 0; /* Counter of ticks */
+    if (scheduler->timeSource == NULL)
+    {
+        scheduler->timeSource = &AppTime_monotonic;
+    }
+
+    /* Get the time for the first time, every deadline is relative to it */
+    scheduler->start = scheduler->timeSource->now(scheduler->timeSource);
+    scheduler->now = 0;
+
+    if (scheduler->retiredTask != TASK_NONE)
+    {
+        AppSched_compactTasks(scheduler);
+    }
+
+    /* Dependencies added since the registration take the tasks out of the periodic scans */
+    for (uint32_t y = 0; y < scheduler->activeCount; y++)
+    {
+        AppSched_syncTask(scheduler, scheduler->activePtr[y]);
+    }
 
     /* Running the task init functions one single time */
-    for (uint8_t y = 0; y < scheduler->tasks; y++)
+    for (uint32_t y = 0; y < scheduler->activeCount; y++)
     {
-        if ((scheduler->taskPtr[y].initFunc != NULL) && (scheduler->taskPtr[y].startFlag == TRUE))
+        if ((scheduler->activePtr[y]->initFunc != NULL) && (scheduler->activePtr[y]->startFlag == TRUE))
         {
-            scheduler->taskPtr[y].initFunc();
+            scheduler->activePtr[y]->initFunc();
         }
         else
         {
@@ -178,41 +395,965 @@ void AppSched_startScheduler( AppSched_Scheduler *scheduler )
         }
     }
 
-    while (new_elapsed <= scheduler->timeout)
-    {   
-        new_elapsed = milliseconds() - tickstart;
+    /* Signals posted before the start found no time source to wake, the first sleep ends at once */
+    if ((scheduler->eventsCount > 0u) && (scheduler->timeSource->wake != NULL))
+    {
+        scheduler->timeSource->wake(scheduler->timeSource);
+    }
+
+    if (scheduler->mode == APPSCHED_MODE_TICKLESS)
+    {
+        AppSched_runTickless(scheduler);
+    }
+    else
+    {
+        AppSched_runTick(scheduler);
+    }
+}
+
+uint8_t AppSched_validPeriod( AppSched_Scheduler *scheduler, uint32_t period )
+{
+    uint8_t valid;
+
+    if (scheduler->mode == APPSCHED_MODE_TICKLESS)
+    {
+        valid = (period > 0u) ? TRUE : FALSE; /* Any period, deadlines are not rounded to a tick */
+    }
+    else
+    {
+        /* Should not be less than the tick value and always be multiple */
+        valid = ((period >= scheduler->tick) && (period % scheduler->tick == 0u)) ? TRUE : FALSE;
+    }
+
+    return valid;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of local functions                      */
+/*----------------------------------------------------------------------------*/
+
+static uint32_t AppSched_addTask( AppSched_Scheduler *scheduler, void (*initPtr)(void), void (*taskPtr)(void), uint32_t period, AppEvt_Event *event, uint8_t batch )
+{
+    uint32_t register_task_status;
+    uint32_t index;
+    AppSched_Task *newTask; /* Declares a pointer to an AppSched_Task structure */
+
+    /* Validate the periodicity, an event task has none */
+    if ((event == NULL) && (AppSched_validPeriod(scheduler, period) == FALSE))
+    {
+        return FALSE; /* Periodicity NOT Validated */
+    }
+
+    index = AppSched_allocTask(scheduler);
+    if (index == TASK_NONE)
+    {
+        return FALSE; /* No space left in the TCB buffer */
+    }
+
+    /* Set the task TCB with the following parameters */
+    newTask = AppSched_slotTask(scheduler, index);
+
+    /* 1. Address of the function to hold the init routine/NULL for the given task */
+    if (initPtr == NULL) /* Evaluate if the task has an init routine */
+    {
+        newTask->initFunc = NULL; /* A NULL parameter should be accepted by the function */
+    }
+    else /* If the task HAS an init routine */
+    {
+        newTask->initFunc = initPtr; /* Address of the function to hold the init routine for the given task */
+    }
+
+    /* 2. Address for the actual routine that will run as the task */
+    newTask->taskFunc = taskPtr;
+
+    /* 3. The periodicity in milliseconds of the task to register */
+    newTask->period = period;
+    newTask->deadline = scheduler->now + (uint64_t)period * NS_PER_MS;
+    newTask->worker = POOL_ANY_WORKER;
+    newTask->reentrant = TRUE;
+    atomic_init(&newTask->busy, FALSE);
+    atomic_init(&newTask->skipped, 0u);
+    newTask->overrun = OVERRUN_CATCH_UP;
+    newTask->missed = 0;
+    newTask->resume = 0;
+    newTask->event = event;
+    newTask->batch = batch;
+    newTask->co = NULL;
+    newTask->stage = NULL;
+    newTask->inputs = 0;
+    atomic_init(&newTask->arrived, 0u);
+    newTask->outputsCount = 0;
+    atomic_init(&newTask->queued, 0u);
+    if (event != NULL)
+    {
+        scheduler->eventsCount++;
+    }
+#if (APPSCHED_PROFILING == TRUE)
+    newTask->critical = NULL;
+    memset(&newTask->stats, 0, sizeof(newTask->stats));
+    atomic_flag_clear(&newTask->statsLock);
+#endif
+    /* The function shall return a Task ID, the slot from 1 on with the generation of the slot on top */
+    register_task_status = ((uint32_t)newTask->generation << TASK_INDEX_BITS) | (index + 1u); /* Operation was a success */
+    newTask->id = register_task_status;
+    newTask->used = TRUE;
+    if (event != NULL)
+    {
+        event->task = register_task_status;
+    }
+    newTask->startFlag = TRUE; /* Start to run task */
+
+    /* The loops only scan the active array, allocTask made room for one more */
+    newTask->activeIndex = scheduler->activeCount;
+    scheduler->activePtr[scheduler->activeCount] = newTask;
+    scheduler->activeCount++;
+    AppSched_syncTask(scheduler, newTask);
+    
+    return register_task_status;
+}
+
+static uint32_t AppSched_allocTask( AppSched_Scheduler *scheduler )
+{
+    uint32_t index = TASK_NONE;
+    uint32_t size = (scheduler->activeSize == 0u) ? 64u : scheduler->activeSize * 2u;
+    AppSched_Task **active;
+    uint64_t *deadline;
+    uint64_t *enable;
+    AppSched_Task *freeTask;
+
+    /* The active arrays only move here, in the thread that scans them. Whole words of 64 tasks,
+       the positions past activeCount stay TASK_NEVER and disabled */
+    if (scheduler->activeCount == scheduler->activeSize)
+    {
+        active = realloc(scheduler->activePtr, (size_t)size * sizeof(AppSched_Task *));
+        if (active != NULL)
+        {
+            scheduler->activePtr = active;
+        }
+        deadline = realloc(scheduler->activeDeadline, (size_t)size * sizeof(uint64_t));
+        if (deadline != NULL)
+        {
+            scheduler->activeDeadline = deadline;
+        }
+        enable = realloc(scheduler->activeEnable, (size_t)ACTIVE_WORD(size) * sizeof(uint64_t));
+        if (enable != NULL)
+        {
+            scheduler->activeEnable = enable;
+        }
+        if ((active == NULL) || (deadline == NULL) || (enable == NULL))
+        {
+            return TASK_NONE;   /* The arrays that moved keep their old size in use */
+        }
+
+        for (uint32_t a = scheduler->activeSize; a < size; a++)
+        {
+            scheduler->activeDeadline[a] = TASK_NEVER;
+        }
+        memset(&scheduler->activeEnable[ACTIVE_WORD(scheduler->activeSize)], 0,
+               (size_t)(ACTIVE_WORD(size) - ACTIVE_WORD(scheduler->activeSize)) * sizeof(uint64_t));
+        scheduler->activeSize = size;
+    }
+
+    if (scheduler->freeTask != TASK_NONE)
+    {
+        /* Reuse the slot of the last unregistered task, it keeps its generation. A slot with a
+           release still in the pool waits, like a busy deferred timer slot */
+        freeTask = AppSched_slotTask(scheduler, scheduler->freeTask);
+        if (atomic_load_explicit(&freeTask->queued, memory_order_acquire) == 0u)
+        {
+            index = scheduler->freeTask;
+            scheduler->freeTask = freeTask->nextFree;
+        }
+    }
+
+    if ((index == TASK_NONE) &&
+        ((scheduler->tasksCount < scheduler->tasks) || (AppSched_growTasks(scheduler) == TRUE)))
+    {
+        index = scheduler->tasksCount;
+        AppSched_slotTask(scheduler, index)->generation = 0u;
+        scheduler->tasksCount++;
+    }
+
+    return index;
+}
+
+static uint8_t AppSched_growTasks( AppSched_Scheduler *scheduler )
+{
+    uint8_t grow_status = FALSE;
+    uint32_t block = TASK_BLOCK(scheduler->tasks);
+    uint32_t size = TASK_GROW_N << block;
+
+    /* A user buffer keeps its size. The blocks do not move, the workers keep reading the tasks
+       of the blocks before while a new one is added */
+    if ((scheduler->tasksOwned == TRUE) && (block < TASK_BLOCKS_N))
+    {
+        scheduler->taskBlock[block] = malloc((size_t)size * sizeof(AppSched_Task));
+        if (scheduler->taskBlock[block] != NULL)
+        {
+            scheduler->tasks += size;
+            grow_status = TRUE;
+        }
+    }
+
+    return grow_status;
+}
+
+static AppSched_Task *AppSched_slotTask( AppSched_Scheduler *scheduler, uint32_t index )
+{
+    uint32_t block;
+
+    if (scheduler->tasksOwned == FALSE)
+    {
+        return &scheduler->taskPtr[index];
+    }
+
+    /* Block n starts at slot TASK_GROW_N * (2^n - 1) */
+    block = TASK_BLOCK(index);
+    return &scheduler->taskBlock[block][index - (((1u << block) - 1u) << TASK_GROW_BITS)];
+}
+
+static void AppSched_compactTasks( AppSched_Scheduler *scheduler )
+{
+    AppSched_Task *oldTask;
+    AppSched_Task *moved;
+    uint32_t index;
+
+    /* Every retired task leaves the active array in O(1), the last one takes its place */
+    while (scheduler->retiredTask != TASK_NONE)
+    {
+        index = scheduler->retiredTask;
+        oldTask = AppSched_slotTask(scheduler, index);
+        scheduler->retiredTask = oldTask->nextFree;
+
+        scheduler->activeCount--;
+        moved = scheduler->activePtr[scheduler->activeCount];
+        scheduler->activePtr[oldTask->activeIndex] = moved;
+        moved->activeIndex = oldTask->activeIndex;
+
+        /* The last position is empty now, the moved task takes its state to the new one */
+        scheduler->activeDeadline[scheduler->activeCount] = TASK_NEVER;
+        scheduler->activeEnable[ACTIVE_WORD(scheduler->activeCount)] &= ~ACTIVE_BIT(scheduler->activeCount);
+        if (moved != oldTask)
+        {
+            AppSched_syncTask(scheduler, moved);
+        }
+
+        oldTask->nextFree = scheduler->freeTask;
+        scheduler->freeTask = index;
+    }
+}
+
+static void AppSched_syncTask( AppSched_Scheduler *scheduler, AppSched_Task *task )
+{
+    uint32_t a = task->activeIndex;
 
-        if (new_elapsed - elapsed >= scheduler->tick)
+    /* Only the tasks released by their period are in the scans, the others cost nothing there */
+    if ((task->used == TRUE) && (task->startFlag == TRUE) && (task->event == NULL) && (task->inputs == 0u))
+    {
+        scheduler->activeDeadline[a] = task->deadline;
+        scheduler->activeEnable[ACTIVE_WORD(a)] |= ACTIVE_BIT(a);
+    }
+    else
+    {
+        scheduler->activeDeadline[a] = TASK_NEVER;
+        scheduler->activeEnable[ACTIVE_WORD(a)] &= ~ACTIVE_BIT(a);
+    }
+}
+
+static void AppSched_runTick( AppSched_Scheduler *scheduler )
+{
+    AppTime_Source *source = scheduler->timeSource;
+    uint64_t tick = (uint64_t)scheduler->tick * NS_PER_MS;
+    uint64_t end = (uint64_t)scheduler->timeout * NS_PER_MS;
+    uint64_t woke;
+
+    /* The last tick is the one that reaches the timeout */
+    for (uint64_t next = tick; next <= end; next += tick)
+    {
+        /* Tasks unregistered during the last tick leave the active array before the scans */
+        if (scheduler->retiredTask != TASK_NONE)
         {
-            scheduler->tickCount++;
-            elapsed += scheduler->tick;
+            AppSched_compactTasks(scheduler);
+        }
 
-            for (uint8_t a = 0; a < scheduler->tasks; a++)
+        /* High resolution timers due before the tick run in between */
+        if (scheduler->hres != NULL)
+        {
+            AppSched_runHres(scheduler, next);
+        }
+
+        /* A late loop does not sleep, it processes the pending ticks back to back.
+           A wake for a timer command does not end the tick early */
+        do
+        {
+            source->sleepUntil(source, scheduler->start + next);
+            woke = source->now(source);
+
+            /* A signaled event ends the sleep early, its tasks do not wait for the tick */
+            if (scheduler->eventsCount > 0u)
             {
-                if ((scheduler->tickCount % ((scheduler->taskPtr[a].period) / (scheduler->tick)) == 0) && (scheduler->taskPtr[a].startFlag == TRUE))
+                AppSched_runEvents(scheduler);
+            }
+        } while (woke < (scheduler->start + next));
+
+        scheduler->tickCount++;
+        scheduler->wakeups++;
+        TRACE_EVENT(TRACE_TICK, 0u, scheduler->tickCount);
+        scheduler->now = next;
+
+        if (scheduler->service != NULL)
+        {
+            AppSched_applyCommands(scheduler);
+        }
+
+        if (scheduler->inbox != NULL)
+        {
+            AppGrp_drain(scheduler);
+        }
+
+        /* Only the enabled periodic tasks are visited, in the order of activePtr */
+        for (uint32_t w = 0; (w << 6u) < scheduler->activeCount; w++)
+        {
+            uint64_t enabled = scheduler->activeEnable[w];
+
+            while (enabled != 0u)
+            {
+                AppSched_Task *task = scheduler->activePtr[(w << 6u) + (uint32_t)__builtin_ctzll(enabled)];
+
+                enabled &= enabled - 1u;
+                /* A task run inline may have stopped the ones after it */
+                if ((task->startFlag == TRUE) && (scheduler->tickCount % ((task->period) / (scheduler->tick)) == 0) &&
+                    (AppSched_admitTask(scheduler, task, woke - (scheduler->start + next)) == TRUE))
                 {
-                    scheduler->taskPtr[a].taskFunc();
+#if (APPSCHED_PROFILING == TRUE)
+                    task->release = scheduler->now;
+#endif
+                    AppSched_dispatchTask(scheduler, task);
                 }
             }
-            
-            for (uint8_t b = 0; b < scheduler -> timers; b++)
+        }
+
+        if (scheduler->pool != NULL)
+        {
+            AppPool_signal(scheduler->pool); /* Wake the workers once per tick */
+        }
+
+        if (scheduler -> wheel != NULL)
+        {
+            /* Only the timers expiring on this tick are touched */
+            AppWheel_advance(scheduler -> wheel, &scheduler -> timerPtr, AppSched_expireTimer, scheduler);
+        }
+        else
+        {
+            for (uint32_t b = 0; b < scheduler -> timersCount; b++)
             {
-                
+                uint64_t due;
+
+                /* Stopped and destroyed timers do not count */
+                if (scheduler -> timerPtr[b].startFlag == FALSE)
+                {
+                    continue;
+                }
+
                 scheduler -> timerPtr[b].count++; /* Store each tick*/
-                
+
                 /* Timer shall count from a timeout value down to zero*/
-                if(((AppSched_getTimer(scheduler,b)) == 0) && (scheduler -> timerPtr[b].startFlag == TRUE))
+                if ((scheduler -> timerPtr[b].count * scheduler -> tick) >= scheduler -> timerPtr[b].timeout)
                 {
-                    /* Reset count to start again*/
+                    /* Reset count to start again, a one-shot timer stops here */
                     scheduler -> timerPtr[b].count = 0;
+                    due = scheduler -> timerPtr[b].due;
+                    if (scheduler -> timerPtr[b].mode == TIMER_MODE_ONE_SHOT)
+                    {
+                        scheduler -> timerPtr[b].startFlag = FALSE;
+                        AppSched_syncTimer(scheduler, b);
+                    }
+                    else
+                    {
+                        /* Counting starts again from this tick */
+                        scheduler -> timerPtr[b].due = scheduler -> now + (uint64_t)scheduler -> timerPtr[b].timeout * NS_PER_MS;
+                    }
                     /* Callback function*/
-                    scheduler -> timerPtr[b].callbackPtr();
+                    AppSched_fireTimer(scheduler, b, due);
+                }
+            }
+        }
+
+        /* Events signaled by the timer callbacks run in the same wakeup */
+        if (scheduler->eventsCount > 0u)
+        {
+            AppSched_runEvents(scheduler);
+        }
+
+        if ((scheduler->service != NULL) && (scheduler->service->deferred == TRUE) && (scheduler->pool != NULL))
+        {
+            AppPool_signal(scheduler->pool); /* Deferred timer callbacks */
+        }
+    }
+}
+
+static void AppSched_runTickless( AppSched_Scheduler *scheduler )
+{
+    AppTime_Source *source = scheduler->timeSource;
+    uint64_t end = (uint64_t)scheduler->timeout * NS_PER_MS;
+    uint64_t next;
+
+    for (;;)
+    {
+        /* Commands posted meanwhile change the deadlines before they are evaluated */
+        if (scheduler->service != NULL)
+        {
+            AppSched_applyCommands(scheduler);
+        }
+
+        /* Posts from the other instances of a group, a task may arrive or leave */
+        if (scheduler->inbox != NULL)
+        {
+            AppGrp_drain(scheduler);
+        }
+
+        /* Tasks unregistered during the last wakeup leave the active array before the scans */
+        if (scheduler->retiredTask != TASK_NONE)
+        {
+            AppSched_compactTasks(scheduler);
+        }
+
+        /* The next wakeup is the earliest deadline of any running task or timer */
+        next = end + 1u;
+        for (uint32_t a = 0; a < scheduler->activeCount; a++)
+        {
+            next = (scheduler->activeDeadline[a] < next) ? scheduler->activeDeadline[a] : next;
+        }
+        for (uint32_t b = 0; b < scheduler->timersCount; b++)
+        {
+            next = (scheduler->timerDeadline[b] < next) ? scheduler->timerDeadline[b] : next;
+        }
+        if ((scheduler->hres != NULL) && (AppHres_nextDeadline(scheduler->hres) < next))
+        {
+            next = AppHres_nextDeadline(scheduler->hres);
+        }
+
+        if (next > end)
+        {
+            /* Nothing else is due before the scheduler timeout, a command can still start a timer,
+               an event can still release a task, another instance can still post and a watched
+               file descriptor can still become ready */
+            if (((scheduler->service == NULL) && (scheduler->eventsCount == 0u) && (scheduler->inbox == NULL) &&
+                 (scheduler->reactor == NULL)) ||
+                (scheduler->now >= end))
+            {
+                break;
+            }
+            next = end;
+        }
+
+        if (next > scheduler->now)
+        {
+            source->sleepUntil(source, scheduler->start + next);
+        }
+        scheduler->now = source->now(source) - scheduler->start;
+        scheduler->wakeups++;
+        scheduler->dueCount = 0;
+        TRACE_EVENT(TRACE_TICK, 0u, scheduler->wakeups);
+
+        /* The precise timers first, the rest can tolerate the delay */
+        if (scheduler->hres != NULL)
+        {
+            AppHres_expire(scheduler);
+        }
+
+        /* Only the enabled tasks are compared, a word of disabled tasks costs one load. The
+           deadline is read again for every task, one run inline may have stopped another */
+        for (uint32_t w = 0; (w << 6u) < scheduler->activeCount; w++)
+        {
+            uint64_t enabled = scheduler->activeEnable[w];
+
+            while (enabled != 0u)
+            {
+                uint32_t a = (w << 6u) + (uint32_t)__builtin_ctzll(enabled);
+
+                enabled &= enabled - 1u;
+                if (scheduler->activeDeadline[a] <= scheduler->now)
+                {
+                    AppSched_Task *task = scheduler->activePtr[a];
+
+#if (APPSCHED_PROFILING == TRUE)
+                    task->release = task->deadline;
+#endif
+                    AppSched_advanceTask(scheduler, task);
+                    AppSched_dispatchTask(scheduler, task);
+                }
+            }
+        }
+
+        if (scheduler->pool != NULL)
+        {
+            AppPool_signal(scheduler->pool);
+        }
+
+        for (uint32_t b = 0; b < scheduler->timersCount; b++)
+        {
+            /* Only an expired timer is read, a callback may move both arrays */
+            if (scheduler->timerDeadline[b] <= scheduler->now)
+            {
+                AppSched_Timer *timer = &scheduler->timerPtr[b];
+                uint64_t due = timer->due;
+
+                AppSched_accountSlack(scheduler, timer->deadline, timer->due);
+
+                if (timer->mode == TIMER_MODE_ONE_SHOT)
+                {
+                    timer->startFlag = FALSE;
+                }
+                else
+                {
+                    /* The next expiration keeps the phase of the timeout, not of the slack */
+                    timer->due += (uint64_t)timer->timeout * NS_PER_MS;
+                    timer->deadline = AppSched_coalesce(timer->due, (uint64_t)timer->slack * NS_PER_MS);
+                }
+                AppSched_syncTimer(scheduler, b);
+                AppSched_fireTimer(scheduler, b, due);
+            }
+        }
+
+        /* Events signaled by the timer callbacks run in the same wakeup */
+        if (scheduler->eventsCount > 0u)
+        {
+            AppSched_runEvents(scheduler);
+        }
+
+        if ((scheduler->service != NULL) && (scheduler->service->deferred == TRUE) && (scheduler->pool != NULL))
+        {
+            AppPool_signal(scheduler->pool); /* Deferred timer callbacks */
+        }
+    }
+}
+
+static void AppSched_runEvents( AppSched_Scheduler *scheduler )
+{
+    AppSched_Task *task;
+    AppEvt_Event *wait;
+    uint32_t pending;
+    uint32_t taken;
+    uint32_t dispatched = 0;
 
+    for (uint32_t a = 0; a < scheduler->activeCount; a++)
+    {
+        task = scheduler->activePtr[a];
+        if (task->co != NULL)
+        {
+            /* A coroutine waiting for an event is resumed once per wakeup while it is signaled */
+            wait = atomic_load_explicit(&task->co->wait, memory_order_acquire);
+            if ((wait != NULL) && (task->startFlag == TRUE) &&
+                ((scheduler->pool == NULL) || (atomic_load(&task->busy) == FALSE)) &&
+                (atomic_load_explicit(&wait->pending, memory_order_acquire) > 0u))
+            {
+                if (wait->queue != NULL)
+                {
+                    atomic_store_explicit(&wait->pending, 0u, memory_order_relaxed); /* The body reads every message */
                 }
+#if (APPSCHED_PROFILING == TRUE)
+                task->release = scheduler->timeSource->now(scheduler->timeSource) - scheduler->start;
+#endif
+                AppSched_dispatchTask(scheduler, task);
+                dispatched++;
+            }
+            continue;
+        }
+        if ((task->event == NULL) || (task->startFlag == FALSE))
+        {
+            continue;   /* A stopped event task keeps its signals until it is started again */
+        }
+        if ((task->stage != NULL) && (atomic_load_explicit(&task->stage->suspended, memory_order_acquire) == TRUE))
+        {
+            continue;   /* So does a stage waiting for room, the next stage resumes it */
+        }
 
+        pending = atomic_load_explicit(&task->event->pending, memory_order_acquire);
+        while (pending > 0u)
+        {
+            /* A non reentrant task still running keeps the rest, the worker wakes the loop when done */
+            if ((scheduler->pool != NULL) && (task->reentrant == FALSE) && (atomic_load(&task->busy) == TRUE))
+            {
+                break;
             }
 
+            taken = (task->batch == TRUE) ? pending : 1u;
+            atomic_fetch_sub_explicit(&task->event->pending, taken, memory_order_relaxed);
+            pending -= taken;
+#if (APPSCHED_PROFILING == TRUE)
+            task->release = scheduler->timeSource->now(scheduler->timeSource) - scheduler->start;
+#endif
+            AppSched_dispatchTask(scheduler, task);
+            dispatched++;
+        }
+    }
+
+    if ((dispatched > 0u) && (scheduler->pool != NULL))
+    {
+        AppPool_signal(scheduler->pool);
+    }
+}
+
+static uint8_t AppSched_admitTask( AppSched_Scheduler *scheduler, AppSched_Task *task, uint64_t late )
+{
+    uint64_t period = (uint64_t)task->period * NS_PER_MS;
+    uint8_t admit = TRUE;
+
+    /* Tick mode, the ticks of a late loop are processed back to back */
+    if (late >= period)
+    {
+        /* The next release of the task is already due */
+        scheduler->overloaded++;
+        if (task->overrun == OVERRUN_SKIP)
+        {
+            admit = FALSE;      /* The latest pending release runs instead */
+        }
+    }
+
+    if ((task->overrun == OVERRUN_REALIGN) && (scheduler->now < task->resume))
+    {
+        admit = FALSE;          /* Still inside the period that follows the late run */
+    }
+
+    if (admit == FALSE)
+    {
+        task->missed++;
+    }
+    else if ((task->overrun == OVERRUN_REALIGN) && (late >= period))
+    {
+        task->resume = scheduler->now + late + period;
+    }
+
+    return admit;
+}
+
+static void AppSched_advanceTask( AppSched_Scheduler *scheduler, AppSched_Task *task )
+{
+    uint64_t period = (uint64_t)task->period * NS_PER_MS;
+    uint64_t behind = (scheduler->now - task->deadline) / period;   /* Releases also due already */
+
+    /* Tickless mode, a release a full period late is handled by the overrun policy.
+       Caught up releases are counted one by one as they come */
+    if (behind > 0u)
+    {
+        scheduler->overloaded += (task->overrun == OVERRUN_CATCH_UP) ? 1u : (uint32_t)behind;
+    }
+
+    if ((behind > 0u) && (task->overrun == OVERRUN_SKIP))
+    {
+        task->missed += (uint32_t)behind;
+        task->deadline += (behind + 1u) * period;   /* Next release keeps the phase */
+    }
+    else if ((behind > 0u) && (task->overrun == OVERRUN_REALIGN))
+    {
+        task->missed += (uint32_t)behind;
+        task->deadline = scheduler->now + period;   /* Next release is a full period from now */
+    }
+    else
+    {
+        task->deadline += period;                   /* Next release keeps the phase */
+    }
+    scheduler->activeDeadline[task->activeIndex] = task->deadline;
+}
+
+static void AppSched_dispatchTask( AppSched_Scheduler *scheduler, AppSched_Task *task )
+{
+    uint64_t job = ((uint64_t)JOB_TASK << JOB_KIND_SHIFT) | TASK_SLOT(task->id);
+
+    if (scheduler->pool == NULL)
+    {
+        AppSched_execTask(scheduler, task);
+        if (task->outputsCount > 0u)
+        {
+            AppSched_releaseOutputs(scheduler, task, task);   /* The graph runs in order in this thread */
+        }
+    }
+    else
+    {
+        /* A non reentrant task keeps busy set from here until a worker finishes it */
+        if ((task->reentrant == FALSE) && (atomic_exchange(&task->busy, TRUE) == TRUE))
+        {
+            atomic_fetch_add_explicit(&task->skipped, 1u, memory_order_relaxed);
+            return;
+        }
+
+        /* The slot is not reused while a release is in the pool */
+        atomic_fetch_add_explicit(&task->queued, 1u, memory_order_relaxed);
+        if (AppPool_submit(scheduler->pool, job, task->worker) == FALSE)
+        {
+            TRACE_EVENT(TRACE_QUEUE_FULL, task->id, TRACE_QUEUE_POOL);
+            AppSched_runJob(scheduler, job);   /* Inbox full, do not lose the release */
+        }
+    }
+
+    scheduler->dispatches++;
+}
+
+static void AppSched_runJob( void *owner, uint64_t job )
+{
+    AppSched_Scheduler *scheduler = (AppSched_Scheduler *)owner;
+    AppSched_Task *task;
+    AppEvt_Event *wait;
+
+    if ((job >> JOB_KIND_SHIFT) == JOB_TIMER)
+    {
+        AppSvc_runDeferred(scheduler->service, (uint32_t)job);
+    }
+    else
+    {
+        task = AppSched_slotTask(scheduler, (uint32_t)job);
+        AppSched_execTask(scheduler, task);
+        atomic_store(&task->busy, FALSE);
+
+        if (task->outputsCount > 0u)
+        {
+            AppSched_releaseOutputs(scheduler, task, task);
+        }
+
+        /* Signals left while the task was busy are dispatched on the next wakeup */
+        if ((task->event != NULL) && (task->reentrant == FALSE) && (scheduler->timeSource->wake != NULL) &&
+            (atomic_load_explicit(&task->event->pending, memory_order_acquire) > 0u))
+        {
+            scheduler->timeSource->wake(scheduler->timeSource);
+        }
+        else if ((task->co != NULL) && (scheduler->timeSource->wake != NULL))
+        {
+            /* So are the signals a waiting coroutine got during its slice */
+            wait = atomic_load_explicit(&task->co->wait, memory_order_acquire);
+            if ((wait != NULL) && (atomic_load_explicit(&wait->pending, memory_order_acquire) > 0u))
+            {
+                scheduler->timeSource->wake(scheduler->timeSource);
+            }
+        }
+
+        atomic_fetch_sub_explicit(&task->queued, 1u, memory_order_release);  /* Last access to the slot */
+    }
+}
+
+static void AppSched_releaseOutputs( AppSched_Scheduler *scheduler, AppSched_Task *task, AppSched_Task *done )
+{
+    AppSched_Task *output;
+    uint32_t all;
+    uint32_t arrived;
+    uint32_t next;
+    uint64_t job;
+
+    for (uint8_t o = 0; o < task->outputsCount; o++)
+    {
+        output = task->outputs[o];
+        all = (output->inputs >= DAG_INPUTS_N) ? 0xFFFFFFFFu : ((1u << output->inputs) - 1u);
+
+        /* Every input sets its own bit, the one that completes the cycle releases the task and
+           clears the bits in the same compare-and-swap. An input that finishes again before
+           the others counts once, so the task never runs without one of its inputs */
+        arrived = atomic_load_explicit(&output->arrived, memory_order_acquire);
+        do
+        {
+            next = arrived | (1u << task->outputBit[o]);
+            if (next == arrived)
+            {
+                break;      /* Already finished in this cycle */
+            }
+            next = (next == all) ? 0u : next;
+        } while (!atomic_compare_exchange_weak_explicit(&output->arrived, &arrived, next,
+                                                        memory_order_acq_rel, memory_order_acquire));
+        if (next != 0u)
+        {
+            continue;
+        }
+
+        /* A stopped or still running task passes the cycle on, the tasks after it run with its last results */
+        if (output->startFlag == FALSE)
+        {
+            AppSched_releaseOutputs(scheduler, output, done);
+            continue;
+        }
+        if (atomic_exchange(&output->busy, TRUE) == TRUE)
+        {
+            atomic_fetch_add_explicit(&output->skipped, 1u, memory_order_relaxed);
+            AppSched_releaseOutputs(scheduler, output, done);
+            continue;
+        }
+
+#if (APPSCHED_PROFILING == TRUE)
+        output->release = done->end;
+        output->origin = done->origin;
+        output->critical = task;
+#else
+        (void)done;
+#endif
+
+        /* A worker keeps the task on its own deque, the idle workers steal the independent ones */
+        job = ((uint64_t)JOB_TASK << JOB_KIND_SHIFT) | TASK_SLOT(output->id);
+        atomic_fetch_add_explicit(&output->queued, 1u, memory_order_relaxed);
+        if ((scheduler->pool == NULL) || (AppPool_spawn(scheduler->pool, job) == FALSE))
+        {
+            AppSched_runJob(scheduler, job);
+        }
+    }
+}
+
+static void AppSched_expireTimer( void *ctx, uint32_t index )
+{
+    AppSched_Scheduler *scheduler = (AppSched_Scheduler *)ctx;
+    AppSched_Timer *timer = &scheduler -> timerPtr[index];
+    uint64_t due = timer -> due;
+
+    /* Auto-reload timers go back into the wheel before the callback, like in the tick scan */
+    if (timer -> mode == TIMER_MODE_ONE_SHOT)
+    {
+        timer -> startFlag = FALSE;
+        AppSched_syncTimer(scheduler, index);
+    }
+    else
+    {
+        AppWheel_insert(scheduler -> wheel, scheduler -> timerPtr, index, timer -> timeout / scheduler -> tick);
+        timer -> due = scheduler -> now + (uint64_t)timer -> timeout * NS_PER_MS;
+    }
+    AppSched_fireTimer(scheduler, index, due);
+}
+
+static void AppSched_fireTimer( AppSched_Scheduler *scheduler, uint32_t index, uint64_t due )
+{
+    AppSched_Timer *timer = &scheduler -> timerPtr[index];
+    AppSvc_Service *service = scheduler -> service;
+    uint8_t deferred = FALSE;
+    uint32_t slot;
+#if (APPSCHED_PROFILING == TRUE)
+    AppTime_Source *source = scheduler -> timeSource;
+    uint64_t timeout = (uint64_t)timer -> timeout * NS_PER_MS;   /* The callback may move the table */
+    uint64_t begin = source -> now(source);
+#endif
+
+    TRACE_EVENT(TRACE_TIMER_FIRE, index + 1u, 0u);
+
+    if ((service != NULL) && (service -> deferred == TRUE) && (scheduler -> pool != NULL))
+    {
+        /* The pool gets a copy of the callback, a full pool runs it here instead */
+        slot = AppSvc_defer(service, timer);
+        if (slot != SVC_DEFER_N)
+        {
+            deferred = AppPool_submit(scheduler -> pool, ((uint64_t)JOB_TIMER << JOB_KIND_SHIFT) | slot, POOL_ANY_WORKER);
+            if (deferred == FALSE)
+            {
+                AppSvc_cancel(service, slot);
+            }
+        }
+    }
+
+    if (deferred == FALSE)
+    {
+        if (timer -> ctxCallbackPtr != NULL)
+        {
+            timer -> ctxCallbackPtr(timer -> ctx);
+        }
+        else
+        {
+            timer -> callbackPtr();
+        }
+    }
+    scheduler -> dispatches++;
+
+#if (APPSCHED_PROFILING == TRUE)
+    /* A callback handed to the pool does not hold the scheduler thread */
+    AppSched_profileTimer(scheduler, &scheduler -> timerStats, due, timeout, begin, (deferred == TRUE) ? begin : source -> now(source));
+#else
+    (void)due;
+#endif
+}
+
+static void AppSched_applyCommands( AppSched_Scheduler *scheduler )
+{
+    AppSvc_Service *service = scheduler -> service;
+    AppSvc_Command command;
+    uint8_t apply_status;
+
+    while (AppSvc_take(service, &command) == TRUE)
+    {
+        switch (command.type)
+        {
+            case SVC_CMD_START:
+                apply_status = AppSched_startTimer(scheduler, command.timer);
+                break;
+            case SVC_CMD_STOP:
+                apply_status = AppSched_stopTimer(scheduler, command.timer);
+                break;
+            case SVC_CMD_RELOAD:
+                apply_status = AppSched_reloadTimer(scheduler, command.timer, command.timeout);
+                break;
+            case SVC_CMD_DESTROY:
+                apply_status = AppSched_destroyTimer(scheduler, command.timer);
+                break;
+            default:
+                apply_status = FALSE;
+                break;
+        }
+
+        if (apply_status == TRUE)
+        {
+            service -> applied++;
+        }
+        else
+        {
+            service -> rejected++;  /* Stale handle, the timer was destroyed before the command */
+        }
+    }
+}
+
+static void AppSched_execTask( AppSched_Scheduler *scheduler, AppSched_Task *task )
+{
+#if (APPSCHED_TRACE == TRUE)
+    uint32_t id = task->id;
+#endif
+#if (APPSCHED_PROFILING == TRUE)
+    AppTime_Source *source = scheduler->timeSource;   /* Same clock as the releases */
+    uint64_t begin = source->now(source);
+#endif
+
+    TRACE_EVENT(TRACE_TASK_START, id, 0u);
+    if (task->co != NULL)
+    {
+        AppCo_resume(task->co);     /* One slice of a coroutine task */
+    }
+    else if (task->stage != NULL)
+    {
+        AppPipe_runStage(task->stage);  /* One batch of a pipeline stage */
+    }
+    else
+    {
+        task->taskFunc();
+    }
+    TRACE_EVENT(TRACE_TASK_END, id, 0u);
+
+#if (APPSCHED_PROFILING == TRUE)
+    AppSched_profileTask(scheduler, task, begin, source->now(source));
+#else
+    (void)scheduler;
+#endif
+}
+
+static void AppSched_runHres( AppSched_Scheduler *scheduler, uint64_t limit )
+{
+    AppTime_Source *source = scheduler->timeSource;
+    uint64_t deadline;
+
+    for (;;)
+    {
+        deadline = AppHres_nextDeadline(scheduler->hres);
+        if (deadline > limit)
+        {
+            break;  /* Only the timers due up to the tick run before it */
+        }
+
+        if (deadline > scheduler->now)
+        {
+            source->sleepUntil(source, scheduler->start + deadline);
         }
+        scheduler->now = source->now(source) - scheduler->start;
+        scheduler->wakeups++;
+        scheduler->dueCount = 0;
+        AppHres_expire(scheduler);
     }
 }
 
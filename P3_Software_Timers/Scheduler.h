@@ -13,15 +13,43 @@
 /*                                  Includes                                  */
 /*----------------------------------------------------------------------------*/
 #include <stdint.h>
+#include <stdatomic.h>
+#include "Time_Source.h"
 
 /*----------------------------------------------------------------------------*/
 /*                             Defines and macros                             */
 /*----------------------------------------------------------------------------*/
 #define FALSE                0u         /*!< Boolean false value */
 #define TRUE                 1u         /*!< Boolean true value */
-#define TASKS_N              1u         /*!< Number of tasks */
+#define TASKS_N              3u         /*!< Number of tasks of the task buffer of Main */
 #define TICK_VAL             100u       /*!< Tick value in milliseconds */
 #define TIME_OUT             10000u     /*!< Timeout value in milliseconds */
+#define NS_PER_MS            1000000ull /*!< Nanoseconds in one millisecond */
+
+#ifndef APPSCHED_PROFILING
+#define APPSCHED_PROFILING   FALSE      /*!< TRUE to measure the execution time and jitter of every task */
+#endif
+#define PROF_BUCKETS_N       32u        /*!< Log2 buckets of the execution time histogram, 1 ns to 2 s */
+
+#define APPSCHED_MODE_TICK      0u      /*!< Tasks and timers are evaluated on every tick */
+#define APPSCHED_MODE_TICKLESS  1u      /*!< The loop sleeps until the earliest task or timer deadline */
+#define SLACK_SEEN_N            16u     /*!< Distinct expiration times tracked per wakeup for wakeupsSaved */
+
+#define OVERRUN_CATCH_UP        0u      /*!< A late loop runs every pending release of the task back to back */
+#define OVERRUN_SKIP            1u      /*!< Only the latest pending release runs, the phase is kept */
+#define OVERRUN_REALIGN         2u      /*!< The first late release runs, the next one is a full period later */
+
+#define DAG_OUTPUTS_N           8u      /*!< Tasks that can depend on the same task */
+#define DAG_INPUTS_N            32u     /*!< Tasks the same task can depend on, one bit each */
+
+#define TASK_INDEX_BITS         22u     /*!< Handle bits for the slot, the rest hold the generation */
+#define TASK_INDEX_MASK         ((1u << TASK_INDEX_BITS) - 1u)
+#define TASK_GEN_MASK           ((1u << (32u - TASK_INDEX_BITS)) - 1u)
+#define TASK_GROW_BITS          4u
+#define TASK_GROW_N             (1u << TASK_GROW_BITS)  /*!< Tasks in the first block of a table allocated by the scheduler */
+#define TASK_BLOCKS_N           18u     /*!< Blocks of such a table, block n holds TASK_GROW_N << n tasks */
+#define TASK_NONE               0xFFFFFFFFu /*!< End of the free and retired slot lists */
+#define TASK_NEVER              0xFFFFFFFFFFFFFFFFull /*!< activeDeadline of a task the period does not release */
 
 /*----------------------------------------------------------------------------*/
 /*                                 Data types                                 */
@@ -33,6 +61,50 @@ is a type that will be defined later, allowing you to use pointers to
 AppSched_Timer in Scheduler.h without needing the full definition of AppSched_Timer at that point. */
 struct _AppSched_Timer;
 typedef struct _AppSched_Timer AppSched_Timer;
+struct _AppPool_Pool;
+struct _AppSched_Wheel;
+struct _AppSvc_Service;
+struct _AppHres_Heap;
+struct _AppEvt_Event;
+struct _AppCo_Thread;
+struct _AppPipe_Stage;
+struct _AppGrp_Inbox;
+struct _AppRct_Reactor;
+
+#if (APPSCHED_PROFILING == TRUE)
+/**
+ * @brief Structure with the runtime statistics of a task, all the times in nanoseconds.
+ */
+typedef struct _AppSched_TaskStats
+{
+    uint32_t calls;                     /*!< Number of times the task function ran */
+    uint32_t overruns;                  /*!< Runs that finished after the next release of the task */
+    uint64_t minTime;                   /*!< Shortest execution time */
+    uint64_t maxTime;                   /*!< Longest execution time */
+    uint64_t totalTime;                 /*!< Sum of the execution times, for the average */
+    uint64_t maxJitter;                 /*!< Largest delay between the ideal release and the actual start */
+    uint64_t totalJitter;               /*!< Sum of the release delays, for the average */
+    uint32_t histogram[PROF_BUCKETS_N]; /*!< Bucket n counts execution times from 2^n to 2^(n+1) - 1 */
+    uint32_t cycles;                    /*!< Runs that ended a task graph, only for its last tasks */
+    uint64_t lastCycle;                 /*!< Time from the release of the first task to the end of this one */
+    uint64_t maxCycle;                  /*!< Longest of those times */
+    uint64_t totalCycle;                /*!< Sum of those times, for the average */
+} AppSched_TaskStats;
+
+/**
+ * @brief Structure with the expiry statistics of a group of timers, all the times in nanoseconds.
+ */
+typedef struct _AppSched_TimerStats
+{
+    uint32_t expirations;               /*!< Number of timer callbacks run or handed to the pool */
+    uint32_t missed;                    /*!< Expirations a full timeout late, the loop fell behind */
+    uint64_t maxLate;                   /*!< Largest delay between the intended and the actual expiry */
+    uint64_t totalLate;                 /*!< Sum of the expiry delays, for the average */
+    uint64_t maxCallback;               /*!< Longest callback run in the scheduler thread */
+    uint64_t totalCallback;             /*!< Sum of the callback times, for the average */
+    uint32_t histogram[PROF_BUCKETS_N]; /*!< Bucket n counts expiry delays from 2^n to 2^(n+1) - 1 */
+} AppSched_TimerStats;
+#endif
 
 /**
  * @brief Structure to represent a task.
@@ -44,6 +116,38 @@ typedef struct _task
     uint8_t startFlag;                  /*!< Flag to run task */
     void (*initFunc)(void);             /*!< Pointer to init task function */
     void (*taskFunc)(void);             /*!< Pointer to task function */
+    uint64_t deadline;                  /*!< Next release in ns since the scheduler started (tickless mode) */
+    uint8_t worker;                     /*!< Worker the task is pinned to, POOL_ANY_WORKER if it can run anywhere */
+    uint8_t reentrant;                  /*!< FALSE if a release has to be skipped while the previous one still runs */
+    atomic_uchar busy;                  /*!< Set while a non reentrant task is queued or running in the pool */
+    _Atomic uint32_t skipped;           /*!< Releases skipped because the previous one was still running */
+    uint8_t overrun;                    /*!< OVERRUN_CATCH_UP, OVERRUN_SKIP or OVERRUN_REALIGN */
+    uint32_t missed;                    /*!< Releases dropped by the overrun policy */
+    uint64_t resume;                    /*!< Tick mode, releases before it are dropped after a realign */
+    struct _AppEvt_Event *event;        /*!< Event that releases the task instead of a period, NULL if periodic */
+    uint8_t batch;                      /*!< TRUE runs the task once for all the pending signals of its event */
+    struct _AppCo_Thread *co;           /*!< Coroutine resumed instead of taskFunc, NULL for a plain task */
+    struct _AppPipe_Stage *stage;       /*!< Pipeline stage run instead of taskFunc, NULL for a plain task */
+    uint8_t inputs;                     /*!< Tasks that release this one when they all finished, 0 if none */
+    _Atomic uint32_t arrived;           /*!< One bit per input finished in the current cycle */
+    uint8_t outputsCount;               /*!< Tasks released by this one */
+    struct _task *outputs[DAG_OUTPUTS_N]; /*!< Tasks released by this one */
+    uint8_t outputBit[DAG_OUTPUTS_N];   /*!< Bit of this task in the arrived field of each output */
+    uint32_t id;                        /*!< Handle returned when the task was registered */
+    uint16_t generation;                /*!< Incremented when the task is unregistered */
+    uint8_t used;                       /*!< FALSE once the task is unregistered */
+    uint32_t nextFree;                  /*!< Next slot of the free or retired list, TASK_NONE for the last one */
+    uint32_t activeIndex;               /*!< Position in the active array of the scheduler */
+    _Atomic uint32_t queued;            /*!< Releases handed to the pool and not finished yet */
+#if (APPSCHED_PROFILING == TRUE)
+    uint64_t release;                   /*!< Ideal release of the current run in ns since the scheduler started */
+    uint64_t begin;                     /*!< Start of the last run in ns since the scheduler started */
+    uint64_t end;                       /*!< End of the last run in ns since the scheduler started */
+    uint64_t origin;                    /*!< Release of the first task of the graph cycle of the last run */
+    struct _task *critical;             /*!< Input that finished last and released this run */
+    AppSched_TaskStats stats;           /*!< Runtime statistics */
+    atomic_flag statsLock;              /*!< Held while stats are written or copied, a reentrant task can end on two workers at once */
+#endif
 
 } AppSched_Task; 
 
@@ -52,16 +156,51 @@ typedef struct _task
  */
 typedef struct _AppSched_Scheduler
 {
-    uint8_t tasks;                      /*!< Number of task to handle */
+    uint32_t tasks;                     /*!< Number of task to handle, slots of taskPtr or of the allocated blocks */
     uint32_t tick;                      /*!< The time base in ms */
     uint32_t elapsed;                   /*!< The elapsed time since the scheduler started */
-    uint8_t tasksCount;                 /*!< Internal counter for the number of tasks */
-    uint8_t tickCount;                  /*!< Internal counter for ticks */
-    uint8_t timersCount;                /*!< Internal counter for the number of timers */
+    uint32_t tasksCount;                /*!< Internal counter for the task slots in use, free or retired */
+    uint32_t tickCount;                 /*!< Internal counter for ticks */
+    uint32_t eventsCount;               /*!< Tasks released by an event */
+    uint32_t timersCount;               /*!< Internal counter for the timer slots in use or in the free list */
     uint32_t timeout;                   /*!< The number of milliseconds the scheduler should run */
-    AppSched_Task *taskPtr;             /*!< Pointer to the buffer for the task control blocks (TCBs) */
-    uint8_t timers;                     /*!< Number of software timers to use */
-    AppSched_Timer *timerPtr;           /*!< Pointer to buffer timer array */
+    AppSched_Task *taskPtr;             /*!< Pointer to the buffer for the task control blocks (TCBs), NULL lets the scheduler allocate and grow it */
+    AppSched_Task *taskBlock[TASK_BLOCKS_N]; /*!< Blocks allocated by the scheduler, they never move */
+    uint8_t tasksOwned;                 /*!< TRUE if the task blocks were allocated by the scheduler */
+    uint32_t freeTask;                  /*!< First slot of the unregistered tasks ready for reuse, TASK_NONE if empty */
+    uint32_t retiredTask;               /*!< First slot unregistered since the last wakeup, TASK_NONE if empty */
+    AppSched_Task **activePtr;          /*!< Registered tasks packed together, the loops only scan these */
+    uint32_t activeCount;               /*!< Tasks in activePtr */
+    uint32_t activeSize;                /*!< Room in activePtr */
+    uint64_t *activeDeadline;           /*!< Deadline of every task of activePtr, TASK_NEVER if it is not released by its period */
+    uint64_t *activeEnable;             /*!< Bit n set if activePtr[n] is released by its period, 64 tasks per word */
+    uint32_t timers;                    /*!< Number of software timers to use */
+    AppSched_Timer *timerPtr;           /*!< Pointer to buffer timer array, NULL lets the scheduler allocate and grow it */
+    uint32_t freeTimer;                 /*!< First slot of the destroyed timers, TIMER_NONE if empty */
+    uint8_t timersOwned;                /*!< TRUE if the timer table was allocated by the scheduler */
+    uint64_t *timerDeadline;            /*!< Deadline of every timer slot, TIMER_NEVER while stopped, the tickless scans only read this */
+    uint8_t mode;                       /*!< APPSCHED_MODE_TICK or APPSCHED_MODE_TICKLESS */
+    AppTime_Source *timeSource;         /*!< Clock used by the loop, NULL selects AppTime_monotonic */
+    uint64_t start;                     /*!< Time of the time source in ns when the scheduler started */
+    uint64_t now;                       /*!< Time in ns since the scheduler started, updated on every wakeup */
+    uint32_t wakeups;                   /*!< Number of times the loop woke up to dispatch */
+    uint32_t dispatches;                /*!< Number of task and timer callbacks executed */
+    uint32_t overloaded;                /*!< Task releases found a full period late, the loop fell behind */
+    uint32_t coalesced;                 /*!< Expirations moved by their slack */
+    uint64_t slackDelay;                /*!< Total delay in ns added by the slack of those expirations */
+    uint32_t wakeupsSaved;              /*!< Expiration times served by the wakeup of another one */
+    uint8_t dueCount;                   /*!< Expiration times seen in the current wakeup */
+    uint64_t dueSeen[SLACK_SEEN_N];     /*!< Expiration times seen in the current wakeup */
+    struct _AppPool_Pool *pool;         /*!< Worker pool that runs the tasks, NULL to run them in the scheduler thread */
+    struct _AppSched_Wheel *wheel;      /*!< Timer wheel for the timers, NULL to check every timer on every tick */
+    struct _AppSvc_Service *service;    /*!< Timer service for commands from other threads, NULL if not used */
+    struct _AppHres_Heap *hres;         /*!< High resolution timers, NULL if not used */
+    struct _AppGrp_Inbox *inbox;        /*!< Work posted by the other instances of a group, NULL if not used */
+    struct _AppRct_Reactor *reactor;    /*!< Reactor the loop sleeps in to watch file descriptors, NULL if not used */
+#if (APPSCHED_PROFILING == TRUE)
+    AppSched_TimerStats timerStats;     /*!< Expiry statistics of the software timers */
+    AppSched_TimerStats hresStats;      /*!< Expiry statistics of the high resolution timers */
+#endif
 
 } AppSched_Scheduler;
 
@@ -74,7 +213,7 @@ extern AppSched_Scheduler Sche;
 extern AppSched_Task tasks[ TASKS_N ];
 
 /* Tasks IDs as extern*/
-extern uint8_t TaskID1, TaskID2;
+extern uint32_t TaskID1, TaskID2, TaskID3;
 
 /*----------------------------------------------------------------------------*/
 /*                           Declaration of functions                         */
@@ -94,13 +233,66 @@ void AppSched_initScheduler( AppSched_Scheduler *scheduler );
  * 
  * Registers a task with the scheduler.
  * 
+ * With taskPtr set to NULL before AppSched_initScheduler the scheduler allocates the tasks
+ * in blocks that double in size and never move, otherwise the tasks are limited to the
+ * given buffer. Safe from the scheduler thread (timer callbacks, tasks running inline)
+ * or before the scheduler starts.
+ * 
+ * @param scheduler Pointer to the scheduler structure.
+ * @param initPtr Pointer to the task initialization function.
+ * @param taskPtr Pointer to the task function.
+ * @param period The period in milliseconds for the task to run. In tick mode it has to be a
+ *               multiple of the tick, in tickless mode any period larger than zero is accepted.
+ * @return uint32_t Task ID, the slot plus one in the low TASK_INDEX_BITS bits and the generation
+ *                  of the slot in the high bits. FALSE (0) if the period is invalid or there is no space.
+ */
+uint32_t AppSched_registerTask( AppSched_Scheduler *scheduler, void (*initPtr)(void), void (*taskPtr)(void), uint32_t period );
+
+/**
+ * @brief Interface to register a task released by an event instead of a period.
+ * 
+ * The task runs as soon as the event is signaled, in both modes. Periodic and event
+ * tasks share the task table, the pool and the stop, start and pin interfaces.
+ * 
  * @param scheduler Pointer to the scheduler structure.
  * @param initPtr Pointer to the task initialization function.
  * @param taskPtr Pointer to the task function.
- * @param period The period in milliseconds for the task to run.
- * @return uint8_t Status of the task registration.
+ * @param event Pointer to an initialized event, see Task_Event.h.
+ * @param batch TRUE to run the task once for all the pending signals, FALSE to run it once per signal.
+ * @return uint32_t Task ID, FALSE (0) if the event is NULL or there is no space.
+ */
+uint32_t AppSched_registerEventTask( AppSched_Scheduler *scheduler, void (*initPtr)(void), void (*taskPtr)(void), struct _AppEvt_Event *event, uint8_t batch );
+
+/**
+ * @brief Interface to remove a registered task, its slot is reused by the next registration.
+ * 
+ * O(1), the task leaves the active array on the next wakeup and its ID is rejected from
+ * now on. A release already handed to the pool still runs, the slot is not reused before
+ * it finishes. Tasks of a task graph cannot be removed. Same threads as AppSched_registerTask.
+ * 
+ * @param scheduler Pointer to the scheduler structure.
+ * @param task The task ID to remove.
+ * @return uint8_t TRUE if the task was removed, FALSE if the ID is stale or invalid or the task is in a graph.
+ */
+uint8_t AppSched_unregisterTask( AppSched_Scheduler *scheduler, uint32_t task );
+
+/**
+ * @brief Interface to get the control block of a registered task.
+ * 
+ * The control block does not move while the task is registered, also when the table grows.
+ * 
+ * @param scheduler Pointer to the scheduler structure.
+ * @param task The task ID.
+ * @return AppSched_Task* Pointer to the task, NULL if the ID is stale or invalid.
+ */
+AppSched_Task *AppSched_getTask( AppSched_Scheduler *scheduler, uint32_t task );
+
+/**
+ * @brief Interface to free the task blocks allocated by the scheduler and the active array.
+ * 
+ * @param scheduler Pointer to the scheduler structure, once the scheduler returned.
  */
-uint8_t AppSched_registerTask( AppSched_Scheduler *scheduler, void (*initPtr)(void), void (*taskPtr)(void), uint32_t period );
+void AppSched_releaseTasks( AppSched_Scheduler *scheduler );
 
 /**
  * @brief Interface to stop any of the registered tasks from running.
@@ -108,10 +300,10 @@ uint8_t AppSched_registerTask( AppSched_Scheduler *scheduler, void (*initPtr)(vo
  * Stops a registered task from running.
  * 
  * @param scheduler Pointer to the scheduler structure.
- * @param task The task index to stop.
+ * @param task The task ID to stop.
  * @return uint8_t Status of the task stop operation.
  */
-uint8_t AppSched_stopTask( AppSched_Scheduler *scheduler, uint8_t task );
+uint8_t AppSched_stopTask( AppSched_Scheduler *scheduler, uint32_t task );
 
 /**
  * @brief Interface to start any of the registered tasks previously stopped.
@@ -119,10 +311,10 @@ uint8_t AppSched_stopTask( AppSched_Scheduler *scheduler, uint8_t task );
  * Starts a previously stopped task.
  * 
  * @param scheduler Pointer to the scheduler structure.
- * @param task The task index to start.
+ * @param task The task ID to start.
  * @return uint8_t Status of the task start operation.
  */
-uint8_t AppSched_startTask( AppSched_Scheduler *scheduler, uint8_t task );
+uint8_t AppSched_startTask( AppSched_Scheduler *scheduler, uint32_t task );
 
 /**
  * @brief Interface to change the task periodicity of any of the registered tasks.
@@ -130,16 +322,90 @@ uint8_t AppSched_startTask( AppSched_Scheduler *scheduler, uint8_t task );
  * Changes the period of a registered task.
  * 
  * @param scheduler Pointer to the scheduler structure.
- * @param task The task index to change the period.
+ * @param task The task ID to change the period.
  * @param period The new period in milliseconds for the task to run.
  * @return uint8_t Status of the task period change operation.
  */
-uint8_t AppSched_periodTask( AppSched_Scheduler *scheduler, uint8_t task, uint32_t period );
+uint8_t AppSched_periodTask( AppSched_Scheduler *scheduler, uint32_t task, uint32_t period );
+
+/**
+ * @brief Interface to check a task period against the mode and the tick of a scheduler.
+ * 
+ * The mode and the tick do not change once the scheduler is initialized, so any thread may
+ * check a period before it hands a task to another scheduler.
+ * 
+ * @param scheduler Pointer to the scheduler structure.
+ * @param period The period in milliseconds.
+ * @return uint8_t TRUE if AppSched_registerTask accepts the period, FALSE otherwise.
+ */
+uint8_t AppSched_validPeriod( AppSched_Scheduler *scheduler, uint32_t period );
+
+/**
+ * @brief Interface to run the tasks on a pool of worker threads.
+ * 
+ * The scheduler thread only decides which tasks are due and hands them to the workers,
+ * timers keep running in the scheduler thread. Call AppPool_stopPool once the scheduler returns.
+ * 
+ * @param scheduler Pointer to the scheduler structure.
+ * @param pool Pointer to the pool structure, the worker threads are started here.
+ * @param workers Number of worker threads, from 1 to POOL_WORKERS_N.
+ * @return uint8_t TRUE if the worker threads were started, FALSE otherwise.
+ */
+uint8_t AppSched_initPool( AppSched_Scheduler *scheduler, struct _AppPool_Pool *pool, uint8_t workers );
+
+/**
+ * @brief Interface to pin a task to one of the pool workers.
+ * 
+ * Call after AppSched_initPool, a worker index the pool does not have is rejected.
+ * 
+ * @param scheduler Pointer to the scheduler structure.
+ * @param task The task ID to pin.
+ * @param worker Worker index, POOL_ANY_WORKER lets the pool balance the task again.
+ * @return uint8_t Status of the operation.
+ */
+uint8_t AppSched_pinTask( AppSched_Scheduler *scheduler, uint32_t task, uint8_t worker );
+
+/**
+ * @brief Interface to allow or forbid overlapping runs of the same task in the pool.
+ * 
+ * A non reentrant task never runs twice at the same time, a release that finds the
+ * previous one still queued or running is skipped and counted in the task skipped field.
+ * 
+ * @param scheduler Pointer to the scheduler structure.
+ * @param task The task ID.
+ * @param reentrant TRUE to allow overlapping runs (default), FALSE otherwise.
+ * @return uint8_t Status of the operation.
+ */
+uint8_t AppSched_reentrantTask( AppSched_Scheduler *scheduler, uint32_t task, uint8_t reentrant );
+
+/**
+ * @brief Interface to choose what a task does when the loop falls a full period behind.
+ * 
+ * OVERRUN_CATCH_UP (default) runs every pending release in a burst. OVERRUN_SKIP runs only
+ * the latest one and OVERRUN_REALIGN runs the first one and moves the next release a full
+ * period after it; both count the releases they drop in the task missed field.
+ * 
+ * @param scheduler Pointer to the scheduler structure.
+ * @param task The task ID.
+ * @param overrun OVERRUN_CATCH_UP, OVERRUN_SKIP or OVERRUN_REALIGN.
+ * @return uint8_t Status of the operation.
+ */
+uint8_t AppSched_overrunTask( AppSched_Scheduler *scheduler, uint32_t task, uint8_t overrun );
+
+/**
+ * @brief Returns the monotonic time in nanoseconds.
+ * 
+ * @return uint64_t Nanoseconds from an arbitrary but fixed point in the past.
+ */
+uint64_t nanoseconds( void );
 
 /**
  * @brief Interface that will run the different tasks that have been registered.
  * 
- * Starts the scheduler to run the registered tasks.
+ * Starts the scheduler to run the registered tasks. In APPSCHED_MODE_TICK the loop sleeps until
+ * the next tick, in APPSCHED_MODE_TICKLESS it sleeps until the earliest task or timer deadline and
+ * wakes up only to dispatch. Both read the time and sleep through scheduler->timeSource, with a
+ * virtual time source the whole schedule runs without waiting.
  * 
  * @param scheduler Pointer to the scheduler structure.
  */
@@ -0,0 +1,231 @@
+/**
+ * \file       Scheduler_Group.c
+ * \brief      Implementation for the groups of per-core Scheduler instances
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#define _GNU_SOURCE     /* pthread_setaffinity_np and the CPU_ macros */
+#include <stdio.h>
+#include <sched.h>
+#include <pthread.h>
+#include "Scheduler.h"
+#include "Scheduler_Group.h"
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of local functions                       */
+/*----------------------------------------------------------------------------*/
+static uint8_t AppGrp_push( AppSched_Scheduler *target, const AppGrp_Post *post );
+static void AppGrp_registerPost( AppSched_Scheduler *scheduler, const AppGrp_Post *post );
+static void *AppGrp_instanceThread( void *arg );
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+void AppGrp_initInstance( AppGrp_Instance *instance, uint16_t cpu, uint8_t priority )
+{
+    AppGrp_Inbox *inbox = &instance->inbox;
+
+    AppMpsc_initQueue(&inbox->queue, inbox->sequence, GRP_INBOX_N);
+    inbox->received = 0;
+    inbox->rejected = 0;
+    inbox->returned = 0;
+
+    instance->cpu = cpu;
+    instance->priority = priority;
+    instance->pinned = FALSE;
+    instance->realtime = FALSE;
+
+    /* The shared AppTime_monotonic holds the wake state of one sleeping thread only */
+    AppTime_initMonotonic(&instance->source);
+    if (instance->scheduler.timeSource == NULL)
+    {
+        instance->scheduler.timeSource = &instance->source;
+    }
+
+    AppSched_initScheduler(&instance->scheduler);
+    instance->scheduler.inbox = inbox;
+}
+
+uint8_t AppGrp_startGroup( AppGrp_Instance *instance, uint32_t count )
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (pthread_create(&instance[i].thread, NULL, AppGrp_instanceThread, &instance[i]) != 0)
+        {
+            AppGrp_joinGroup(instance, i);
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+void AppGrp_joinGroup( AppGrp_Instance *instance, uint32_t count )
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        pthread_join(instance[i].thread, NULL);
+    }
+}
+
+uint8_t AppGrp_post( AppSched_Scheduler *target, void (*callPtr)(AppSched_Scheduler *scheduler, void *ctx), void *ctx )
+{
+    AppGrp_Post post = { GRP_POST_CALL, callPtr, ctx, NULL, NULL, 0u, FALSE, FALSE, OVERRUN_CATCH_UP };
+
+    if (callPtr == NULL)
+    {
+        return FALSE;
+    }
+
+    return AppGrp_push(target, &post);
+}
+
+uint8_t AppGrp_migrateTask( AppSched_Scheduler *from, uint32_t task, AppSched_Scheduler *to )
+{
+    uint8_t migrate_task_status = FALSE;
+    AppSched_Task *oldTask = AppSched_getTask(from, task);
+    AppGrp_Post post;
+
+    /* Only this thread dispatches the task, no release can start after the check. The tick and
+       the mode of the target do not change once it is initialized, its table does */
+    if ((oldTask != NULL) && (from != to) && (from->inbox != NULL) && (oldTask->event == NULL) &&
+        (oldTask->co == NULL) && (oldTask->inputs == 0u) && (oldTask->outputsCount == 0u) &&
+        (atomic_load_explicit(&oldTask->queued, memory_order_acquire) == 0u) &&
+        (AppSched_validPeriod(to, oldTask->period) == TRUE))
+    {
+        post.type = GRP_POST_TASK;
+        post.callPtr = NULL;
+        post.ctx = NULL;
+        post.from = from;
+        post.taskFunc = oldTask->taskFunc;
+        post.period = oldTask->period;
+        post.startFlag = oldTask->startFlag;
+        post.reentrant = oldTask->reentrant;
+        post.overrun = oldTask->overrun;
+
+        /* The task leaves only once the target has it, a full inbox keeps it here */
+        if (AppGrp_push(to, &post) == TRUE)
+        {
+            migrate_task_status = AppSched_unregisterTask(from, task);
+        }
+    }
+
+    return migrate_task_status;
+}
+
+void AppGrp_drain( AppSched_Scheduler *scheduler )
+{
+    AppGrp_Inbox *inbox = scheduler->inbox;
+    AppGrp_Post post;
+    uint32_t slot;
+
+    /* A claimed cell still being written counts as empty, it is drained on the next wakeup */
+    while (AppMpsc_peek(&inbox->queue, &slot) == TRUE)
+    {
+        /* The cell goes back to the producers before the post runs, it may post again */
+        post = inbox->post[slot];
+        AppMpsc_release(&inbox->queue);
+
+        if (post.type == GRP_POST_CALL)
+        {
+            post.callPtr(scheduler, post.ctx);
+            inbox->received++;
+        }
+        else
+        {
+            AppGrp_registerPost(scheduler, &post);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of local functions                      */
+/*----------------------------------------------------------------------------*/
+
+static uint8_t AppGrp_push( AppSched_Scheduler *target, const AppGrp_Post *post )
+{
+    AppGrp_Inbox *inbox = target->inbox;
+    AppTime_Source *source = target->timeSource;
+    uint32_t pos;
+
+    /* A full inbox means the target has not drained the post of the previous round yet */
+    if ((inbox == NULL) || (AppMpsc_claim(&inbox->queue, &pos) == FALSE))
+    {
+        return FALSE;
+    }
+
+    inbox->post[pos & (GRP_INBOX_N - 1u)] = *post;
+    AppMpsc_publish(&inbox->queue, pos);
+
+    /* A tickless target may sleep until a deadline far away */
+    if ((source != NULL) && (source->wake != NULL))
+    {
+        source->wake(source);
+    }
+
+    return TRUE;
+}
+
+static void AppGrp_registerPost( AppSched_Scheduler *scheduler, const AppGrp_Post *post )
+{
+    uint32_t newTask = AppSched_registerTask(scheduler, NULL, post->taskFunc, post->period);
+    AppGrp_Post back;
+
+    /* The period was checked by the source, only a full task table gets here. The source freed
+       the slot of the task, it takes it back unless its own table filled up meanwhile */
+    if (newTask == FALSE)
+    {
+        scheduler->inbox->rejected++;
+        if (post->from != NULL)
+        {
+            back = *post;
+            back.from = NULL;
+            if (AppGrp_push(post->from, &back) == TRUE)
+            {
+                scheduler->inbox->returned++;
+            }
+        }
+        return;
+    }
+
+    (void)AppSched_reentrantTask(scheduler, newTask, post->reentrant);
+    (void)AppSched_overrunTask(scheduler, newTask, post->overrun);
+    if (post->startFlag == FALSE)
+    {
+        (void)AppSched_stopTask(scheduler, newTask);
+    }
+    scheduler->inbox->received++;
+}
+
+static void *AppGrp_instanceThread( void *arg )
+{
+    AppGrp_Instance *instance = (AppGrp_Instance *)arg;
+    struct sched_param param;
+    cpu_set_t set;
+
+    /* Set from the thread itself, a refused setting leaves the thread running as it is */
+    if ((instance->cpu != GRP_ANY_CPU) && (instance->cpu < CPU_SETSIZE))
+    {
+        CPU_ZERO(&set);
+        CPU_SET(instance->cpu, &set);
+        instance->pinned = (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) ? TRUE : FALSE;
+    }
+
+    if (instance->priority > 0u)
+    {
+        param.sched_priority = instance->priority;
+        instance->realtime = (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0) ? TRUE : FALSE;
+    }
+
+    AppSched_startScheduler(&instance->scheduler);
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
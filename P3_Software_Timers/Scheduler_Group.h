@@ -0,0 +1,164 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef SCHEDULER_GROUP_H_
+#define SCHEDULER_GROUP_H_
+
+/**
+ * \file       Scheduler_Group.h
+ * \brief      Header file for the groups of per-core Scheduler instances.
+ *
+ * Every instance is a complete scheduler with its own tasks, timers and time source, run on a
+ * thread of its own that can be pinned to a CPU and raised to SCHED_FIFO. The instances share
+ * nothing: the only way from one to another is the inbox of the target, a bounded lock-free
+ * queue (many producers, one consumer) the target drains on its next wakeup. Work is posted as
+ * a function run in the target thread, or a registered task is moved over as a whole.
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "Scheduler.h"
+#include "Time_Source.h"
+#include "Mpsc_Queue.h"
+
+/*----------------------------------------------------------------------------*/
+/*                             Defines and macros                             */
+/*----------------------------------------------------------------------------*/
+
+#define GRP_INBOX_N             1024u       /*!< Posts pending per instance, power of two */
+#define GRP_ANY_CPU             0xFFFFu     /*!< The instance thread is not pinned */
+
+#define GRP_POST_CALL           0u          /*!< Runs callPtr(scheduler, ctx) in the target thread */
+#define GRP_POST_TASK           1u          /*!< Registers the task carried by the post, sends it back if it cannot */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Structure to represent a post, a call or a task moved from another instance
+ */
+typedef struct _AppGrp_Post
+{
+    uint32_t type;                          /*!< GRP_POST_CALL or GRP_POST_TASK */
+    void (*callPtr)(AppSched_Scheduler *scheduler, void *ctx); /*!< Function of a GRP_POST_CALL */
+    void *ctx;                              /*!< Context given to callPtr */
+    AppSched_Scheduler *from;               /*!< Scheduler a rejected task goes back to, NULL once it is back */
+    void (*taskFunc)(void);                 /*!< Task function of a GRP_POST_TASK */
+    uint32_t period;                        /*!< Period of the task in ms */
+    uint8_t startFlag;                      /*!< FALSE if the task was stopped */
+    uint8_t reentrant;                      /*!< Reentrancy of the task */
+    uint8_t overrun;                        /*!< Overrun policy of the task */
+} AppGrp_Post;
+
+/**
+ * @brief Structure to represent the inbox of an instance
+ */
+typedef struct _AppGrp_Inbox
+{
+    AppMpsc_Queue queue;                    /*!< Positions of the inbox, full counts the refused posts */
+    _Atomic uint32_t sequence[GRP_INBOX_N]; /*!< Owner of every post cell */
+    AppGrp_Post post[GRP_INBOX_N];          /*!< Posted work */
+    uint32_t received;                      /*!< Calls run and tasks registered */
+    uint32_t rejected;                      /*!< Tasks this instance could not register */
+    uint32_t returned;                      /*!< Rejected tasks sent back to the instance they came from */
+} AppGrp_Inbox;
+
+/**
+ * @brief Structure to represent one scheduler instance and its thread
+ */
+typedef struct _AppGrp_Instance
+{
+    AppSched_Scheduler scheduler;           /*!< The scheduler, configured like a single one */
+    AppTime_Source source;                  /*!< Monotonic source of this instance, a post wakes only it */
+    AppGrp_Inbox inbox;                     /*!< Work posted by the other instances */
+    uint16_t cpu;                           /*!< CPU the thread is pinned to, GRP_ANY_CPU for none */
+    uint8_t priority;                       /*!< SCHED_FIFO priority from 1 to 99, 0 keeps the default policy */
+    uint8_t pinned;                         /*!< TRUE once the affinity was applied */
+    uint8_t realtime;                       /*!< TRUE once SCHED_FIFO was applied, it needs CAP_SYS_NICE */
+    pthread_t thread;                       /*!< Thread running the scheduler */
+} AppGrp_Instance;
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes the scheduler of an instance and attaches its inbox and time source
+ *
+ * The scheduler fields are set as for AppSched_initScheduler before calling this function, which
+ * calls it. A scheduler without a time source gets the monotonic source of the instance. Tasks and
+ * timers are registered afterwards from the calling thread, until the group starts.
+ *
+ * @param instance Pointer to the instance
+ * @param cpu CPU to pin the thread to, GRP_ANY_CPU to let the kernel place it
+ * @param priority SCHED_FIFO priority from 1 to 99, 0 for the default policy
+ */
+void AppGrp_initInstance( AppGrp_Instance *instance, uint16_t cpu, uint8_t priority );
+
+/**
+ * @brief Starts one thread per instance, each one runs AppSched_startScheduler
+ *
+ * The thread applies its affinity and priority before the scheduler starts. A CPU that does not
+ * exist or a priority the process is not allowed to use only leave pinned or realtime FALSE.
+ *
+ * @param instance Array of initialized instances
+ * @param count Number of instances
+ * @return uint8_t TRUE if every thread was started, FALSE otherwise (the started ones are joined)
+ */
+uint8_t AppGrp_startGroup( AppGrp_Instance *instance, uint32_t count );
+
+/**
+ * @brief Waits until every scheduler of the group reached its timeout
+ *
+ * @param instance Array of started instances
+ * @param count Number of instances
+ */
+void AppGrp_joinGroup( AppGrp_Instance *instance, uint32_t count );
+
+/**
+ * @brief Posts a call to run in the thread of another instance, safe from any thread and lock-free
+ *
+ * The target runs callPtr(scheduler, ctx) on its next wakeup, before its tasks, and a sleeping
+ * target is woken up. The call may use every scheduler interface of the target.
+ *
+ * @param target Pointer to the scheduler of the target instance
+ * @param callPtr Function to run
+ * @param ctx Context given to callPtr
+ * @return uint8_t TRUE if the call was queued, FALSE if the inbox is full or the target has none
+ */
+uint8_t AppGrp_post( AppSched_Scheduler *target, void (*callPtr)(AppSched_Scheduler *scheduler, void *ctx), void *ctx );
+
+/**
+ * @brief Moves a periodic task to another instance, from the thread of the source scheduler
+ *
+ * The task is unregistered here and registered again by the target on its next wakeup, with
+ * the same period, state and policies. It does not keep its phase: the next deadline is lost and
+ * the first release on the target comes one period after it registers the task. The ID given by
+ * the source is invalid once this returns TRUE and the new ID is not reported back, a caller that
+ * keeps a handle looks the task up again on the target. The init function does not run again.
+ *
+ * The period is checked against the tick of the target before the task leaves. A target whose
+ * task table is full counts the task in returned and sends it back, the source registers it
+ * again on its next wakeup with yet another ID. Event tasks, coroutine tasks and tasks of a task
+ * graph stay where they are, they hold state of the source scheduler.
+ *
+ * @param from Pointer to the scheduler the task is registered with, an instance of the group
+ * @param task The task ID
+ * @param to Pointer to the scheduler of the target instance
+ * @return uint8_t TRUE if the task was moved, FALSE if the ID is invalid, the task cannot move,
+ *                 the target cannot run its period, one of its releases still runs in the pool
+ *                 or the inbox is full
+ */
+uint8_t AppGrp_migrateTask( AppSched_Scheduler *from, uint32_t task, AppSched_Scheduler *to );
+
+/**
+ * @brief Runs the posts waiting in the inbox of a scheduler, scheduler thread only
+ *
+ * @param scheduler Pointer to a scheduler with an inbox
+ */
+void AppGrp_drain( AppSched_Scheduler *scheduler );
+
+#endif /* SCHEDULER_GROUP_H_ */
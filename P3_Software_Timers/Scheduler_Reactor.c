@@ -0,0 +1,310 @@
+/**
+ * \file       Scheduler_Reactor.c
+ * \brief      Implementation for the epoll Reactor of the Scheduler
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include "Scheduler.h"
+#include "Scheduler_Reactor.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define REACTOR_TIMER           0xFFFFFFFEu /* epoll data of timerFd, the others hold the slot */
+#define REACTOR_WAKE            0xFFFFFFFFu /* epoll data of eventFd */
+
+/* epoll data of a watched descriptor, the slot in the low word and its generation on top */
+#define REACTOR_DATA(slot, gen) (((uint64_t)(gen) << 32u) | (uint64_t)(slot))
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of local functions                       */
+/*----------------------------------------------------------------------------*/
+static void AppRct_sleep( AppTime_Source *source, uint64_t deadline );
+static void AppRct_wake( AppTime_Source *source );
+static uint8_t AppRct_poll( AppRct_Reactor *reactor, int timeout );
+static AppRct_Fd *AppRct_lookupFd( AppRct_Reactor *reactor, int fd );
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+uint8_t AppRct_initReactor( AppRct_Reactor *reactor )
+{
+    struct epoll_event ev;
+
+    AppTime_initMonotonic(&reactor->source);
+    reactor->source.sleepUntil = AppRct_sleep;
+    reactor->source.wake = AppRct_wake;
+    reactor->armed = 0;
+    reactor->fdsCount = 0;
+    reactor->waits = 0;
+    reactor->timerWakes = 0;
+    reactor->postWakes = 0;
+    reactor->ioCalls = 0;
+
+    reactor->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    reactor->timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    reactor->eventFd = eventfd(0u, EFD_NONBLOCK | EFD_CLOEXEC);
+    if ((reactor->epollFd < 0) || (reactor->timerFd < 0) || (reactor->eventFd < 0))
+    {
+        AppRct_closeReactor(reactor);
+        return FALSE;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.u64 = REACTOR_TIMER;
+    if (epoll_ctl(reactor->epollFd, EPOLL_CTL_ADD, reactor->timerFd, &ev) != 0)
+    {
+        AppRct_closeReactor(reactor);
+        return FALSE;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.u64 = REACTOR_WAKE;
+    if (epoll_ctl(reactor->epollFd, EPOLL_CTL_ADD, reactor->eventFd, &ev) != 0)
+    {
+        AppRct_closeReactor(reactor);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void AppRct_closeReactor( AppRct_Reactor *reactor )
+{
+    if (reactor->epollFd >= 0)
+    {
+        close(reactor->epollFd);
+    }
+    if (reactor->timerFd >= 0)
+    {
+        close(reactor->timerFd);
+    }
+    if (reactor->eventFd >= 0)
+    {
+        close(reactor->eventFd);
+    }
+    reactor->epollFd = -1;
+    reactor->timerFd = -1;
+    reactor->eventFd = -1;
+}
+
+void AppSched_initReactor( AppSched_Scheduler *scheduler, AppRct_Reactor *reactor )
+{
+    scheduler->timeSource = &reactor->source;
+    scheduler->reactor = reactor;
+}
+
+uint8_t AppRct_addFd( AppRct_Reactor *reactor, int fd, uint32_t events, void (*callbackPtr)(int fd, uint32_t events, void *ctx), void *ctx )
+{
+    struct epoll_event ev;
+    uint32_t index = REACTOR_FDS_N;
+
+    if ((fd < 0) || (callbackPtr == NULL) || (AppRct_lookupFd(reactor, fd) != NULL))
+    {
+        return FALSE;
+    }
+
+    /* The first free slot, the table is small and only changes outside the hot path */
+    for (uint32_t s = 0; s < reactor->fdsCount; s++)
+    {
+        if (reactor->fd[s].used == FALSE)
+        {
+            index = s;
+            break;
+        }
+    }
+    if ((index == REACTOR_FDS_N) && (reactor->fdsCount < REACTOR_FDS_N))
+    {
+        index = reactor->fdsCount;
+        reactor->fd[index].generation = 0u;
+        reactor->fdsCount++;
+    }
+    if (index == REACTOR_FDS_N)
+    {
+        return FALSE; /* No space left */
+    }
+
+    ev.events = events;
+    ev.data.u64 = REACTOR_DATA(index, reactor->fd[index].generation);
+    if (epoll_ctl(reactor->epollFd, EPOLL_CTL_ADD, fd, &ev) != 0)
+    {
+        return FALSE; /* Not a descriptor epoll can watch, a regular file for example */
+    }
+
+    reactor->fd[index].fd = fd;
+    reactor->fd[index].events = events;
+    reactor->fd[index].callbackPtr = callbackPtr;
+    reactor->fd[index].ctx = ctx;
+    reactor->fd[index].used = TRUE;
+
+    return TRUE;
+}
+
+uint8_t AppRct_modifyFd( AppRct_Reactor *reactor, int fd, uint32_t events )
+{
+    struct epoll_event ev;
+    AppRct_Fd *watched = AppRct_lookupFd(reactor, fd);
+
+    if (watched == NULL)
+    {
+        return FALSE;
+    }
+
+    ev.events = events;
+    ev.data.u64 = REACTOR_DATA(watched - reactor->fd, watched->generation);
+    if (epoll_ctl(reactor->epollFd, EPOLL_CTL_MOD, fd, &ev) != 0)
+    {
+        return FALSE;
+    }
+    watched->events = events;
+
+    return TRUE;
+}
+
+uint8_t AppRct_removeFd( AppRct_Reactor *reactor, int fd )
+{
+    AppRct_Fd *watched = AppRct_lookupFd(reactor, fd);
+
+    if (watched == NULL)
+    {
+        return FALSE;
+    }
+
+    /* An event of it already taken by the current epoll_wait is dropped, also when a callback
+       after this one gives the slot to another descriptor: it carries the old generation */
+    epoll_ctl(reactor->epollFd, EPOLL_CTL_DEL, fd, NULL);
+    watched->used = FALSE;
+    watched->generation++;
+
+    return TRUE;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of local functions                      */
+/*----------------------------------------------------------------------------*/
+
+static void AppRct_sleep( AppTime_Source *source, uint64_t deadline )
+{
+    AppRct_Reactor *reactor = (AppRct_Reactor *)source;
+    struct itimerspec its = { { 0, 0 }, { 0, 0 } };
+    uint32_t seen = source->wakeSeen;
+    uint8_t done;
+
+    /* A zero time would disarm the timer, and a deadline already armed needs no system call */
+    deadline = (deadline == 0u) ? 1u : deadline;
+    if (deadline != reactor->armed)
+    {
+        its.it_value.tv_sec = (time_t)(deadline / 1000000000ull);
+        its.it_value.tv_nsec = (long)(deadline % 1000000000ull);
+        timerfd_settime(reactor->timerFd, TFD_TIMER_ABSTIME, &its, NULL);
+        reactor->armed = deadline;
+    }
+
+    /* Same handshake as the futex of the monotonic source: a wake either sees sleeping set and
+       writes the eventfd, or the loop sees its wakeSeq. The descriptors are polled at least once
+       so a loop woken all the time still serves them */
+    atomic_store(&source->sleeping, 1u);
+    done = AppRct_poll(reactor, (atomic_load(&source->wakeSeq) == seen) ? -1 : 0);
+    while ((done == FALSE) && (atomic_load(&source->wakeSeq) == seen))
+    {
+        done = AppRct_poll(reactor, -1);
+    }
+    atomic_store(&source->sleeping, 0u);
+
+    if (atomic_load(&source->wakeSeq) != seen)
+    {
+        reactor->postWakes++;
+    }
+    source->wakeSeen = atomic_load(&source->wakeSeq);
+}
+
+static void AppRct_wake( AppTime_Source *source )
+{
+    AppRct_Reactor *reactor = (AppRct_Reactor *)source;
+    uint64_t one = 1u;
+
+    atomic_fetch_add(&source->wakeSeq, 1u);
+
+    /* The write is only needed while the scheduler thread is really waiting */
+    if (atomic_load(&source->sleeping) != 0u)
+    {
+        (void)!write(reactor->eventFd, &one, sizeof(one));
+    }
+}
+
+static uint8_t AppRct_poll( AppRct_Reactor *reactor, int timeout )
+{
+    struct epoll_event ev[REACTOR_EVENTS_N];
+    uint64_t count;
+    uint8_t done = FALSE;
+    AppRct_Fd *watched;
+    uint32_t slot;
+    int n;
+
+    n = epoll_wait(reactor->epollFd, ev, (int)REACTOR_EVENTS_N, timeout);
+    reactor->waits++;
+    if (n < 0)
+    {
+        return FALSE; /* EINTR, a signal, the caller waits again for the same deadline */
+    }
+
+    for (int e = 0; e < n; e++)
+    {
+        slot = (uint32_t)ev[e].data.u64;
+        if (slot == REACTOR_TIMER)
+        {
+            /* The timer is disarmed once expired, the next sleep arms it again */
+            (void)!read(reactor->timerFd, &count, sizeof(count));
+            reactor->armed = 0;
+            reactor->timerWakes++;
+            done = TRUE;
+        }
+        else if (slot == REACTOR_WAKE)
+        {
+            /* Only resets the counter, the caller sees the new wakeSeq */
+            (void)!read(reactor->eventFd, &count, sizeof(count));
+        }
+        else
+        {
+            /* A callback before may have removed the descriptor, or removed it and added another */
+            watched = &reactor->fd[slot];
+            if ((watched->used == TRUE) && (watched->generation == (uint32_t)(ev[e].data.u64 >> 32u)))
+            {
+                watched->callbackPtr(watched->fd, ev[e].events, watched->ctx);
+                reactor->ioCalls++;
+                done = TRUE;
+            }
+        }
+    }
+
+    return done;
+}
+
+static AppRct_Fd *AppRct_lookupFd( AppRct_Reactor *reactor, int fd )
+{
+    for (uint32_t s = 0; s < reactor->fdsCount; s++)
+    {
+        if ((reactor->fd[s].used == TRUE) && (reactor->fd[s].fd == fd))
+        {
+            return &reactor->fd[s];
+        }
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,137 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef SCHEDULER_REACTOR_H_
+#define SCHEDULER_REACTOR_H_
+
+/**
+ * \file       Scheduler_Reactor.h
+ * \brief      Header file for the epoll Reactor of the Scheduler.
+ *
+ * The reactor is a time source whose sleep is a single epoll_wait. It covers a timerfd armed
+ * with the next deadline of the scheduler, an eventfd written by a wake (an event signal, a
+ * queue post, a timer service command or a post of another instance) and the file descriptors
+ * registered by the application. Their callbacks run in the scheduler thread during the sleep,
+ * so periodic tasks, timers, queue consumers and socket I/O share one thread and an idle loop
+ * uses no CPU at all.
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "Scheduler.h"
+#include "Time_Source.h"
+
+/*----------------------------------------------------------------------------*/
+/*                             Defines and macros                             */
+/*----------------------------------------------------------------------------*/
+
+#ifndef REACTOR_FDS_N
+#define REACTOR_FDS_N           64u         /*!< File descriptors a reactor can watch */
+#endif
+#define REACTOR_EVENTS_N        16u         /*!< Events taken by one epoll_wait */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Structure to represent a file descriptor watched by the reactor
+ */
+typedef struct _AppRct_Fd
+{
+    int fd;                                 /*!< Watched file descriptor */
+    uint32_t events;                        /*!< EPOLLIN, EPOLLOUT, ... as given to epoll_ctl */
+    void (*callbackPtr)(int fd, uint32_t events, void *ctx); /*!< Called with the ready events */
+    void *ctx;                              /*!< Context given to callbackPtr */
+    uint32_t generation;                    /*!< Bumped on every remove, an event of the old descriptor no longer matches */
+    uint8_t used;                           /*!< FALSE while the slot is free */
+} AppRct_Fd;
+
+/**
+ * @brief Structure to represent a reactor
+ */
+typedef struct _AppRct_Reactor
+{
+    AppTime_Source source;                  /*!< First member, scheduler->timeSource points here */
+    int epollFd;                            /*!< Waits for all the descriptors below */
+    int timerFd;                            /*!< Absolute CLOCK_MONOTONIC timer on the next deadline */
+    int eventFd;                            /*!< Written by a wake while the scheduler sleeps */
+    uint64_t armed;                         /*!< Deadline in timerFd, 0 if disarmed */
+    AppRct_Fd fd[REACTOR_FDS_N];            /*!< Watched file descriptors */
+    uint32_t fdsCount;                      /*!< Slots in use or free below it */
+    uint32_t waits;                         /*!< Calls to epoll_wait */
+    uint32_t timerWakes;                    /*!< Sleeps ended by the deadline */
+    uint32_t postWakes;                     /*!< Sleeps ended by a wake */
+    uint32_t ioCalls;                       /*!< File descriptor callbacks run */
+} AppRct_Reactor;
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Creates the epoll, timer and event descriptors of a reactor
+ *
+ * The reactor reads the time like AppTime_initMonotonic.
+ *
+ * @param reactor Pointer to the reactor
+ * @return uint8_t TRUE if the descriptors were created, FALSE otherwise
+ */
+uint8_t AppRct_initReactor( AppRct_Reactor *reactor );
+
+/**
+ * @brief Closes the descriptors of a reactor, not the watched ones
+ *
+ * @param reactor Pointer to the reactor, once the scheduler returned
+ */
+void AppRct_closeReactor( AppRct_Reactor *reactor );
+
+/**
+ * @brief Makes the scheduler sleep in the reactor
+ *
+ * Sets the reactor as time source of the scheduler. A tickless scheduler with a reactor keeps
+ * running until its timeout, a watched descriptor can become ready at any time. Call it after
+ * AppSched_initScheduler.
+ *
+ * @param scheduler Pointer to the scheduler
+ * @param reactor Pointer to an initialized reactor, it has to live as long as the scheduler
+ */
+void AppSched_initReactor( AppSched_Scheduler *scheduler, AppRct_Reactor *reactor );
+
+/**
+ * @brief Starts to watch a file descriptor, scheduler thread or before the scheduler starts
+ *
+ * The callback runs in the scheduler thread once per epoll_wait that reports the descriptor,
+ * level-triggered unless EPOLLET is given. It can read and write the descriptor, register
+ * tasks, start timers, signal events and add or remove descriptors. The sleep ends after
+ * the callbacks so the loop sees what they changed. The descriptor should be non-blocking.
+ *
+ * @param reactor Pointer to the reactor
+ * @param fd File descriptor to watch
+ * @param events EPOLLIN, EPOLLOUT, ... as given to epoll_ctl
+ * @param callbackPtr Function called with the ready events
+ * @param ctx Context given to the callback
+ * @return uint8_t TRUE if the descriptor is watched, FALSE if it is invalid, already watched or there is no space
+ */
+uint8_t AppRct_addFd( AppRct_Reactor *reactor, int fd, uint32_t events, void (*callbackPtr)(int fd, uint32_t events, void *ctx), void *ctx );
+
+/**
+ * @brief Changes the events watched on a file descriptor, for example to add EPOLLOUT
+ *
+ * @param reactor Pointer to the reactor
+ * @param fd Watched file descriptor
+ * @param events New events
+ * @return uint8_t TRUE if the events were changed, FALSE if the descriptor is not watched
+ */
+uint8_t AppRct_modifyFd( AppRct_Reactor *reactor, int fd, uint32_t events );
+
+/**
+ * @brief Stops watching a file descriptor, it is not closed
+ *
+ * @param reactor Pointer to the reactor
+ * @param fd Watched file descriptor
+ * @return uint8_t TRUE if the descriptor was removed, FALSE if it is not watched
+ */
+uint8_t AppRct_removeFd( AppRct_Reactor *reactor, int fd );
+
+#endif /* SCHEDULER_REACTOR_H_ */
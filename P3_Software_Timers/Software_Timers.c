@@ -14,11 +14,15 @@
 #include <time.h>
 #include "Scheduler.h"
 #include "Software_Timers.h"
+#include "Timer_Wheel.h"
+#include "Timer_Service.h"
 
 /*----------------------------------------------------------------------------*/
 /*                               Local defines                                */
 /*----------------------------------------------------------------------------*/
 
+#define TIMER_SLOT(handle)      (((handle) & TIMER_INDEX_MASK) - OFF_SET)
+
 /*----------------------------------------------------------------------------*/
 /*                       Declaration of Global Variables                      */
 /*----------------------------------------------------------------------------*/
@@ -27,57 +31,134 @@
 AppSched_Timer timers[ TIMERS_N ];
 
 /* Timers IDs */
-uint8_t TimerID;
-uint8_t TimerID2;
-uint8_t TimerID3;
+uint32_t TimerID;
+uint32_t TimerID2;
+uint32_t TimerID3;
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of local functions                       */
+/*----------------------------------------------------------------------------*/
+static uint8_t AppSched_validTimeout( AppSched_Scheduler *scheduler, uint32_t timeout );
+static AppSched_Timer *AppSched_lookupTimer( AppSched_Scheduler *scheduler, uint32_t timer );
+static uint8_t AppSched_growTimers( AppSched_Scheduler *scheduler );
+static uint32_t AppSched_allocTimer( AppSched_Scheduler *scheduler, uint32_t timeout, uint8_t mode );
 
 /*----------------------------------------------------------------------------*/
 /*                     Implementation of functions                            */
 /*----------------------------------------------------------------------------*/
 
-uint8_t AppSched_registerTimer( AppSched_Scheduler *scheduler, uint32_t timeout, void (*callbackPtr)(void) )
+uint32_t AppSched_registerTimer( AppSched_Scheduler *scheduler, uint32_t timeout, void (*callbackPtr)(void) )
 {
-    uint8_t register_timer_status;
+    uint32_t register_timer_status;
 
-    /* Declares a pointer to an AppSched_Timer structure */
-    AppSched_Timer *newTimer = &scheduler -> timerPtr[scheduler -> timersCount]; 
-
-    /* Timeout is larger than the actual tick and multiple and if i have space to store timers*/
-    if( (timeout > scheduler -> tick) && (timeout % scheduler -> tick ==  0) && (scheduler -> timersCount <= scheduler -> timers) )
+    /* Registered timers are auto-reload timers that are never destroyed */
+    register_timer_status = AppSched_allocTimer(scheduler, timeout, TIMER_MODE_AUTO_RELOAD);
+    if (register_timer_status != FALSE)
     {
-        /* Timer successfully register */
         /* Set the callback function */
-        newTimer -> callbackPtr = callbackPtr;
-        /* Set the timeout value in milliseconds */
-        newTimer -> timeout = timeout;
-        /* Returns an ID which is a value from 1 to the number of timer registers in the scheduler */
-        register_timer_status = (scheduler -> timersCount) + OFF_SET;
-        /* Increment Timers count*/
-        scheduler -> timersCount++;
+        scheduler -> timerPtr[TIMER_SLOT(register_timer_status)].callbackPtr = callbackPtr;
+    }
+
+    return register_timer_status;
+}
+
+uint32_t AppSched_createTimer( AppSched_Scheduler *scheduler, uint32_t timeout, uint8_t mode, void (*callbackPtr)(void *ctx), void *ctx )
+{
+    uint32_t create_timer_status = FALSE;
+    AppSched_Timer *newTimer;
+
+    if ((callbackPtr != NULL) && ((mode == TIMER_MODE_AUTO_RELOAD) || (mode == TIMER_MODE_ONE_SHOT)))
+    {
+        create_timer_status = AppSched_allocTimer(scheduler, timeout, mode);
+    }
+
+    if (create_timer_status != FALSE)
+    {
+        newTimer = &scheduler -> timerPtr[TIMER_SLOT(create_timer_status)];
+        newTimer -> ctxCallbackPtr = callbackPtr;
+        newTimer -> ctx = ctx;
+    }
+
+    return create_timer_status;
+}
+
+uint8_t AppSched_destroyTimer( AppSched_Scheduler *scheduler, uint32_t timer )
+{
+    uint8_t destroy_timer_status;
+
+    AppSched_Timer *destroyTimer = AppSched_lookupTimer(scheduler, timer);
+
+    if (destroyTimer != NULL)
+    {
+        if (scheduler -> wheel != NULL)
+        {
+            AppWheel_remove(scheduler -> wheel, scheduler -> timerPtr, TIMER_SLOT(timer));
+        }
+        destroyTimer -> startFlag = FALSE;
+        destroyTimer -> used = FALSE;
+        /* Every handle given out for this slot so far stops matching */
+        destroyTimer -> generation = (uint16_t)((destroyTimer -> generation + 1u) & TIMER_GEN_MASK);
+        AppSched_syncTimer(scheduler, TIMER_SLOT(timer));
+        destroyTimer -> nextFree = scheduler -> freeTimer;
+        scheduler -> freeTimer = TIMER_SLOT(timer);
+        destroy_timer_status = TRUE;
     }
     else
-    {   
-        /*  Timer couldn't be registered */
-        /*  Returns 0 */
-        register_timer_status = FALSE;
+    {
+        destroy_timer_status = FALSE;
     }
 
-    return register_timer_status;
+    return destroy_timer_status;
+}
+
+void AppSched_releaseTimers( AppSched_Scheduler *scheduler )
+{
+    free(scheduler -> timerDeadline);
+    scheduler -> timerDeadline = NULL;
+
+    if (scheduler -> timersOwned == TRUE)
+    {
+        free(scheduler -> timerPtr);
+        scheduler -> timerPtr = NULL;
+        scheduler -> timers = 0;
+        scheduler -> timersCount = 0;
+        scheduler -> freeTimer = TIMER_NONE;
+    }
 }
 
-uint32_t AppSched_getTimer( AppSched_Scheduler *scheduler, uint8_t timer )
+uint32_t AppSched_getTimer( AppSched_Scheduler *scheduler, uint32_t timer )
 {
     uint32_t get_timer_status;
 
     /* Declares a pointer to an AppSched_Timer structure */
-    AppSched_Timer *getTimer = &scheduler -> timerPtr[timer]; 
+    AppSched_Timer *getTimer = AppSched_lookupTimer(scheduler, timer);
 
     /*  Evaluate if Timer has been registered  */
-    if(timer <= scheduler -> timersCount)
+    if(getTimer != NULL)
     {
         /*  Timer has been registered  */
         /*  Return the current timer pending time in milliseconds   */
-        get_timer_status = ((getTimer ->  timeout) - (getTimer -> count)* scheduler -> tick);
+        if (scheduler -> mode == APPSCHED_MODE_TICKLESS)
+        {
+            /*  The tickless loop does not count ticks, the deadline tells the time left  */
+            if (getTimer -> startFlag == TRUE)
+            {
+                get_timer_status = (getTimer -> deadline > scheduler -> now) ?
+                                   (uint32_t)((getTimer -> deadline - scheduler -> now) / NS_PER_MS) : 0u;
+            }
+            else
+            {
+                get_timer_status = getTimer -> timeout;
+            }
+        }
+        else if ((scheduler -> wheel != NULL) && (getTimer -> wheelSlot != WHEEL_IDLE))
+        {
+            get_timer_status = (getTimer -> expiry - scheduler -> wheel -> now) * scheduler -> tick;
+        }
+        else
+        {
+            get_timer_status = ((getTimer ->  timeout) - (getTimer -> count)* scheduler -> tick);
+        }
     }
     else
     {
@@ -89,19 +170,27 @@ uint32_t AppSched_getTimer( AppSched_Scheduler *scheduler, uint8_t timer )
 
 }
 
-uint8_t AppSched_reloadTimer( AppSched_Scheduler *scheduler, uint8_t timer, uint32_t timeout )
+uint8_t AppSched_reloadTimer( AppSched_Scheduler *scheduler, uint32_t timer, uint32_t timeout )
 {
     uint8_t reload_timer_status;
 
-    AppSched_Timer *reloadTimer = &scheduler -> timerPtr[timer - OFF_SET]; 
+    AppSched_Timer *reloadTimer = AppSched_lookupTimer(scheduler, timer);
 
     /*  Evaluate if Timer to reload has been registered  */
-    if((timer <= scheduler -> timersCount) && (timeout > scheduler -> tick) && (timeout % scheduler -> tick ==  0))
+    if((reloadTimer != NULL) && (AppSched_validTimeout(scheduler, timeout) == TRUE))
     {
         /*  Timer to reload has been registered  */
         /*  The timer will be reloaded with a new value in milliseconds */  
         reloadTimer -> timeout = timeout;
+        reloadTimer -> count = 0;
+        reloadTimer -> due = scheduler -> now + (uint64_t)timeout * NS_PER_MS;
+        reloadTimer -> deadline = AppSched_coalesce(reloadTimer -> due, (uint64_t)reloadTimer -> slack * NS_PER_MS);
         reloadTimer -> startFlag = TRUE;
+        AppSched_syncTimer(scheduler, TIMER_SLOT(timer));
+        if (scheduler -> wheel != NULL)
+        {
+            AppWheel_insert(scheduler -> wheel, scheduler -> timerPtr, TIMER_SLOT(timer), timeout / scheduler -> tick);
+        }
         reload_timer_status = TRUE;
     }
     else
@@ -114,17 +203,27 @@ uint8_t AppSched_reloadTimer( AppSched_Scheduler *scheduler, uint8_t timer, uint
 
 }
 
-uint8_t AppSched_startTimer( AppSched_Scheduler *scheduler, uint8_t timer )
+uint8_t AppSched_startTimer( AppSched_Scheduler *scheduler, uint32_t timer )
 {
     uint8_t start_timer_status;
 
-    AppSched_Timer *startTimer = &scheduler -> timerPtr[timer - OFF_SET];
+    AppSched_Timer *startTimer = AppSched_lookupTimer(scheduler, timer);
 
     /*  Evaluate if Timer to reload has been registered  */
-    if(timer - OFF_SET <= scheduler -> timersCount)
+    if(startTimer != NULL)
     {
         /* Timer to start has been registered  */
+        /* In tickless mode the timer expires one full timeout after it was started */
+        startTimer -> count = 0;
+        startTimer -> due = scheduler -> now + (uint64_t)startTimer -> timeout * NS_PER_MS;
+        startTimer -> deadline = AppSched_coalesce(startTimer -> due, (uint64_t)startTimer -> slack * NS_PER_MS);
         startTimer -> startFlag = TRUE;
+        AppSched_syncTimer(scheduler, TIMER_SLOT(timer));
+        if (scheduler -> wheel != NULL)
+        {
+            /* With the wheel a start always runs a full timeout, also for a running timer */
+            AppWheel_insert(scheduler -> wheel, scheduler -> timerPtr, TIMER_SLOT(timer), startTimer -> timeout / scheduler -> tick);
+        }
         start_timer_status = TRUE;
     }
     else
@@ -137,18 +236,23 @@ uint8_t AppSched_startTimer( AppSched_Scheduler *scheduler, uint8_t timer )
 
 }
 
-uint8_t AppSched_stopTimer( AppSched_Scheduler *scheduler, uint8_t timer )
+uint8_t AppSched_stopTimer( AppSched_Scheduler *scheduler, uint32_t timer )
 {
 
     uint8_t stop_timer_status;
 
-    AppSched_Timer *stopTimer = &scheduler -> timerPtr[timer - OFF_SET];
+    AppSched_Timer *stopTimer = AppSched_lookupTimer(scheduler, timer);
 
     /*  Evaluate if Timer to stop has been registered  */
-    if(timer <= scheduler -> timersCount)
+    if(stopTimer != NULL)
     {
         /*  Timer to stop has been registered  */
         stopTimer -> startFlag = FALSE;
+        AppSched_syncTimer(scheduler, TIMER_SLOT(timer));
+        if (scheduler -> wheel != NULL)
+        {
+            AppWheel_remove(scheduler -> wheel, scheduler -> timerPtr, TIMER_SLOT(timer));
+        }
         stop_timer_status = TRUE;
     }
     else
@@ -161,6 +265,269 @@ uint8_t AppSched_stopTimer( AppSched_Scheduler *scheduler, uint8_t timer )
 
 }
 
+uint8_t AppSched_initWheel( AppSched_Scheduler *scheduler, AppSched_Wheel *wheel )
+{
+    uint8_t init_wheel_status;
+
+    /* The wheel counts ticks, tickless mode keeps using the deadlines */
+    if (scheduler -> mode == APPSCHED_MODE_TICK)
+    {
+        AppWheel_initWheel(wheel);
+        wheel -> now = scheduler -> tickCount;
+        scheduler -> wheel = wheel;
+
+        /* Timers started before the wheel was attached */
+        for (uint32_t b = 0; b < scheduler -> timersCount; b++)
+        {
+            if (scheduler -> timerPtr[b].startFlag == TRUE)
+            {
+                AppWheel_insert(wheel, scheduler -> timerPtr, b, scheduler -> timerPtr[b].timeout / scheduler -> tick);
+            }
+        }
+        init_wheel_status = TRUE;
+    }
+    else
+    {
+        init_wheel_status = FALSE;
+    }
+
+    return init_wheel_status;
+}
+
+uint8_t AppSched_slackTimer( AppSched_Scheduler *scheduler, uint32_t timer, uint32_t slack )
+{
+    uint8_t slack_timer_status;
+
+    AppSched_Timer *slackTimer = AppSched_lookupTimer(scheduler, timer);
+
+    if (slackTimer != NULL)
+    {
+        slackTimer -> slack = slack;
+        slackTimer -> deadline = AppSched_coalesce(slackTimer -> due, (uint64_t)slack * NS_PER_MS);
+        AppSched_syncTimer(scheduler, TIMER_SLOT(timer));
+        slack_timer_status = TRUE;
+    }
+    else
+    {
+        slack_timer_status = FALSE;
+    }
+
+    return slack_timer_status;
+}
+
+void AppSched_syncTimer( AppSched_Scheduler *scheduler, uint32_t index )
+{
+    AppSched_Timer *timer = &scheduler -> timerPtr[index];
+
+    /* A stopped timer never wins the minimum nor passes the due check, no flag to read */
+    scheduler -> timerDeadline[index] = (timer -> startFlag == TRUE) ? timer -> deadline : TIMER_NEVER;
+}
+
+uint64_t AppSched_coalesce( uint64_t due, uint64_t slack )
+{
+    uint64_t grain = slack;
+
+    /* Keep the highest bit only, the boundaries of a large slack are also boundaries of a small one */
+    while ((grain & (grain - 1u)) != 0u)
+    {
+        grain &= grain - 1u;
+    }
+
+    return (grain > 1u) ? ((due + grain - 1u) & ~(grain - 1u)) : due;
+}
+
+void AppSched_accountSlack( AppSched_Scheduler *scheduler, uint64_t deadline, uint64_t due )
+{
+    uint8_t seen = FALSE;
+
+    if (deadline != due)
+    {
+        scheduler -> coalesced++;
+        scheduler -> slackDelay += deadline - due;
+    }
+
+    for (uint8_t d = 0; d < scheduler -> dueCount; d++)
+    {
+        if (scheduler -> dueSeen[d] == due)
+        {
+            seen = TRUE;
+            break;
+        }
+    }
+
+    /* Without the slack this expiration time would have needed its own wakeup. A late loop also
+       serves several due times at once, that is not a saving unless the slack moved this one */
+    if (seen == FALSE)
+    {
+        if ((scheduler -> dueCount > 0u) && (deadline != due))
+        {
+            scheduler -> wakeupsSaved++;
+        }
+        if (scheduler -> dueCount < SLACK_SEEN_N)
+        {
+            scheduler -> dueSeen[scheduler -> dueCount] = due;
+            scheduler -> dueCount++;
+        }
+    }
+}
+
+void AppSched_initService( AppSched_Scheduler *scheduler, AppSvc_Service *service, uint8_t deferred )
+{
+    AppSvc_initService(service, deferred);
+
+    /* The posting threads read the time source to wake the scheduler, it must not change later */
+    if (scheduler -> timeSource == NULL)
+    {
+        scheduler -> timeSource = &AppTime_monotonic;
+    }
+    scheduler -> service = service;
+}
+
+uint8_t AppSched_postTimer( AppSched_Scheduler *scheduler, uint32_t command, uint32_t timer, uint32_t timeout )
+{
+    uint8_t post_timer_status;
+    AppSvc_Command newCommand = { command, timer, timeout };
+    AppTime_Source *source = scheduler -> timeSource;
+
+    post_timer_status = AppSvc_post(scheduler -> service, &newCommand);
+
+    /* Only the tickless loop can sleep past the next command */
+    if ((post_timer_status == TRUE) && (scheduler -> mode == APPSCHED_MODE_TICKLESS) && (source -> wake != NULL))
+    {
+        source -> wake(source);
+    }
+
+    return post_timer_status;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of local functions                      */
+/*----------------------------------------------------------------------------*/
+
+static uint8_t AppSched_validTimeout( AppSched_Scheduler *scheduler, uint32_t timeout )
+{
+    uint8_t valid;
+
+    if (scheduler -> mode == APPSCHED_MODE_TICKLESS)
+    {
+        valid = (timeout > 0u) ? TRUE : FALSE; /* Timeouts are not rounded to the tick */
+    }
+    else
+    {
+        /* Timeout is larger than the actual tick and multiple */
+        valid = ((timeout > scheduler -> tick) && (timeout % scheduler -> tick == 0u)) ? TRUE : FALSE;
+    }
+
+    return valid;
+}
+
+static uint32_t AppSched_allocTimer( AppSched_Scheduler *scheduler, uint32_t timeout, uint8_t mode )
+{
+    uint32_t alloc_timer_status = FALSE;
+    uint32_t index = TIMER_NONE;
+    AppSched_Timer *newTimer;
+
+    /* A user buffer gets its deadline array with the first timer */
+    if ((scheduler -> timerDeadline == NULL) && (scheduler -> timers > 0u))
+    {
+        scheduler -> timerDeadline = malloc((size_t)scheduler -> timers * sizeof(uint64_t));
+        if (scheduler -> timerDeadline == NULL)
+        {
+            return FALSE;
+        }
+    }
+
+    /* Timeout is larger than the actual tick and multiple */
+    if (AppSched_validTimeout(scheduler, timeout) == TRUE)
+    {
+        if (scheduler -> freeTimer != TIMER_NONE)
+        {
+            /* Reuse the slot of the last destroyed timer, it keeps its generation */
+            index = scheduler -> freeTimer;
+            scheduler -> freeTimer = scheduler -> timerPtr[index].nextFree;
+        }
+        else if ((scheduler -> timersCount < scheduler -> timers) || (AppSched_growTimers(scheduler) == TRUE))
+        {
+            index = scheduler -> timersCount;
+            scheduler -> timerPtr[index].generation = 0u;
+            scheduler -> timersCount++;
+        }
+    }
+
+    if (index != TIMER_NONE)
+    {
+        newTimer = &scheduler -> timerPtr[index];
+        newTimer -> callbackPtr = NULL;
+        newTimer -> ctxCallbackPtr = NULL;
+        newTimer -> ctx = NULL;
+        newTimer -> mode = mode;
+        /* Set the timeout value in milliseconds */
+        newTimer -> timeout = timeout;
+        newTimer -> count = 0;
+        newTimer -> startFlag = FALSE;
+        newTimer -> deadline = 0;
+        newTimer -> due = 0;
+        newTimer -> slack = 0;
+        newTimer -> wheelSlot = WHEEL_IDLE;
+        newTimer -> used = TRUE;
+        AppSched_syncTimer(scheduler, index);
+        /* Returns the slot from 1 on with the generation of the slot on top */
+        alloc_timer_status = ((uint32_t)newTimer -> generation << TIMER_INDEX_BITS) | (index + OFF_SET);
+    }
+
+    return alloc_timer_status;
+}
+
+static AppSched_Timer *AppSched_lookupTimer( AppSched_Scheduler *scheduler, uint32_t timer )
+{
+    AppSched_Timer *found = NULL;
+    uint32_t index = TIMER_SLOT(timer); /* Handle 0 wraps around and fails the range check */
+
+    /* The slot must be in use and still on the generation the handle was created with */
+    if ((index < scheduler -> timersCount) &&
+        (scheduler -> timerPtr[index].used == TRUE) &&
+        (scheduler -> timerPtr[index].generation == (timer >> TIMER_INDEX_BITS)))
+    {
+        found = &scheduler -> timerPtr[index];
+    }
+
+    return found;
+}
+
+static uint8_t AppSched_growTimers( AppSched_Scheduler *scheduler )
+{
+    uint8_t grow_status = FALSE;
+    uint32_t size = (scheduler -> timers == 0u) ? TIMER_GROW_N : scheduler -> timers * 2u;
+    AppSched_Timer *table;
+    uint64_t *deadline;
+
+    /* A user buffer keeps its size, handles only have room for TIMER_INDEX_MASK slots */
+    if ((scheduler -> timersOwned == TRUE) && (scheduler -> timers < TIMER_INDEX_MASK))
+    {
+        if (size > TIMER_INDEX_MASK)
+        {
+            size = TIMER_INDEX_MASK;
+        }
+
+        /* The wheel and the free list link slots by index, they survive the move */
+        table = realloc(scheduler -> timerPtr, (size_t)size * sizeof(AppSched_Timer));
+        if (table != NULL)
+        {
+            scheduler -> timerPtr = table;
+            /* The deadline array follows, the table keeps its old size if it cannot */
+            deadline = realloc(scheduler -> timerDeadline, (size_t)size * sizeof(uint64_t));
+            if (deadline != NULL)
+            {
+                scheduler -> timerDeadline = deadline;
+                scheduler -> timers = size;
+                grow_status = TRUE;
+            }
+        }
+    }
+
+    return grow_status;
+}
+
 /*----------------------------------------------------------------------------*/
 /*                             END OF FILE                                    */
 /*----------------------------------------------------------------------------*/
\ No newline at end of file
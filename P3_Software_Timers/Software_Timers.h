@@ -18,8 +18,16 @@
 /*                             Defines and macros                             */
 /*----------------------------------------------------------------------------*/
 
-#define TIMERS_N                1u       /*!< Number of timers */
+#define TIMERS_N                2u       /*!< Number of timers */
 #define OFF_SET                 1u       /*!< Offset value */
+#define TIMER_INDEX_BITS        22u      /*!< Handle bits for the slot, the rest hold the generation */
+#define TIMER_INDEX_MASK        ((1u << TIMER_INDEX_BITS) - 1u)
+#define TIMER_GEN_MASK          ((1u << (32u - TIMER_INDEX_BITS)) - 1u)
+#define TIMER_GROW_N            16u      /*!< First size of a timer table allocated by the scheduler */
+#define TIMER_NONE              0xFFFFFFFFu /*!< End of the free slot list */
+#define TIMER_NEVER             0xFFFFFFFFFFFFFFFFull /*!< timerDeadline of a stopped or free slot */
+#define TIMER_MODE_AUTO_RELOAD  0u       /*!< The timer starts a new timeout every time it expires */
+#define TIMER_MODE_ONE_SHOT     1u       /*!< The timer stops after it expires, startTimer runs it again */
 
 /*----------------------------------------------------------------------------*/
 /*                                 Data types                                 */
@@ -34,6 +42,19 @@ typedef struct _AppSched_Timer
     uint32_t count;                     /*!< Current timer decrement count */
     uint8_t startFlag;                  /*!< Flag to indicate if the timer is running */
     void (*callbackPtr)(void);          /*!< Pointer to the callback function to be called when the timer expires */
+    void (*ctxCallbackPtr)(void *ctx);  /*!< Callback with context, used instead of callbackPtr when not NULL */
+    void *ctx;                          /*!< Context given to ctxCallbackPtr */
+    uint8_t mode;                       /*!< TIMER_MODE_AUTO_RELOAD or TIMER_MODE_ONE_SHOT */
+    uint64_t deadline;                  /*!< Expiration in ns since the scheduler started (tickless mode) */
+    uint64_t due;                       /*!< Expiration before the slack was applied (tickless mode) */
+    uint32_t slack;                     /*!< Delay in ms the timer accepts to share a wakeup, 0 for none */
+    uint32_t expiry;                    /*!< Wheel tick when the timer expires (timer wheel) */
+    uint32_t wheelNext;                 /*!< Next timer in the same wheel slot */
+    uint32_t wheelPrev;                 /*!< Previous timer in the same wheel slot */
+    uint16_t wheelSlot;                 /*!< Wheel slot holding the timer, WHEEL_IDLE if none */
+    uint16_t generation;                /*!< Incremented when the timer is destroyed, stale handles stop matching */
+    uint8_t used;                       /*!< FALSE while the slot is in the free list */
+    uint32_t nextFree;                  /*!< Next free slot, TIMER_NONE for the last one */
 } AppSched_Timer;
 
 /*----------------------------------------------------------------------------*/
@@ -44,9 +65,9 @@ typedef struct _AppSched_Timer
 extern AppSched_Timer timers[ TIMERS_N ];   /*!< Array of software timers */
 
 /* Declare the Timer IDs as extern */
-extern uint8_t TimerID;
-extern uint8_t TimerID2;
-extern uint8_t TimerID3;
+extern uint32_t TimerID;
+extern uint32_t TimerID2;
+extern uint32_t TimerID3;
 
 /*----------------------------------------------------------------------------*/
 /*                           Declaration of functions                         */
@@ -54,38 +75,179 @@ extern uint8_t TimerID3;
 /**
  * @brief Registers a timer to run within the scheduler
  * 
+ * The timer is auto-reload: once started it expires every timeout until it is stopped.
+ * 
  * @param scheduler Pointer to the scheduler
- * @param timeout Timeout value for the timer
+ * @param timeout Timeout value for the timer in milliseconds, a multiple of the tick in tick mode
  * @param callbackPtr Pointer to the callback function to be called when the timer expires
- * @return uint8_t Status of the timer registration (TRUE if successful, FALSE otherwise)
+ * @return uint32_t Handle of the timer, FALSE (0) if it could not be registered
+ */
+uint32_t AppSched_registerTimer(AppSched_Scheduler *scheduler, uint32_t timeout, void (*callbackPtr)(void));
+
+/**
+ * @brief Creates a stopped timer, reusing the slot of a destroyed timer when there is one
+ * 
+ * Free slots are kept in a list, create and destroy are O(1). With timerPtr set to NULL before
+ * AppSched_initScheduler the scheduler allocates the table and doubles it when it is full,
+ * otherwise the timers are limited to the given buffer.
+ * 
+ * The handle holds the slot plus one in the low TIMER_INDEX_BITS bits and the generation of the
+ * slot in the high bits, so a handle kept after destroy is rejected by every timer function.
+ * 
+ * @param scheduler Pointer to the scheduler
+ * @param timeout Timeout value for the timer in milliseconds, a multiple of the tick in tick mode
+ * @param mode TIMER_MODE_AUTO_RELOAD or TIMER_MODE_ONE_SHOT
+ * @param callbackPtr Function called with ctx when the timer expires
+ * @param ctx Context given to the callback, one callback can serve many timers
+ * @return uint32_t Handle of the timer, FALSE (0) if a parameter is invalid or there is no space
+ */
+uint32_t AppSched_createTimer(AppSched_Scheduler *scheduler, uint32_t timeout, uint8_t mode, void (*callbackPtr)(void *ctx), void *ctx);
+
+/**
+ * @brief Stops a timer and gives its slot back for the next AppSched_createTimer
+ * 
+ * Can be called from the callback of the timer itself.
+ * 
+ * @param scheduler Pointer to the scheduler
+ * @param timer Timer handle
+ * @return uint8_t TRUE if the timer was destroyed, FALSE if the handle is stale or invalid
+ */
+uint8_t AppSched_destroyTimer(AppSched_Scheduler *scheduler, uint32_t timer);
+
+/**
+ * @brief Frees the timer table allocated by the scheduler, nothing is done for a user buffer
+ * 
+ * @param scheduler Pointer to the scheduler, it must not be running
  */
-uint8_t AppSched_registerTimer(AppSched_Scheduler *scheduler, uint32_t timeout, void (*callbackPtr)(void));
+void AppSched_releaseTimers(AppSched_Scheduler *scheduler);
 
 /**
  * @brief Gets the current time remaining for a specified timer
  * 
+ * In tickless mode a running timer reports the time to its deadline at the last wakeup, and a
+ * stopped timer its full timeout, which the next start runs. In tick mode a stopped timer keeps
+ * the time it had left when it was stopped.
+ * 
+ * @param scheduler Pointer to the scheduler
+ * @param timer Timer handle
+ * @return uint32_t Current time remaining for the timer in ms, 0 for a running timer already due,
+ *                  FALSE (0) if the handle is invalid
+ */
+uint32_t AppSched_getTimer(AppSched_Scheduler *scheduler, uint32_t timer);
+
+/**
+ * @brief Reloads a specified timer with a new timeout and starts it
+ * 
  * @param scheduler Pointer to the scheduler
- * @param timer Timer ID
- * @return uint32_t Current time remaining for the timer
+ * @param timer Timer handle
+ * @param timeout New timeout value for the timer in milliseconds
+ * @return uint8_t Status of the timer reload (TRUE if successful, FALSE otherwise)
  */
-uint32_t AppSched_getTimer(AppSched_Scheduler *scheduler, uint8_t timer);
+uint8_t AppSched_reloadTimer(AppSched_Scheduler *scheduler, uint32_t timer, uint32_t timeout);
 
 /**
  * @brief Starts a specified timer
  * 
  * @param scheduler Pointer to the scheduler
- * @param timer Timer ID
+ * @param timer Timer handle
  * @return uint8_t Status of the timer start (TRUE if successful, FALSE otherwise)
  */
-uint8_t AppSched_startTimer(AppSched_Scheduler *scheduler, uint8_t timer);
+uint8_t AppSched_startTimer(AppSched_Scheduler *scheduler, uint32_t timer);
 
 /**
  * @brief Stops a specified timer
  * 
  * @param scheduler Pointer to the scheduler
- * @param timer Timer ID
+ * @param timer Timer handle
  * @return uint8_t Status of the timer stop (TRUE if successful, FALSE otherwise)
  */
-uint8_t AppSched_stopTimer(AppSched_Scheduler *scheduler, uint8_t timer);
+uint8_t AppSched_stopTimer(AppSched_Scheduler *scheduler, uint32_t timer);
+
+/**
+ * @brief Manages the timers with a hierarchical timer wheel (tick mode only)
+ * 
+ * Start, stop and reload become O(1) and a tick only touches the timers that expire on it,
+ * instead of every registered timer. A start always runs a full timeout from the current tick.
+ * 
+ * @param scheduler Pointer to the scheduler
+ * @param wheel Pointer to the wheel, it has to live as long as the scheduler
+ * @return uint8_t TRUE if the wheel is used, FALSE in tickless mode
+ */
+uint8_t AppSched_initWheel(AppSched_Scheduler *scheduler, struct _AppSched_Wheel *wheel);
+
+/**
+ * @brief Sets how late a timer may expire so it can share a wakeup with other timers (tickless mode)
+ * 
+ * The expiration is rounded up to a multiple of the largest power of two nanoseconds not above
+ * the slack. Those boundaries are shared by every timer with the same or a larger slack, so
+ * timers with similar timeouts expire together in one wakeup. Tick mode already wakes up on
+ * every tick, the slack is ignored there. A running timer is moved right away.
+ * 
+ * @param scheduler Pointer to the scheduler
+ * @param timer Timer handle
+ * @param slack Maximum delay in milliseconds, 0 expires exactly on time
+ * @return uint8_t TRUE if the slack was set, FALSE if the handle is stale or invalid
+ */
+uint8_t AppSched_slackTimer(AppSched_Scheduler *scheduler, uint32_t timer, uint32_t slack);
+
+/**
+ * @brief Copies the deadline of a timer slot into the deadline array scanned by tickless mode
+ * 
+ * Called after every change of the deadline or of the startFlag of a timer.
+ * 
+ * @param scheduler Pointer to the scheduler
+ * @param index Slot of the timer
+ */
+void AppSched_syncTimer(AppSched_Scheduler *scheduler, uint32_t index);
+
+/**
+ * @brief Rounds an expiration up to the boundary used to coalesce timers
+ * 
+ * @param due Expiration in ns
+ * @param slack Maximum delay in ns
+ * @return uint64_t Expiration to use, due when the slack is 0
+ */
+uint64_t AppSched_coalesce(uint64_t due, uint64_t slack);
+
+/**
+ * @brief Updates the coalescing statistics for one expiration, scheduler loop only
+ * 
+ * Every expiration time beyond the first one served by the same wakeup, and moved there by
+ * its slack, counts as a wakeup saved. Due times served together only because the loop was
+ * late are not counted. Only SLACK_SEEN_N distinct times are remembered per wakeup, past that every
+ * expiration counts, so wakeupsSaved is an upper bound for very large batches.
+ * 
+ * @param scheduler Pointer to the scheduler
+ * @param deadline Expiration used, after the slack
+ * @param due Expiration without the slack
+ */
+void AppSched_accountSlack(AppSched_Scheduler *scheduler, uint64_t deadline, uint64_t due);
+
+/**
+ * @brief Attaches a timer service so other threads can control the timers
+ * 
+ * The other timer functions are only safe from the scheduler thread (callbacks, tasks running
+ * inline) or before the scheduler starts. Other threads use AppSched_postTimer instead.
+ * 
+ * @param scheduler Pointer to the scheduler
+ * @param service Pointer to the service, it has to live as long as the scheduler
+ * @param deferred TRUE to run the expired callbacks on the worker pool instead of the scheduler thread
+ */
+void AppSched_initService(AppSched_Scheduler *scheduler, struct _AppSvc_Service *service, uint8_t deferred);
+
+/**
+ * @brief Posts a timer command from any thread, the scheduler applies it on its next wakeup
+ * 
+ * Lock-free. In tickless mode the scheduler is woken up to apply the command right away, in tick
+ * mode it is applied on the next tick. A stale handle is only detected when the command is
+ * applied, it is counted in the rejected field of the service.
+ * 
+ * @param scheduler Pointer to the scheduler
+ * @param command SVC_CMD_START, SVC_CMD_STOP, SVC_CMD_RELOAD or SVC_CMD_DESTROY
+ * @param timer Timer handle
+ * @param timeout New timeout in milliseconds for SVC_CMD_RELOAD, ignored otherwise
+ * @return uint8_t TRUE if the command was queued, FALSE if the queue is full
+ */
+uint8_t AppSched_postTimer(AppSched_Scheduler *scheduler, uint32_t command, uint32_t timer, uint32_t timeout);
 
 #endif /* SOFTWARE_TIMERS_H_ */
@@ -0,0 +1,71 @@
+/**
+ * \file       Task_Coroutine.c
+ * \brief      Implementation for the stackless coroutine tasks (protothreads)
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "Scheduler.h"
+#include "Task_Coroutine.h"
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+uint32_t AppSched_registerCoroutine( AppSched_Scheduler *scheduler, AppCo_Thread *co, uint8_t (*coFunc)(AppCo_Thread *co), void *ctx, uint32_t period )
+{
+    uint32_t register_co_status = FALSE;
+    AppSched_Task *task;
+
+    if (coFunc != NULL)
+    {
+        register_co_status = AppSched_registerTask(scheduler, NULL, NULL, period);
+    }
+
+    if (register_co_status != FALSE)
+    {
+        co->line = 0;
+        co->wakeAt = 0;
+        atomic_init(&co->wait, NULL);
+        co->coFunc = coFunc;
+        co->ctx = ctx;
+        co->scheduler = scheduler;
+        co->state = CO_YIELDED;
+        co->slices = 0;
+        co->completed = 0;
+
+        /* Two slices of the same body must never run at the same time */
+        task = AppSched_getTask(scheduler, register_co_status);
+        task->co = co;
+        task->reentrant = FALSE;
+
+        /* The loop looks for signals on the event the body waits for, like for an event task */
+        scheduler->eventsCount++;
+    }
+
+    return register_co_status;
+}
+
+void AppCo_resume( AppCo_Thread *co )
+{
+    co->state = co->coFunc(co);
+    co->slices++;
+    if (co->state == CO_ENDED)
+    {
+        co->completed++;
+    }
+}
+
+uint64_t AppCo_elapsed( AppCo_Thread *co )
+{
+    AppTime_Source *source = co->scheduler->timeSource;
+
+    return source->now(source) - co->scheduler->start;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
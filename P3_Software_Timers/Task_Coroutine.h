@@ -0,0 +1,117 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef TASK_COROUTINE_H_
+#define TASK_COROUTINE_H_
+
+/**
+ * \file       Task_Coroutine.h
+ * \brief      Header file for the stackless coroutine tasks (protothreads).
+ *
+ * A coroutine task is resumed on every release of its period instead of running to completion.
+ * The body yields with the CO_ macros and continues after the same statement on a later release,
+ * so a long job is split into short slices without a thread or a stack of its own. A body waiting
+ * for a queue or an event is also resumed as soon as it is posted or signaled.
+ *
+ * The resume point is a switch on __LINE__, like the protothreads of Adam Dunkels: local variables
+ * are not kept across a yield (keep the state in ctx or in static variables), the body cannot use
+ * switch itself around a CO_ macro, and only one CO_ macro fits on a line.
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "Scheduler.h"
+#include "Task_Event.h"
+
+/*----------------------------------------------------------------------------*/
+/*                             Defines and macros                             */
+/*----------------------------------------------------------------------------*/
+
+#define CO_WAITING              0u          /*!< The body waits for a condition, a delay or a message */
+#define CO_YIELDED              1u          /*!< The body gave the slice back */
+#define CO_ENDED                2u          /*!< The body reached CO_END, the next release starts it again */
+
+/** Opens the body of a coroutine, co is the AppCo_Thread given to the function */
+#define CO_BEGIN(co)            switch ((co)->line) { case 0:
+
+/** Closes the body, the next release runs it again from CO_BEGIN */
+#define CO_END(co)              } (co)->line = 0; return CO_ENDED
+
+/** Gives the slice back, the next release continues after it */
+#define CO_YIELD(co)            do { (co)->line = __LINE__; return CO_YIELDED; case __LINE__:; } while (0)
+
+/** Returns on every release until cond is true */
+#define CO_WAIT_UNTIL(co, cond) do { (co)->line = __LINE__; case __LINE__: if (!(cond)) { return CO_WAITING; } } while (0)
+
+/** Waits at least ms milliseconds, checked on every release */
+#define CO_WAIT_DELAY(co, ms)   do { (co)->wakeAt = AppCo_elapsed(co) + ((uint64_t)(ms) * NS_PER_MS); \
+                                     CO_WAIT_UNTIL(co, AppCo_elapsed(co) >= (co)->wakeAt); } while (0)
+
+/** Waits for a message in the queue of an event and copies it into data, a post resumes the body */
+#define CO_WAIT_QUEUE(co, event, data) do { atomic_store(&(co)->wait, (event)); \
+                                            CO_WAIT_UNTIL(co, AppEvt_readQueue((event), (data)) == TRUE); \
+                                            atomic_store(&(co)->wait, NULL); } while (0)
+
+/** Waits for a signal of a plain event and takes it, a signal resumes the body */
+#define CO_WAIT_EVENT(co, event) do { atomic_store(&(co)->wait, (event)); \
+                                      CO_WAIT_UNTIL(co, AppEvt_takeSignal(event) == TRUE); \
+                                      atomic_store(&(co)->wait, NULL); } while (0)
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Structure to represent a coroutine
+ */
+typedef struct _AppCo_Thread
+{
+    uint32_t line;                          /*!< Resume point, 0 starts the body from CO_BEGIN */
+    uint64_t wakeAt;                        /*!< End of the current CO_WAIT_DELAY in ns since the scheduler started */
+    _Atomic(AppEvt_Event *) wait;           /*!< Event of the current CO_WAIT_QUEUE or CO_WAIT_EVENT, NULL if none */
+    uint8_t (*coFunc)(struct _AppCo_Thread *co); /*!< Body, returns CO_WAITING, CO_YIELDED or CO_ENDED */
+    void *ctx;                              /*!< State kept across the slices, for the body */
+    AppSched_Scheduler *scheduler;          /*!< Scheduler that resumes the coroutine */
+    uint8_t state;                          /*!< Value returned by the last slice */
+    uint32_t slices;                        /*!< Times the body was resumed */
+    uint32_t completed;                     /*!< Times the body reached CO_END */
+} AppCo_Thread;
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Registers a coroutine task, resumed once on every release of its period
+ *
+ * The task is non reentrant, so with a worker pool two slices of the same coroutine never
+ * overlap. The usual task interfaces (stop, start, period, pin, overrun) apply to it. While the
+ * body waits in CO_WAIT_QUEUE or CO_WAIT_EVENT, a post or a signal on that event resumes it on
+ * the next wakeup of the loop instead of the next release. The event must not belong to an
+ * event task.
+ *
+ * @param scheduler Pointer to the scheduler
+ * @param co Pointer to the coroutine, it has to live as long as the scheduler
+ * @param coFunc Body of the coroutine
+ * @param ctx State of the coroutine, available in the body as co->ctx
+ * @param period Time between two slices in milliseconds, like the period of a task
+ * @return uint32_t Task ID, FALSE (0) if there is no space or the period is invalid
+ */
+uint32_t AppSched_registerCoroutine( AppSched_Scheduler *scheduler, AppCo_Thread *co, uint8_t (*coFunc)(AppCo_Thread *co), void *ctx, uint32_t period );
+
+/**
+ * @brief Runs the next slice of a coroutine, called by the scheduler on every release
+ *
+ * @param co Pointer to the coroutine
+ */
+void AppCo_resume( AppCo_Thread *co );
+
+/**
+ * @brief Returns the time elapsed since the scheduler started, safe from the workers
+ *
+ * @param co Pointer to the coroutine
+ * @return uint64_t Nanoseconds since the scheduler started
+ */
+uint64_t AppCo_elapsed( AppCo_Thread *co );
+
+#endif /* TASK_COROUTINE_H_ */
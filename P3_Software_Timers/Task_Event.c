@@ -0,0 +1,112 @@
+/**
+ * \file       Task_Event.c
+ * \brief      Implementation for the events that release the event-driven tasks
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "Scheduler.h"
+#include "Queue.h"
+#include "Task_Event.h"
+#include "Trace.h"
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+void AppEvt_initEvent( AppEvt_Event *event, AppQue_Queue *queue )
+{
+    atomic_init(&event->pending, 0u);
+    event->queue = queue;
+    atomic_flag_clear(&event->lock);
+    atomic_init(&event->dropped, 0u);
+    event->task = FALSE;
+}
+
+void AppSched_signalEvent( AppSched_Scheduler *scheduler, AppEvt_Event *event )
+{
+    AppTime_Source *source = scheduler->timeSource;
+
+    atomic_fetch_add_explicit(&event->pending, 1u, memory_order_release);
+
+    /* Both loops dispatch the event tasks when the sleep ends early */
+    if ((source != NULL) && (source->wake != NULL))
+    {
+        source->wake(source);
+    }
+}
+
+uint8_t AppSched_postQueue( AppSched_Scheduler *scheduler, AppEvt_Event *event, void *data )
+{
+    uint8_t post_queue_status;
+
+    while (atomic_flag_test_and_set_explicit(&event->lock, memory_order_acquire))
+    {
+        /* Held for one copy of a message */
+    }
+    post_queue_status = AppQueue_writeData(event->queue, data);
+    atomic_flag_clear_explicit(&event->lock, memory_order_release);
+
+    if (post_queue_status == TRUE)
+    {
+        AppSched_signalEvent(scheduler, event);
+    }
+    else
+    {
+        atomic_fetch_add_explicit(&event->dropped, 1u, memory_order_relaxed);
+        TRACE_EVENT(TRACE_QUEUE_FULL, event->task, TRACE_QUEUE_EVENT);
+    }
+
+    return post_queue_status;
+}
+
+uint8_t AppEvt_readQueue( AppEvt_Event *event, void *data )
+{
+    uint8_t read_queue_status;
+
+    while (atomic_flag_test_and_set_explicit(&event->lock, memory_order_acquire))
+    {
+        /* Held for one copy of a message */
+    }
+    read_queue_status = AppQueue_readData(event->queue, data);
+    atomic_flag_clear_explicit(&event->lock, memory_order_release);
+
+    return read_queue_status;
+}
+
+uint8_t AppEvt_takeSignal( AppEvt_Event *event )
+{
+    uint32_t pending = atomic_load_explicit(&event->pending, memory_order_acquire);
+
+    do
+    {
+        if (pending == 0u)
+        {
+            return FALSE;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&event->pending, &pending, pending - 1u,
+                                                    memory_order_acquire, memory_order_acquire));
+
+    return TRUE;
+}
+
+uint32_t AppEvt_queueCount( AppEvt_Event *event )
+{
+    uint32_t count;
+
+    while (atomic_flag_test_and_set_explicit(&event->lock, memory_order_acquire))
+    {
+        /* Held for one copy of a message */
+    }
+    count = AppQueue_getCount(event->queue);
+    atomic_flag_clear_explicit(&event->lock, memory_order_release);
+
+    return count;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,94 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef TASK_EVENT_H_
+#define TASK_EVENT_H_
+
+/**
+ * \file       Task_Event.h
+ * \brief      Header file for the events that release the event-driven tasks.
+ *
+ * An event task has no period, the scheduler dispatches it as soon as its event is signaled.
+ * An event is either a plain flag or a queue: AppSched_postQueue writes a message and signals
+ * the event, the task reads the messages back with AppEvt_readQueue. Signals are counted, so
+ * the task runs once per signal, or once for all of them when it batches.
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdatomic.h>
+#include "Scheduler.h"
+#include "Queue.h"
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Structure to represent an event
+ */
+typedef struct _AppEvt_Event
+{
+    _Atomic uint32_t pending;               /*!< Signals not dispatched yet */
+    AppQue_Queue *queue;                    /*!< Queue of the messages, NULL for a plain event flag */
+    atomic_flag lock;                       /*!< Serializes the queue between the producers and the task */
+    _Atomic uint32_t dropped;               /*!< Messages refused because the queue was full */
+    uint32_t task;                          /*!< ID of the event task, set when it is registered, for the trace */
+} AppEvt_Event;
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes an event with nothing pending
+ *
+ * @param event Pointer to the event
+ * @param queue Initialized queue for the messages, NULL for a plain event flag
+ */
+void AppEvt_initEvent( AppEvt_Event *event, AppQue_Queue *queue );
+
+/**
+ * @brief Signals an event and wakes the scheduler, safe from any thread and lock-free
+ *
+ * @param scheduler Pointer to the scheduler
+ * @param event Pointer to the event
+ */
+void AppSched_signalEvent( AppSched_Scheduler *scheduler, AppEvt_Event *event );
+
+/**
+ * @brief Writes a message into the queue of an event and signals it, safe from any thread
+ *
+ * @param scheduler Pointer to the scheduler
+ * @param event Pointer to an event with a queue
+ * @param data Message to copy, queue->Size bytes
+ * @return uint8_t TRUE if the message was queued, FALSE if the queue is full
+ */
+uint8_t AppSched_postQueue( AppSched_Scheduler *scheduler, AppEvt_Event *event, void *data );
+
+/**
+ * @brief Reads the oldest message of the queue of an event, called by the event task
+ *
+ * @param event Pointer to an event with a queue
+ * @param data Where to copy the message, queue->Size bytes
+ * @return uint8_t TRUE if there was a message, FALSE if the queue is empty
+ */
+uint8_t AppEvt_readQueue( AppEvt_Event *event, void *data );
+
+/**
+ * @brief Takes one signal of a plain event, for a coroutine that waits for it instead of a task
+ *
+ * @param event Pointer to an event that does not belong to an event task
+ * @return uint8_t TRUE if a signal was pending and taken, FALSE otherwise
+ */
+uint8_t AppEvt_takeSignal( AppEvt_Event *event );
+
+/**
+ * @brief Counts the messages in the queue of an event, safe from any thread
+ *
+ * @param event Pointer to an event with a queue
+ * @return uint32_t Number of messages not read yet
+ */
+uint32_t AppEvt_queueCount( AppEvt_Event *event );
+
+#endif /* TASK_EVENT_H_ */
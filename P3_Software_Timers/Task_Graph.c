@@ -0,0 +1,110 @@
+/**
+ * \file       Task_Graph.c
+ * \brief      Implementation for the task dependency graph
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "Scheduler.h"
+#include "Task_Graph.h"
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of local functions                       */
+/*----------------------------------------------------------------------------*/
+static uint8_t AppSched_reaches( AppSched_Task *from, AppSched_Task *to );
+#if (APPSCHED_PROFILING == TRUE)
+static void AppSched_dumpPath( AppSched_Task *task, FILE *out );
+#endif
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+uint8_t AppSched_dependTask( AppSched_Scheduler *scheduler, uint32_t task, uint32_t input )
+{
+    uint8_t depend_task_status = FALSE;
+    AppSched_Task *waitTask = AppSched_getTask(scheduler, task);
+    AppSched_Task *inputTask = AppSched_getTask(scheduler, input);
+
+    if ((waitTask != NULL) && (inputTask != NULL) && (waitTask != inputTask))
+    {
+        /* An edge from the task back to its input would never release either of them */
+        if ((waitTask->event == NULL) && (inputTask->outputsCount < DAG_OUTPUTS_N) &&
+            (waitTask->inputs < DAG_INPUTS_N) && (AppSched_reaches(waitTask, inputTask) == FALSE))
+        {
+            inputTask->outputs[inputTask->outputsCount] = waitTask;
+            inputTask->outputBit[inputTask->outputsCount] = waitTask->inputs;
+            inputTask->outputsCount++;
+            waitTask->inputs++;
+            waitTask->reentrant = FALSE;
+            inputTask->reentrant = FALSE;
+            depend_task_status = TRUE;
+        }
+    }
+
+    return depend_task_status;
+}
+
+#if (APPSCHED_PROFILING == TRUE)
+void AppSched_dumpGraph( AppSched_Scheduler *scheduler, FILE *out )
+{
+    AppSched_Task *task;
+
+    for (uint32_t a = 0; a < scheduler->activeCount; a++)
+    {
+        task = scheduler->activePtr[a];
+        if ((task->inputs == 0u) || (task->outputsCount != 0u))
+        {
+            continue;   /* Only the last tasks of a graph end a cycle */
+        }
+
+        fprintf(out, "Graph to task %u: cycles %u, cycle last/avg/max %llu/%llu/%llu ns\n", (unsigned)task->id,
+                (unsigned)task->stats.cycles, (unsigned long long)task->stats.lastCycle,
+                (task->stats.cycles > 0u) ? (unsigned long long)(task->stats.totalCycle / task->stats.cycles) : 0ull,
+                (unsigned long long)task->stats.maxCycle);
+
+        fprintf(out, "    critical path:");
+        AppSched_dumpPath(task, out);
+        fprintf(out, "\n");
+    }
+}
+#endif
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of local functions                      */
+/*----------------------------------------------------------------------------*/
+
+static uint8_t AppSched_reaches( AppSched_Task *from, AppSched_Task *to )
+{
+    uint8_t reaches = (from == to) ? TRUE : FALSE;
+
+    /* Depth first, the graph built so far has no loop so it ends */
+    for (uint8_t o = 0; (o < from->outputsCount) && (reaches == FALSE); o++)
+    {
+        reaches = AppSched_reaches(from->outputs[o], to);
+    }
+
+    return reaches;
+}
+
+#if (APPSCHED_PROFILING == TRUE)
+static void AppSched_dumpPath( AppSched_Task *task, FILE *out )
+{
+    /* Back from the last task to the first one, the graph has no loop. Printed on the way out */
+    if ((task->inputs > 0u) && (task->critical != NULL))
+    {
+        AppSched_dumpPath(task->critical, out);
+        fprintf(out, " ->");
+    }
+
+    fprintf(out, " task %u (wait %llu, exec %llu ns)", (unsigned)task->id,
+            (unsigned long long)(task->begin - task->release), (unsigned long long)(task->end - task->begin));
+}
+#endif
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,57 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef TASK_GRAPH_H_
+#define TASK_GRAPH_H_
+
+/**
+ * \file       Task_Graph.h
+ * \brief      Header file for the task dependency graph.
+ *
+ * A task that depends on other tasks has no release of its own, it runs once all of them
+ * finished. With a worker pool the tasks without a dependency between them run at the same
+ * time, and a finished task hands its dependents straight to the deque of its worker.
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdint.h>
+#include "Scheduler.h"
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Makes a task run after another one on every cycle
+ *
+ * Called before the scheduler starts. The first tasks of the graph keep their period. A task
+ * with several inputs runs once all of them finished since its last run, an input that
+ * finishes twice meanwhile counts once. Both tasks become non reentrant, a cycle that finds
+ * the task still running skips it and counts it in the task skipped field. A skipped or
+ * stopped task still releases the tasks after it, which run with its last results.
+ *
+ * @param scheduler Pointer to the scheduler
+ * @param task ID of the task that waits
+ * @param input ID of the task that has to finish first
+ * @return uint8_t TRUE if the dependency was added, FALSE if an ID is invalid, the task is an
+ *                 event task, input has DAG_OUTPUTS_N dependents already, task has DAG_INPUTS_N
+ *                 inputs already or it would close a loop
+ */
+uint8_t AppSched_dependTask( AppSched_Scheduler *scheduler, uint32_t task, uint32_t input );
+
+#if (APPSCHED_PROFILING == TRUE)
+/**
+ * @brief Writes the cycle time and the critical path of every last task of a graph
+ *
+ * The critical path follows, from the last task back to the first one, the input that
+ * finished last in the latest cycle. For every task it shows the wait between its release
+ * and its start, and its execution time.
+ *
+ * @param scheduler Pointer to the scheduler
+ * @param out Stream to write to, for example stdout or a file
+ */
+void AppSched_dumpGraph( AppSched_Scheduler *scheduler, FILE *out );
+#endif
+
+#endif /* TASK_GRAPH_H_ */
@@ -0,0 +1,252 @@
+/**
+ * \file       Task_Pipeline.c
+ * \brief      Implementation for the pipeline stages with backpressure
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include "Scheduler.h"
+#include "Queue.h"
+#include "Task_Event.h"
+#include "Task_Pipeline.h"
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of local functions                       */
+/*----------------------------------------------------------------------------*/
+static uint8_t AppPipe_isFull( AppPipe_Stage *stage );
+static void AppPipe_resume( AppPipe_Stage *stage );
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+uint32_t AppPipe_registerStage( AppSched_Scheduler *scheduler, AppPipe_Stage *stage, AppQue_Queue *queue,
+                                uint8_t (*process)(void *ctx, const void *in, void *out), void *ctx, uint32_t batch )
+{
+    uint32_t register_stage_status = FALSE;
+    AppSched_Task *task;
+
+    if ((queue != NULL) && (batch > 0u))
+    {
+        AppEvt_initEvent(&stage->input, queue);
+        register_stage_status = AppSched_registerEventTask(scheduler, NULL, NULL, &stage->input, TRUE);
+    }
+
+    if (register_stage_status != FALSE)
+    {
+        stage->upstream = NULL;
+        stage->downstream = NULL;
+        stage->process = process;
+        stage->ctx = ctx;
+        stage->batch = batch;
+        stage->scheduler = scheduler;
+        stage->task = register_stage_status;
+        atomic_init(&stage->suspended, FALSE);
+        memset(&stage->stats, 0, sizeof(stage->stats));
+
+        /* Two runs of the same stage would reorder its messages */
+        task = AppSched_getTask(scheduler, register_stage_status);
+        task->stage = stage;
+        task->reentrant = FALSE;
+    }
+
+    return register_stage_status;
+}
+
+uint8_t AppPipe_connect( AppPipe_Stage *upstream, AppPipe_Stage *downstream )
+{
+    if ((upstream->downstream != NULL) || (downstream->upstream != NULL) || (upstream == downstream))
+    {
+        return FALSE;   /* One writer per input */
+    }
+
+    upstream->downstream = downstream;
+    downstream->upstream = upstream;
+
+    return TRUE;
+}
+
+uint8_t AppPipe_push( AppPipe_Stage *stage, void *data )
+{
+    return AppSched_postQueue(stage->scheduler, &stage->input, data);
+}
+
+void AppPipe_runStage( AppPipe_Stage *stage )
+{
+    AppTime_Source *source = stage->scheduler->timeSource;
+    uint64_t begin = source->now(source);
+    AppPipe_Stage *next = stage->downstream;
+    unsigned char in[PIPE_MESSAGE_SIZE];
+    unsigned char out[PIPE_MESSAGE_SIZE];
+    uint32_t waiting = AppEvt_queueCount(&stage->input);
+    uint32_t done = 0;
+    uint8_t blocked = FALSE;
+    uint8_t emit;
+
+    stage->stats.dispatches++;
+    stage->stats.totalOccupancy += waiting;
+    if (waiting > stage->stats.maxOccupancy)
+    {
+        stage->stats.maxOccupancy = waiting;
+    }
+
+    while (done < stage->batch)
+    {
+        if ((next != NULL) && (AppPipe_isFull(next) == TRUE))
+        {
+            /* Raised before the second look, so the next stage either sees the flag after its
+               reads or made room before that look */
+            atomic_store(&stage->suspended, TRUE);
+            atomic_thread_fence(memory_order_seq_cst);
+            if (AppPipe_isFull(next) == TRUE)
+            {
+                blocked = TRUE;
+                break;
+            }
+            atomic_store(&stage->suspended, FALSE);
+        }
+
+        if (AppEvt_readQueue(&stage->input, in) == FALSE)
+        {
+            break;
+        }
+        done++;
+
+        if (stage->process == NULL)
+        {
+            memcpy(out, in, stage->input.queue->Size);
+            emit = TRUE;
+        }
+        else
+        {
+            emit = stage->process(stage->ctx, in, out);
+        }
+
+        /* Only this stage writes the next input, the room checked above is still there */
+        if ((emit == TRUE) && (next != NULL) && (AppSched_postQueue(next->scheduler, &next->input, out) == TRUE))
+        {
+            stage->stats.emitted++;
+        }
+    }
+
+    stage->stats.processed += done;
+    if (blocked == TRUE)
+    {
+        stage->stats.suspensions++;     /* The next stage resumes it, the signals wait until then */
+    }
+    else if ((done == stage->batch) && (AppEvt_queueCount(&stage->input) > 0u))
+    {
+        AppSched_signalEvent(stage->scheduler, &stage->input);  /* Rest of the input in the next run */
+    }
+
+    if ((done > 0u) && (stage->upstream != NULL))
+    {
+        AppPipe_resume(stage);
+    }
+
+    stage->stats.busyTime += source->now(source) - begin;
+}
+
+uint32_t AppPipe_occupancy( AppPipe_Stage *stage )
+{
+    return AppEvt_queueCount(&stage->input);
+}
+
+void AppPipe_resetStats( AppPipe_Stage *stage )
+{
+    for (; stage != NULL; stage = stage->downstream)
+    {
+        memset(&stage->stats, 0, sizeof(stage->stats));
+    }
+}
+
+void AppPipe_dumpStats( AppPipe_Stage *stage, uint64_t elapsed, FILE *out, uint8_t format )
+{
+    AppPipe_Stage *slowest = NULL;
+    uint64_t slowestTime = 0;
+    uint64_t perMessage;
+    unsigned n = 1;
+
+    /* The slowest stage spends the most time on one message */
+    for (AppPipe_Stage *s = stage; s != NULL; s = s->downstream)
+    {
+        perMessage = (s->stats.processed > 0u) ? (s->stats.busyTime / s->stats.processed) : 0u;
+        if (perMessage > slowestTime)
+        {
+            slowestTime = perMessage;
+            slowest = s;
+        }
+    }
+
+    if (format == PROF_FORMAT_CSV)
+    {
+        fprintf(out, "stage,task,dispatches,processed,emitted,msg_per_s,busy_ns_per_msg,busy_pct,"
+                     "avg_occupancy,max_occupancy,capacity,suspensions,slowest\n");
+    }
+
+    for (; stage != NULL; stage = stage->downstream, n++)
+    {
+        AppPipe_StageStats *stats = &stage->stats;
+        double rate = (elapsed > 0u) ? ((double)stats->processed * 1e9 / (double)elapsed) : 0.0;
+        double busy = (elapsed > 0u) ? ((double)stats->busyTime * 100.0 / (double)elapsed) : 0.0;
+        double occupancy = (stats->dispatches > 0u) ? ((double)stats->totalOccupancy / stats->dispatches) : 0.0;
+
+        perMessage = (stats->processed > 0u) ? (stats->busyTime / stats->processed) : 0u;
+        if (format == PROF_FORMAT_CSV)
+        {
+            fprintf(out, "%u,%u,%u,%u,%u,%.0f,%llu,%.1f,%.1f,%u,%u,%u,%u\n", n, (unsigned)stage->task,
+                    (unsigned)stats->dispatches, (unsigned)stats->processed, (unsigned)stats->emitted, rate,
+                    (unsigned long long)perMessage, busy, occupancy, (unsigned)stats->maxOccupancy,
+                    (unsigned)stage->input.queue->Elements, (unsigned)stats->suspensions, (stage == slowest) ? 1u : 0u);
+        }
+        else
+        {
+            fprintf(out, "Stage %u (task %u): processed %u in %u runs, %.0f msg/s, busy %llu ns/msg %.1f %%, "
+                         "input avg/max %.1f/%u of %u, suspended %u%s\n", n, (unsigned)stage->task,
+                    (unsigned)stats->processed, (unsigned)stats->dispatches, rate, (unsigned long long)perMessage,
+                    busy, occupancy, (unsigned)stats->maxOccupancy, (unsigned)stage->input.queue->Elements,
+                    (unsigned)stats->suspensions, (stage == slowest) ? ", slowest" : "");
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of local functions                      */
+/*----------------------------------------------------------------------------*/
+
+static uint8_t AppPipe_isFull( AppPipe_Stage *stage )
+{
+    return (AppEvt_queueCount(&stage->input) >= stage->input.queue->Elements) ? TRUE : FALSE;
+}
+
+static void AppPipe_resume( AppPipe_Stage *stage )
+{
+    AppPipe_Stage *previous = stage->upstream;
+
+    /* Pairs with the fence of the suspended stage, after the reads of this run */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&previous->suspended, memory_order_relaxed) == FALSE)
+    {
+        return;
+    }
+
+    /* Half a queue of room, so the previous stage does not stop again after one message. An
+       input still fuller than that keeps this stage running until it is not */
+    if (AppEvt_queueCount(&stage->input) > (stage->input.queue->Elements / 2u))
+    {
+        return;
+    }
+
+    if (atomic_exchange(&previous->suspended, FALSE) == TRUE)
+    {
+        AppSched_signalEvent(previous->scheduler, &previous->input);
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,142 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef TASK_PIPELINE_H_
+#define TASK_PIPELINE_H_
+
+/**
+ * \file       Task_Pipeline.h
+ * \brief      Header file for the pipeline stages with backpressure.
+ *
+ * A stage is an event task with an input queue, a function that turns one input message into
+ * at most one output message, and the input queue of the next stage as its output. A stage
+ * that finds its output full is suspended: the scheduler keeps its signals without
+ * dispatching it, and the next stage resumes it once its input is back to half full, so no
+ * message is dropped between two stages. A dispatch processes up to a batch of messages.
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "Scheduler.h"
+#include "Queue.h"
+#include "Task_Event.h"
+#include "Task_Profiling.h"
+
+/*----------------------------------------------------------------------------*/
+/*                             Defines and macros                             */
+/*----------------------------------------------------------------------------*/
+
+#define PIPE_MESSAGE_SIZE       256u        /*!< Largest queue element, the Size of a queue is 8 bits */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Structure with the counters of a stage, all the times in nanoseconds.
+ */
+typedef struct _AppPipe_StageStats
+{
+    uint32_t dispatches;                /*!< Runs of the stage */
+    uint32_t processed;                 /*!< Messages read from the input */
+    uint32_t emitted;                   /*!< Messages written to the output */
+    uint32_t suspensions;               /*!< Runs that stopped because the output was full */
+    uint64_t busyTime;                  /*!< Time spent in the runs */
+    uint32_t maxOccupancy;              /*!< Most messages found in the input at the start of a run */
+    uint64_t totalOccupancy;            /*!< Sum of the messages found at the start of the runs, for the average */
+} AppPipe_StageStats;
+
+/**
+ * @brief Structure to represent a stage
+ */
+typedef struct _AppPipe_Stage
+{
+    AppEvt_Event input;                 /*!< Messages to process, signaled by the previous stage */
+    struct _AppPipe_Stage *upstream;    /*!< Previous stage, resumed when the input has room again */
+    struct _AppPipe_Stage *downstream;  /*!< Next stage, its input is the output, NULL for the last stage */
+    uint8_t (*process)(void *ctx, const void *in, void *out); /*!< Returns TRUE to send out downstream */
+    void *ctx;                          /*!< Given to process */
+    uint32_t batch;                     /*!< Most messages processed in one run */
+    AppSched_Scheduler *scheduler;      /*!< Scheduler of the event task */
+    uint32_t task;                      /*!< Task ID of the stage */
+    _Atomic uint8_t suspended;          /*!< TRUE while the stage waits for room downstream */
+    AppPipe_StageStats stats;           /*!< Updated by the stage only, it never runs twice at a time */
+} AppPipe_Stage;
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Registers a stage as a non reentrant event task on its input
+ *
+ * @param scheduler Pointer to the scheduler
+ * @param stage Pointer to the stage
+ * @param queue Initialized input queue, its length bounds the messages waiting for the stage
+ * @param process Function called once per input message, NULL to forward the message as is
+ * @param ctx Given to process
+ * @param batch Most messages processed in one run, at least 1
+ * @return uint32_t Task ID of the stage, FALSE if it could not be registered
+ */
+uint32_t AppPipe_registerStage( AppSched_Scheduler *scheduler, AppPipe_Stage *stage, AppQue_Queue *queue,
+                                uint8_t (*process)(void *ctx, const void *in, void *out), void *ctx, uint32_t batch );
+
+/**
+ * @brief Makes the input of a stage the output of another, before the scheduler starts
+ *
+ * The input of a stage is written by one stage only, so the room seen by its writer cannot be
+ * taken by somebody else before the write.
+ *
+ * @param upstream Pointer to the stage that writes
+ * @param downstream Pointer to the stage that reads, its queue Size is the one of the output messages
+ * @return uint8_t TRUE if the stages were connected, FALSE if one of them is already connected that way
+ */
+uint8_t AppPipe_connect( AppPipe_Stage *upstream, AppPipe_Stage *downstream );
+
+/**
+ * @brief Writes a message into the input of the first stage, safe from one producer thread
+ *
+ * @param stage Pointer to the first stage
+ * @param data Message to copy, queue->Size bytes
+ * @return uint8_t TRUE if the message was queued, FALSE if the input is full, the producer slows down
+ */
+uint8_t AppPipe_push( AppPipe_Stage *stage, void *data );
+
+/**
+ * @brief Processes up to a batch of input messages, called by the scheduler for the stage task
+ *
+ * @param stage Pointer to the stage
+ */
+void AppPipe_runStage( AppPipe_Stage *stage );
+
+/**
+ * @brief Returns the messages waiting in the input of a stage
+ *
+ * @param stage Pointer to the stage
+ * @return uint32_t Messages in the input queue
+ */
+uint32_t AppPipe_occupancy( AppPipe_Stage *stage );
+
+/**
+ * @brief Sets the counters of every stage of a pipeline back to zero
+ *
+ * @param stage Pointer to the first stage, the others are found through downstream
+ */
+void AppPipe_resetStats( AppPipe_Stage *stage );
+
+/**
+ * @brief Writes the throughput and the input occupancy of every stage of a pipeline
+ *
+ * The stage with the most busy time per message is the slowest one, the stages before it
+ * show full inputs and suspensions, the ones after it empty inputs.
+ *
+ * @param stage Pointer to the first stage, the others are found through downstream
+ * @param elapsed Time the counters cover in ns, for the throughput
+ * @param out Stream to write to
+ * @param format PROF_FORMAT_TEXT or PROF_FORMAT_CSV
+ */
+void AppPipe_dumpStats( AppPipe_Stage *stage, uint64_t elapsed, FILE *out, uint8_t format );
+
+#endif /* TASK_PIPELINE_H_ */
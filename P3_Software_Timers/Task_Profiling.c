@@ -0,0 +1,289 @@
+/**
+ * \file       Task_Profiling.c
+ * \brief      Implementation for the per task runtime profiling
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include "Scheduler.h"
+#include "Task_Profiling.h"
+
+#if (APPSCHED_PROFILING == TRUE)
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of local functions                       */
+/*----------------------------------------------------------------------------*/
+static uint8_t AppSched_bucket( uint64_t time );
+static void AppSched_lockStats( AppSched_Task *task );
+static void AppSched_unlockStats( AppSched_Task *task );
+static void AppSched_dumpTimerGroup( FILE *out, uint8_t format, const char *name, const AppSched_TimerStats *stats );
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+void AppSched_profileTask( AppSched_Scheduler *scheduler, AppSched_Task *task, uint64_t begin, uint64_t end )
+{
+    AppSched_TaskStats *stats = &task->stats;
+    uint64_t time = end - begin;
+    uint64_t started = begin - scheduler->start;     /* Same time base as the release */
+    uint64_t jitter = (started > task->release) ? (started - task->release) : 0u;
+
+    AppSched_lockStats(task);
+    if ((stats->calls == 0u) || (time < stats->minTime))
+    {
+        stats->minTime = time;
+    }
+    if (time > stats->maxTime)
+    {
+        stats->maxTime = time;
+    }
+    if (jitter > stats->maxJitter)
+    {
+        stats->maxJitter = jitter;
+    }
+    stats->totalTime += time;
+    stats->totalJitter += jitter;
+    stats->histogram[AppSched_bucket(time)]++;
+    stats->calls++;
+
+    /* Times of the run in the graph, the first task of a cycle is its own origin */
+    task->begin = started;
+    task->end = end - scheduler->start;
+    if (task->inputs == 0u)
+    {
+        task->origin = task->release;
+    }
+    else if (task->outputsCount == 0u)
+    {
+        /* Last task of a graph, the cycle ends here */
+        stats->lastCycle = task->end - task->origin;
+        if (stats->lastCycle > stats->maxCycle)
+        {
+            stats->maxCycle = stats->lastCycle;
+        }
+        stats->totalCycle += stats->lastCycle;
+        stats->cycles++;
+    }
+
+    /* The run is an overrun when it ends after the next release of the same task, event tasks have none */
+    if ((task->period > 0u) && ((end - scheduler->start) > (task->release + (uint64_t)task->period * NS_PER_MS)))
+    {
+        stats->overruns++;
+    }
+    AppSched_unlockStats(task);
+}
+
+uint8_t AppSched_getTaskStats( AppSched_Scheduler *scheduler, uint32_t task, AppSched_TaskStats *stats )
+{
+    uint8_t get_stats_status;
+    AppSched_Task *statsTask = AppSched_getTask(scheduler, task);
+
+    if (statsTask != NULL)
+    {
+        AppSched_lockStats(statsTask);
+        *stats = statsTask->stats;
+        AppSched_unlockStats(statsTask);
+        get_stats_status = TRUE;
+    }
+    else
+    {
+        get_stats_status = FALSE;
+    }
+
+    return get_stats_status;
+}
+
+void AppSched_resetTaskStats( AppSched_Scheduler *scheduler )
+{
+    for (uint32_t a = 0; a < scheduler->activeCount; a++)
+    {
+        AppSched_lockStats(scheduler->activePtr[a]);
+        memset(&scheduler->activePtr[a]->stats, 0, sizeof(AppSched_TaskStats));
+        AppSched_unlockStats(scheduler->activePtr[a]);
+    }
+}
+
+void AppSched_dumpTaskStats( AppSched_Scheduler *scheduler, FILE *out, uint8_t format )
+{
+    if (format == PROF_FORMAT_CSV)
+    {
+        fprintf(out, "task,calls,min_ns,avg_ns,max_ns,avg_jitter_ns,max_jitter_ns,overruns");
+        for (uint8_t n = 0; n < PROF_BUCKETS_N; n++)
+        {
+            fprintf(out, ",le_2^%u", (unsigned)(n + 1u));
+        }
+        fprintf(out, "\n");
+    }
+
+    for (uint32_t a = 0; a < scheduler->activeCount; a++)
+    {
+        AppSched_TaskStats copy;
+        AppSched_TaskStats *stats = &copy;
+        unsigned id = (unsigned)scheduler->activePtr[a]->id;
+        unsigned long long avgTime;
+        unsigned long long avgJitter;
+
+        /* A copy, so a worker ending a run does not change the numbers while they are printed */
+        AppSched_lockStats(scheduler->activePtr[a]);
+        copy = scheduler->activePtr[a]->stats;
+        AppSched_unlockStats(scheduler->activePtr[a]);
+        avgTime = (stats->calls > 0u) ? (stats->totalTime / stats->calls) : 0u;
+        avgJitter = (stats->calls > 0u) ? (stats->totalJitter / stats->calls) : 0u;
+
+        if (format == PROF_FORMAT_CSV)
+        {
+            fprintf(out, "%u,%u,%llu,%llu,%llu,%llu,%llu,%u", id, (unsigned)stats->calls,
+                    (unsigned long long)stats->minTime, avgTime, (unsigned long long)stats->maxTime,
+                    avgJitter, (unsigned long long)stats->maxJitter, (unsigned)stats->overruns);
+            for (uint8_t n = 0; n < PROF_BUCKETS_N; n++)
+            {
+                fprintf(out, ",%u", (unsigned)stats->histogram[n]);
+            }
+            fprintf(out, "\n");
+        }
+        else
+        {
+            fprintf(out, "Task %u: calls %u, exec min/avg/max %llu/%llu/%llu ns, jitter avg/max %llu/%llu ns, overruns %u\n",
+                    id, (unsigned)stats->calls, (unsigned long long)stats->minTime, avgTime,
+                    (unsigned long long)stats->maxTime, avgJitter, (unsigned long long)stats->maxJitter,
+                    (unsigned)stats->overruns);
+            for (uint8_t n = 0; n < PROF_BUCKETS_N; n++)
+            {
+                if (stats->histogram[n] != 0u)
+                {
+                    fprintf(out, "    < 2^%-2u ns: %u\n", (unsigned)(n + 1u), (unsigned)stats->histogram[n]);
+                }
+            }
+        }
+    }
+}
+
+void AppSched_profileTimer( AppSched_Scheduler *scheduler, AppSched_TimerStats *stats, uint64_t due, uint64_t timeout, uint64_t begin, uint64_t end )
+{
+    uint64_t fired = begin - scheduler->start;      /* Same time base as the expiry */
+    uint64_t late = (fired > due) ? (fired - due) : 0u;
+    uint64_t time = end - begin;
+
+    if (late > stats->maxLate)
+    {
+        stats->maxLate = late;
+    }
+    if (time > stats->maxCallback)
+    {
+        stats->maxCallback = time;
+    }
+    stats->totalLate += late;
+    stats->totalCallback += time;
+    stats->histogram[AppSched_bucket(late)]++;
+    stats->expirations++;
+
+    /* The next expiration of the same timer was already due when this one ran */
+    if (late >= timeout)
+    {
+        stats->missed++;
+    }
+}
+
+void AppSched_resetTimerStats( AppSched_Scheduler *scheduler )
+{
+    memset(&scheduler->timerStats, 0, sizeof(AppSched_TimerStats));
+    memset(&scheduler->hresStats, 0, sizeof(AppSched_TimerStats));
+}
+
+void AppSched_dumpTimerStats( AppSched_Scheduler *scheduler, FILE *out, uint8_t format )
+{
+    if (format == PROF_FORMAT_CSV)
+    {
+        fprintf(out, "timers,expirations,avg_late_ns,max_late_ns,missed,avg_callback_ns,max_callback_ns");
+        for (uint8_t n = 0; n < PROF_BUCKETS_N; n++)
+        {
+            fprintf(out, ",le_2^%u", (unsigned)(n + 1u));
+        }
+        fprintf(out, "\n");
+    }
+
+    AppSched_dumpTimerGroup(out, format, "software", &scheduler->timerStats);
+    if (scheduler->hres != NULL)
+    {
+        AppSched_dumpTimerGroup(out, format, "highres", &scheduler->hresStats);
+    }
+
+    if (format != PROF_FORMAT_CSV)
+    {
+        fprintf(out, "Slack: coalesced %u, added %llu ns, wakeups saved %u\n", (unsigned)scheduler->coalesced,
+                (unsigned long long)scheduler->slackDelay, (unsigned)scheduler->wakeupsSaved);
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of local functions                      */
+/*----------------------------------------------------------------------------*/
+
+static void AppSched_dumpTimerGroup( FILE *out, uint8_t format, const char *name, const AppSched_TimerStats *stats )
+{
+    unsigned long long avgLate = (stats->expirations > 0u) ? (stats->totalLate / stats->expirations) : 0u;
+    unsigned long long avgCallback = (stats->expirations > 0u) ? (stats->totalCallback / stats->expirations) : 0u;
+
+    if (format == PROF_FORMAT_CSV)
+    {
+        fprintf(out, "%s,%u,%llu,%llu,%u,%llu,%llu", name, (unsigned)stats->expirations, avgLate,
+                (unsigned long long)stats->maxLate, (unsigned)stats->missed, avgCallback,
+                (unsigned long long)stats->maxCallback);
+        for (uint8_t n = 0; n < PROF_BUCKETS_N; n++)
+        {
+            fprintf(out, ",%u", (unsigned)stats->histogram[n]);
+        }
+        fprintf(out, "\n");
+    }
+    else
+    {
+        fprintf(out, "Timers %s: expirations %u, late avg/max %llu/%llu ns, missed %u, callback avg/max %llu/%llu ns\n",
+                name, (unsigned)stats->expirations, avgLate, (unsigned long long)stats->maxLate,
+                (unsigned)stats->missed, avgCallback, (unsigned long long)stats->maxCallback);
+        for (uint8_t n = 0; n < PROF_BUCKETS_N; n++)
+        {
+            if (stats->histogram[n] != 0u)
+            {
+                fprintf(out, "    < 2^%-2u ns: %u\n", (unsigned)(n + 1u), (unsigned)stats->histogram[n]);
+            }
+        }
+    }
+}
+
+static void AppSched_lockStats( AppSched_Task *task )
+{
+    while (atomic_flag_test_and_set_explicit(&task->statsLock, memory_order_acquire))
+    {
+        /* Held for one update of the statistics */
+    }
+}
+
+static void AppSched_unlockStats( AppSched_Task *task )
+{
+    atomic_flag_clear_explicit(&task->statsLock, memory_order_release);
+}
+
+static uint8_t AppSched_bucket( uint64_t time )
+{
+    uint8_t bucket = 0;
+
+    /* Position of the highest bit set, the last bucket also takes everything longer */
+    while ((time > 1u) && (bucket < (PROF_BUCKETS_N - 1u)))
+    {
+        time >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+#endif /* APPSCHED_PROFILING */
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
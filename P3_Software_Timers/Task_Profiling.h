@@ -0,0 +1,104 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef TASK_PROFILING_H_
+#define TASK_PROFILING_H_
+
+/**
+ * \file       Task_Profiling.h
+ * \brief      Header file for the per task runtime profiling.
+ *
+ * Also measures how late the timers expire, to choose the tick or the move to the tickless mode.
+ * Everything in this module is compiled only when APPSCHED_PROFILING is TRUE,
+ * for example with gcc -DAPPSCHED_PROFILING=1u (see make profile).
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdint.h>
+#include "Scheduler.h"
+
+/*----------------------------------------------------------------------------*/
+/*                             Defines and macros                             */
+/*----------------------------------------------------------------------------*/
+
+#define PROF_FORMAT_TEXT        0u       /*!< Human readable dump */
+#define PROF_FORMAT_CSV         1u       /*!< One CSV line per task or timer group, with a header line */
+
+#if (APPSCHED_PROFILING == TRUE)
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Records one run of a task, called by the scheduler after the task function returns
+ * 
+ * @param scheduler Pointer to the scheduler
+ * @param task Pointer to the task that ran, its release field holds the ideal release
+ * @param begin Monotonic time in ns when the task function was called
+ * @param end Monotonic time in ns when the task function returned
+ */
+void AppSched_profileTask(AppSched_Scheduler *scheduler, AppSched_Task *task, uint64_t begin, uint64_t end);
+
+/**
+ * @brief Copies the statistics of a task
+ * 
+ * @param scheduler Pointer to the scheduler
+ * @param task Task ID
+ * @param stats Pointer to the structure that receives the statistics
+ * @return uint8_t TRUE if the task is registered, FALSE otherwise
+ */
+uint8_t AppSched_getTaskStats(AppSched_Scheduler *scheduler, uint32_t task, AppSched_TaskStats *stats);
+
+/**
+ * @brief Clears the statistics of every registered task
+ * 
+ * @param scheduler Pointer to the scheduler
+ */
+void AppSched_resetTaskStats(AppSched_Scheduler *scheduler);
+
+/**
+ * @brief Writes the statistics of every registered task
+ * 
+ * Can be called from a periodic task to get a report every period.
+ * 
+ * @param scheduler Pointer to the scheduler
+ * @param out Stream to write to, for example stdout or a file
+ * @param format PROF_FORMAT_TEXT or PROF_FORMAT_CSV
+ */
+void AppSched_dumpTaskStats(AppSched_Scheduler *scheduler, FILE *out, uint8_t format);
+
+/**
+ * @brief Records one timer expiration, called by the scheduler around the timer callback
+ * 
+ * @param scheduler Pointer to the scheduler
+ * @param stats Statistics of the software or of the high resolution timers
+ * @param due Intended expiry in ns since the scheduler started, before the slack
+ * @param timeout Timeout of the timer in ns, an expiry this late missed the next one too
+ * @param begin Monotonic time in ns when the callback was called
+ * @param end Monotonic time in ns when the callback returned, begin if it went to the pool
+ */
+void AppSched_profileTimer(AppSched_Scheduler *scheduler, AppSched_TimerStats *stats, uint64_t due, uint64_t timeout, uint64_t begin, uint64_t end);
+
+/**
+ * @brief Clears the statistics of the software and high resolution timers
+ * 
+ * @param scheduler Pointer to the scheduler
+ */
+void AppSched_resetTimerStats(AppSched_Scheduler *scheduler);
+
+/**
+ * @brief Writes the expiry statistics of the software and high resolution timers
+ * 
+ * The text format also reports the expirations moved by their slack and the wakeups saved.
+ * 
+ * @param scheduler Pointer to the scheduler
+ * @param out Stream to write to, for example stdout or a file
+ * @param format PROF_FORMAT_TEXT or PROF_FORMAT_CSV
+ */
+void AppSched_dumpTimerStats(AppSched_Scheduler *scheduler, FILE *out, uint8_t format);
+
+#endif /* APPSCHED_PROFILING */
+
+#endif /* TASK_PROFILING_H_ */
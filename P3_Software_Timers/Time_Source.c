@@ -0,0 +1,251 @@
+/**
+ * \file       Time_Source.c
+ * \brief      Implementation for the scheduler Time Sources
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+#include "Time_Source.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define TSC_FRACTION_BITS       32u         /* Fraction bits of tscMult */
+#define TSC_INVARIANT           (1u << 8)   /* CPUID 0x80000007 EDX, the TSC rate never changes */
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of local functions                       */
+/*----------------------------------------------------------------------------*/
+static uint64_t AppTime_monotonicNow( AppTime_Source *source );
+static void AppTime_monotonicSleep( AppTime_Source *source, uint64_t deadline );
+static void AppTime_monotonicWake( AppTime_Source *source );
+static void AppTime_futexSleep( AppTime_Source *source, uint64_t deadline );
+static uint64_t AppTime_coarseNow( AppTime_Source *source );
+static void AppTime_coarseSleep( AppTime_Source *source, uint64_t deadline );
+static uint64_t AppTime_tscNow( AppTime_Source *source );
+static void AppTime_tscSleep( AppTime_Source *source, uint64_t deadline );
+static uint64_t AppTime_readClock( clockid_t clock );
+static uint64_t AppTime_virtualNow( AppTime_Source *source );
+static void AppTime_virtualSleep( AppTime_Source *source, uint64_t deadline );
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of Global Variables                      */
+/*----------------------------------------------------------------------------*/
+
+AppTime_Source AppTime_monotonic = { AppTime_monotonicNow, AppTime_monotonicSleep, AppTime_monotonicWake, 0u, 0u, 0u, 0u, 1u, 0u, 0u, 0u };
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+void AppTime_initMonotonic( AppTime_Source *source )
+{
+    source->now = AppTime_monotonicNow;
+    source->sleepUntil = AppTime_monotonicSleep;
+    source->wake = AppTime_monotonicWake;
+    source->current = 0;
+    atomic_init(&source->wakeSeq, 0u);
+    source->wakeSeen = 0;
+    atomic_init(&source->sleeping, 0u);
+    source->resolution = 1;
+    source->tscBase = 0;
+    source->tscOffset = 0;
+    source->tscMult = 0;
+}
+
+void AppTime_initCoarse( AppTime_Source *source )
+{
+    struct timespec res;
+
+    AppTime_initMonotonic(source);
+    source->now = AppTime_coarseNow;
+    source->sleepUntil = AppTime_coarseSleep;
+    clock_getres(CLOCK_MONOTONIC_COARSE, &res);
+    source->resolution = ((uint64_t)res.tv_sec * 1000000000ull) + (uint64_t)res.tv_nsec;
+}
+
+uint8_t AppTime_initTsc( AppTime_Source *source, uint64_t calibration )
+{
+    uint8_t init_tsc_status = 0u;
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t eax;
+    uint32_t ebx;
+    uint32_t ecx;
+    uint32_t edx;
+    uint64_t tsc;
+    uint64_t mono;
+#endif
+
+    AppTime_initMonotonic(source);
+
+#if defined(__x86_64__) || defined(__i386__)
+    /* A TSC that follows the CPU frequency cannot be scaled by one calibration */
+    if ((calibration > 0u) && (calibration < (1ull << TSC_FRACTION_BITS)) &&
+        (__get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx) != 0) && ((edx & TSC_INVARIANT) != 0u))
+    {
+        mono = AppTime_readClock(CLOCK_MONOTONIC);
+        tsc = __rdtsc();
+        while (AppTime_readClock(CLOCK_MONOTONIC) < (mono + calibration))
+        {
+            /* Busy, a sleep would end at a random point of the kernel tick */
+        }
+        source->tscOffset = AppTime_readClock(CLOCK_MONOTONIC);
+        source->tscBase = __rdtsc();
+
+        if (source->tscBase > tsc)
+        {
+            source->tscMult = ((source->tscOffset - mono) << TSC_FRACTION_BITS) / (source->tscBase - tsc);
+            source->now = AppTime_tscNow;
+            source->sleepUntil = AppTime_tscSleep;
+            source->resolution = (source->tscMult >> TSC_FRACTION_BITS) + 1u;
+            init_tsc_status = 1u;
+        }
+    }
+#else
+    (void)calibration;
+#endif
+
+    return init_tsc_status;
+}
+
+void AppTime_initVirtual( AppTime_Source *source, uint64_t start )
+{
+    source->now = AppTime_virtualNow;
+    source->sleepUntil = AppTime_virtualSleep;
+    source->wake = NULL;    /* The virtual source never blocks */
+    source->current = start;
+    source->resolution = 0;
+}
+
+void AppTime_advance( AppTime_Source *source, uint64_t delta )
+{
+    source->current += delta;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of local functions                      */
+/*----------------------------------------------------------------------------*/
+
+static uint64_t AppTime_monotonicNow( AppTime_Source *source )
+{
+    (void)source;
+    return AppTime_readClock(CLOCK_MONOTONIC);
+}
+
+static void AppTime_monotonicSleep( AppTime_Source *source, uint64_t deadline )
+{
+    AppTime_futexSleep(source, deadline);
+}
+
+static void AppTime_monotonicWake( AppTime_Source *source )
+{
+    atomic_fetch_add(&source->wakeSeq, 1u);
+
+    /* The system call is only needed while the scheduler thread is really sleeping */
+    if (atomic_load(&source->sleeping) != 0u)
+    {
+        syscall(SYS_futex, &source->wakeSeq, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, 1, NULL, NULL, 0);
+    }
+}
+
+static void AppTime_futexSleep( AppTime_Source *source, uint64_t deadline )
+{
+    struct timespec ts;
+    uint32_t seen = source->wakeSeen;
+
+    ts.tv_sec = (time_t)(deadline / 1000000000ull);
+    ts.tv_nsec = (long)(deadline % 1000000000ull);
+
+    /* Absolute sleep on CLOCK_MONOTONIC and the wake counter, a wake since the last sleep returned
+       ends it right away. An interruption by a signal just sleeps again for the remaining time */
+    atomic_store(&source->sleeping, 1u);
+    while (atomic_load(&source->wakeSeq) == seen)
+    {
+        if ((syscall(SYS_futex, &source->wakeSeq, FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG, seen, &ts, NULL,
+                     FUTEX_BITSET_MATCH_ANY) == -1) && (errno == ETIMEDOUT))
+        {
+            break;
+        }
+    }
+    atomic_store(&source->sleeping, 0u);
+    source->wakeSeen = atomic_load(&source->wakeSeq);
+}
+
+static uint64_t AppTime_coarseNow( AppTime_Source *source )
+{
+    (void)source;
+    return AppTime_readClock(CLOCK_MONOTONIC_COARSE);
+}
+
+static void AppTime_coarseSleep( AppTime_Source *source, uint64_t deadline )
+{
+    /* The coarse time lags CLOCK_MONOTONIC by up to one tick, without the margin a loop that
+       waits for the deadline would spin until the next tick */
+    AppTime_futexSleep(source, deadline + source->resolution);
+}
+
+static uint64_t AppTime_tscNow( AppTime_Source *source )
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t tsc = __rdtsc();
+
+    /* A core whose TSC is a few cycles behind the calibration would go back in time */
+    if (tsc <= source->tscBase)
+    {
+        return source->tscOffset;
+    }
+
+    return source->tscOffset + (uint64_t)(((unsigned __int128)(tsc - source->tscBase) * source->tscMult) >> TSC_FRACTION_BITS);
+#else
+    return source->tscOffset;
+#endif
+}
+
+static void AppTime_tscSleep( AppTime_Source *source, uint64_t deadline )
+{
+    uint64_t now = AppTime_tscNow(source);
+
+    /* The TSC drifts a few ppm from CLOCK_MONOTONIC, only the time left is taken over */
+    if (deadline > now)
+    {
+        AppTime_futexSleep(source, AppTime_readClock(CLOCK_MONOTONIC) + (deadline - now));
+    }
+}
+
+static uint64_t AppTime_readClock( clockid_t clock )
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t AppTime_virtualNow( AppTime_Source *source )
+{
+    return source->current;
+}
+
+static void AppTime_virtualSleep( AppTime_Source *source, uint64_t deadline )
+{
+    /* Nothing to wait for, the next event happens right now */
+    if (deadline > source->current)
+    {
+        source->current = deadline;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
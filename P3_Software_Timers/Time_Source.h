@@ -0,0 +1,109 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef TIME_SOURCE_H_
+#define TIME_SOURCE_H_
+
+/**
+ * \file       Time_Source.h
+ * \brief      Header file for the scheduler Time Sources.
+ *
+ * The scheduler reads the time and waits for the next deadline only through a time source.
+ * The monotonic source follows the real clock, the virtual source jumps straight to the
+ * next deadline so a long schedule is simulated as fast as the callbacks run.
+ *
+ * The real clock has three backends that trade precision against the cost of a read:
+ * CLOCK_MONOTONIC (vDSO, exact), CLOCK_MONOTONIC_COARSE (vDSO, the last kernel tick) and the
+ * TSC of an x86 CPU scaled to nanoseconds by a calibration against CLOCK_MONOTONIC. All of
+ * them sleep on CLOCK_MONOTONIC and report nanoseconds on the same time base.
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdatomic.h>
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Structure to represent a time source, all the times in nanoseconds
+ */
+typedef struct _AppTime_Source
+{
+    uint64_t (*now)(struct _AppTime_Source *source);                        /*!< Returns the current time */
+    void (*sleepUntil)(struct _AppTime_Source *source, uint64_t deadline);  /*!< Returns once the deadline is reached or after a wake */
+    void (*wake)(struct _AppTime_Source *source);                           /*!< Ends the sleep early from any thread, NULL if not supported */
+    uint64_t current;                   /*!< Current time of the virtual source */
+    _Atomic uint32_t wakeSeq;           /*!< Incremented on every wake */
+    uint32_t wakeSeen;                  /*!< wakeSeq when the last sleep returned */
+    _Atomic uint8_t sleeping;           /*!< TRUE while the scheduler thread sleeps */
+    uint64_t resolution;                /*!< Smallest step of now, 0 for the virtual source */
+    uint64_t tscBase;                   /*!< TSC read by the calibration */
+    uint64_t tscOffset;                 /*!< CLOCK_MONOTONIC at tscBase */
+    uint64_t tscMult;                   /*!< Nanoseconds per TSC cycle, fixed point with 32 fraction bits */
+} AppTime_Source;
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of Global Variables                      */
+/*----------------------------------------------------------------------------*/
+
+extern AppTime_Source AppTime_monotonic;    /*!< CLOCK_MONOTONIC and clock_nanosleep, the default */
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes a monotonic time source of its own
+ * 
+ * Same clock as AppTime_monotonic, with its own wake state so several schedulers can sleep
+ * on different threads and be woken one by one.
+ * 
+ * @param source Pointer to the time source
+ */
+void AppTime_initMonotonic( AppTime_Source *source );
+
+/**
+ * @brief Initializes a coarse monotonic time source
+ * 
+ * Reads CLOCK_MONOTONIC_COARSE, the time of the last kernel tick, which costs a few nanoseconds
+ * less than CLOCK_MONOTONIC but only moves every resolution nanoseconds (1 to 4 ms). A sleep ends
+ * one resolution after the deadline so the coarse time has reached it when the loop reads it.
+ * 
+ * @param source Pointer to the time source
+ */
+void AppTime_initCoarse( AppTime_Source *source );
+
+/**
+ * @brief Initializes a time source on the TSC of the CPU
+ * 
+ * Calibrates the TSC against CLOCK_MONOTONIC for calibration nanoseconds, busy, and then reads
+ * the time with a single rdtsc. Needs an x86 CPU with an invariant TSC, the same rate on every
+ * core and in every power state, otherwise the source is set up as AppTime_initMonotonic.
+ * 
+ * @param source Pointer to the time source
+ * @param calibration Length of the calibration in ns, 10 ms keeps the error below a few ppm
+ * @return uint8_t TRUE if the TSC is used, FALSE if the source fell back to CLOCK_MONOTONIC
+ */
+uint8_t AppTime_initTsc( AppTime_Source *source, uint64_t calibration );
+
+/**
+ * @brief Initializes a virtual time source
+ * 
+ * The time only moves when the scheduler sleeps, and then it jumps straight to the deadline.
+ * 
+ * @param source Pointer to the time source
+ * @param start Initial time in nanoseconds
+ */
+void AppTime_initVirtual( AppTime_Source *source, uint64_t start );
+
+/**
+ * @brief Moves a virtual time source forward
+ * 
+ * @param source Pointer to a virtual time source
+ * @param delta Nanoseconds to add, for example to simulate a slow callback
+ */
+void AppTime_advance( AppTime_Source *source, uint64_t delta );
+
+#endif /* TIME_SOURCE_H_ */
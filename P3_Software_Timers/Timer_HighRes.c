@@ -0,0 +1,356 @@
+/**
+ * \file       Timer_HighRes.c
+ * \brief      Implementation for the High Resolution Timers
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <sys/prctl.h>
+#include "Scheduler.h"
+#include "Software_Timers.h"
+#include "Timer_HighRes.h"
+#include "Task_Profiling.h"
+#include "Trace.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define HRES_SLOT(handle)       (((handle) & TIMER_INDEX_MASK) - OFF_SET)
+#define HRES_PARENT(pos)        (((pos) - 1u) / 2u)
+#define HRES_LEFT(pos)          ((2u * (pos)) + 1u)
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of local functions                       */
+/*----------------------------------------------------------------------------*/
+static AppHres_Timer *AppHres_lookupTimer( AppHres_Heap *heap, uint32_t timer );
+static void AppHres_arm( AppSched_Scheduler *scheduler, uint32_t index );
+static void AppHres_move( AppHres_Heap *heap, uint32_t index );
+static void AppHres_swap( AppHres_Heap *heap, uint32_t a, uint32_t b );
+static uint32_t AppHres_siftUp( AppHres_Heap *heap, uint32_t pos );
+static void AppHres_siftDown( AppHres_Heap *heap, uint32_t pos );
+static void AppHres_removeAt( AppHres_Heap *heap, uint32_t pos );
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+void AppSched_initHres( AppSched_Scheduler *scheduler, AppHres_Heap *heap )
+{
+    heap->count = 0;
+    heap->timersCount = 0;
+    heap->freeTimer = TIMER_NONE;
+    heap->fired = 0;
+    scheduler->hres = heap;
+
+    /* The default slack of 50 us would round every sleep of this thread up */
+    prctl(PR_SET_TIMERSLACK, 1ul, 0ul, 0ul, 0ul);
+}
+
+uint32_t AppHres_createTimer( AppSched_Scheduler *scheduler, uint64_t timeout, uint8_t mode, void (*callbackPtr)(void *ctx), void *ctx )
+{
+    AppHres_Heap *heap = scheduler->hres;
+    uint32_t create_timer_status = FALSE;
+    uint32_t index = TIMER_NONE;
+    AppHres_Timer *newTimer;
+
+    if ((timeout > 0u) && (callbackPtr != NULL) && ((mode == TIMER_MODE_AUTO_RELOAD) || (mode == TIMER_MODE_ONE_SHOT)))
+    {
+        if (heap->freeTimer != TIMER_NONE)
+        {
+            index = heap->freeTimer;
+            heap->freeTimer = heap->timer[index].nextFree;
+        }
+        else if (heap->timersCount < HRES_TIMERS_N)
+        {
+            index = heap->timersCount;
+            heap->timer[index].generation = 0u;
+            heap->timersCount++;
+        }
+    }
+
+    if (index != TIMER_NONE)
+    {
+        newTimer = &heap->timer[index];
+        newTimer->timeout = timeout;
+        newTimer->deadline = 0;
+        newTimer->due = 0;
+        newTimer->slack = 0;
+        newTimer->mode = mode;
+        newTimer->callbackPtr = callbackPtr;
+        newTimer->ctx = ctx;
+        newTimer->heapIndex = HRES_IDLE;
+        newTimer->used = TRUE;
+        create_timer_status = ((uint32_t)newTimer->generation << TIMER_INDEX_BITS) | (index + OFF_SET);
+    }
+
+    return create_timer_status;
+}
+
+uint8_t AppHres_startTimer( AppSched_Scheduler *scheduler, uint32_t timer )
+{
+    uint8_t start_timer_status = FALSE;
+
+    if (AppHres_lookupTimer(scheduler->hres, timer) != NULL)
+    {
+        AppHres_arm(scheduler, HRES_SLOT(timer));
+        start_timer_status = TRUE;
+    }
+
+    return start_timer_status;
+}
+
+uint8_t AppHres_reloadTimer( AppSched_Scheduler *scheduler, uint32_t timer, uint64_t timeout )
+{
+    uint8_t reload_timer_status = FALSE;
+    AppHres_Timer *reloadTimer = AppHres_lookupTimer(scheduler->hres, timer);
+
+    if ((reloadTimer != NULL) && (timeout > 0u))
+    {
+        reloadTimer->timeout = timeout;
+        AppHres_arm(scheduler, HRES_SLOT(timer));
+        reload_timer_status = TRUE;
+    }
+
+    return reload_timer_status;
+}
+
+uint8_t AppHres_slackTimer( AppSched_Scheduler *scheduler, uint32_t timer, uint64_t slack )
+{
+    uint8_t slack_timer_status = FALSE;
+    AppHres_Timer *slackTimer = AppHres_lookupTimer(scheduler->hres, timer);
+
+    if (slackTimer != NULL)
+    {
+        slackTimer->slack = slack;
+        slackTimer->deadline = AppSched_coalesce(slackTimer->due, slack);
+        if (slackTimer->heapIndex != HRES_IDLE)
+        {
+            AppHres_move(scheduler->hres, HRES_SLOT(timer));
+        }
+        slack_timer_status = TRUE;
+    }
+
+    return slack_timer_status;
+}
+
+uint8_t AppHres_stopTimer( AppSched_Scheduler *scheduler, uint32_t timer )
+{
+    uint8_t stop_timer_status = FALSE;
+    AppHres_Timer *stopTimer = AppHres_lookupTimer(scheduler->hres, timer);
+
+    if (stopTimer != NULL)
+    {
+        if (stopTimer->heapIndex != HRES_IDLE)
+        {
+            AppHres_removeAt(scheduler->hres, stopTimer->heapIndex);
+        }
+        stop_timer_status = TRUE;
+    }
+
+    return stop_timer_status;
+}
+
+uint8_t AppHres_destroyTimer( AppSched_Scheduler *scheduler, uint32_t timer )
+{
+    AppHres_Heap *heap = scheduler->hres;
+    uint8_t destroy_timer_status = AppHres_stopTimer(scheduler, timer);
+    AppHres_Timer *destroyTimer;
+
+    if (destroy_timer_status == TRUE)
+    {
+        destroyTimer = &heap->timer[HRES_SLOT(timer)];
+        destroyTimer->used = FALSE;
+        destroyTimer->generation = (uint16_t)((destroyTimer->generation + 1u) & TIMER_GEN_MASK);
+        destroyTimer->nextFree = heap->freeTimer;
+        heap->freeTimer = HRES_SLOT(timer);
+    }
+
+    return destroy_timer_status;
+}
+
+uint64_t AppHres_getTimer( AppSched_Scheduler *scheduler, uint32_t timer )
+{
+    uint64_t get_timer_status = 0;
+    AppHres_Timer *getTimer = AppHres_lookupTimer(scheduler->hres, timer);
+
+    if ((getTimer != NULL) && (getTimer->heapIndex != HRES_IDLE) && (getTimer->deadline > scheduler->now))
+    {
+        get_timer_status = getTimer->deadline - scheduler->now;
+    }
+
+    return get_timer_status;
+}
+
+uint64_t AppHres_nextDeadline( const AppHres_Heap *heap )
+{
+    return (heap->count > 0u) ? heap->timer[heap->heap[0]].deadline : HRES_NEVER;
+}
+
+uint32_t AppHres_expire( AppSched_Scheduler *scheduler )
+{
+    AppHres_Heap *heap = scheduler->hres;
+    AppHres_Timer *timer;
+    uint32_t expired = 0;
+    uint32_t index;
+#if (APPSCHED_PROFILING == TRUE)
+    AppTime_Source *source = scheduler->timeSource;
+    uint64_t due;
+    uint64_t timeout;
+    uint64_t begin;
+#endif
+
+    while ((heap->count > 0u) && (heap->timer[heap->heap[0]].deadline <= scheduler->now))
+    {
+        index = heap->heap[0];
+        timer = &heap->timer[index];
+
+        AppSched_accountSlack(scheduler, timer->deadline, timer->due);
+#if (APPSCHED_PROFILING == TRUE)
+        due = timer->due;
+        timeout = timer->timeout;   /* The callback may reload or destroy the timer */
+#endif
+
+        /* The heap is in order again before the callback, it may start or stop any timer */
+        if (timer->mode == TIMER_MODE_ONE_SHOT)
+        {
+            AppHres_removeAt(heap, 0u);
+        }
+        else
+        {
+            timer->due += timer->timeout;   /* Next expiration keeps the phase of the timeout */
+            timer->deadline = AppSched_coalesce(timer->due, timer->slack);
+            AppHres_siftDown(heap, 0u);
+        }
+
+        TRACE_EVENT(TRACE_TIMER_FIRE, index + 1u, 1u);
+#if (APPSCHED_PROFILING == TRUE)
+        begin = source->now(source);
+        timer->callbackPtr(timer->ctx);
+        AppSched_profileTimer(scheduler, &scheduler->hresStats, due, timeout, begin, source->now(source));
+#else
+        timer->callbackPtr(timer->ctx);
+#endif
+        scheduler->dispatches++;
+        heap->fired++;
+        expired++;
+    }
+
+    return expired;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of local functions                      */
+/*----------------------------------------------------------------------------*/
+
+static AppHres_Timer *AppHres_lookupTimer( AppHres_Heap *heap, uint32_t timer )
+{
+    AppHres_Timer *found = NULL;
+    uint32_t index = HRES_SLOT(timer);
+
+    if ((index < heap->timersCount) &&
+        (heap->timer[index].used == TRUE) &&
+        (heap->timer[index].generation == (timer >> TIMER_INDEX_BITS)))
+    {
+        found = &heap->timer[index];
+    }
+
+    return found;
+}
+
+static void AppHres_arm( AppSched_Scheduler *scheduler, uint32_t index )
+{
+    AppHres_Heap *heap = scheduler->hres;
+    AppHres_Timer *timer = &heap->timer[index];
+
+    timer->due = scheduler->now + timer->timeout;
+    timer->deadline = AppSched_coalesce(timer->due, timer->slack);
+
+    if (timer->heapIndex == HRES_IDLE)
+    {
+        timer->heapIndex = heap->count;
+        heap->heap[heap->count] = index;
+        heap->count++;
+        (void)AppHres_siftUp(heap, timer->heapIndex);
+    }
+    else
+    {
+        AppHres_move(heap, index);
+    }
+}
+
+static void AppHres_move( AppHres_Heap *heap, uint32_t index )
+{
+    /* A running timer with a new deadline can move both ways */
+    AppHres_siftDown(heap, AppHres_siftUp(heap, heap->timer[index].heapIndex));
+}
+
+static void AppHres_swap( AppHres_Heap *heap, uint32_t a, uint32_t b )
+{
+    uint32_t index = heap->heap[a];
+
+    heap->heap[a] = heap->heap[b];
+    heap->heap[b] = index;
+    heap->timer[heap->heap[a]].heapIndex = a;
+    heap->timer[heap->heap[b]].heapIndex = b;
+}
+
+static uint32_t AppHres_siftUp( AppHres_Heap *heap, uint32_t pos )
+{
+    while ((pos > 0u) &&
+           (heap->timer[heap->heap[pos]].deadline < heap->timer[heap->heap[HRES_PARENT(pos)]].deadline))
+    {
+        AppHres_swap(heap, pos, HRES_PARENT(pos));
+        pos = HRES_PARENT(pos);
+    }
+
+    return pos;
+}
+
+static void AppHres_siftDown( AppHres_Heap *heap, uint32_t pos )
+{
+    uint32_t child;
+
+    for (;;)
+    {
+        child = HRES_LEFT(pos);
+        if (child >= heap->count)
+        {
+            break;
+        }
+        if (((child + 1u) < heap->count) &&
+            (heap->timer[heap->heap[child + 1u]].deadline < heap->timer[heap->heap[child]].deadline))
+        {
+            child++;
+        }
+        if (heap->timer[heap->heap[pos]].deadline <= heap->timer[heap->heap[child]].deadline)
+        {
+            break;
+        }
+        AppHres_swap(heap, pos, child);
+        pos = child;
+    }
+}
+
+static void AppHres_removeAt( AppHres_Heap *heap, uint32_t pos )
+{
+    uint32_t last = heap->count - 1u;
+
+    heap->timer[heap->heap[pos]].heapIndex = HRES_IDLE;
+    heap->count--;
+
+    /* The last timer fills the hole and moves to its place */
+    if (pos != last)
+    {
+        heap->heap[pos] = heap->heap[last];
+        heap->timer[heap->heap[pos]].heapIndex = pos;
+        AppHres_siftDown(heap, AppHres_siftUp(heap, pos));
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
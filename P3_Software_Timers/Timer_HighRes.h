@@ -0,0 +1,171 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef TIMER_HIGHRES_H_
+#define TIMER_HIGHRES_H_
+
+/**
+ * \file       Timer_HighRes.h
+ * \brief      Header file for the High Resolution Timers.
+ *
+ * High resolution timers take any timeout in nanoseconds, they are not rounded to the tick.
+ * They are kept in their own binary min-heap ordered by deadline, and the scheduler sleeps
+ * until the earliest of the heap and its own next tick or deadline with an absolute sleep
+ * of the time source. Timers that do not need the precision stay on the tick.
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "Scheduler.h"
+#include "Software_Timers.h"
+
+/*----------------------------------------------------------------------------*/
+/*                             Defines and macros                             */
+/*----------------------------------------------------------------------------*/
+
+#ifndef HRES_TIMERS_N
+#define HRES_TIMERS_N           256u        /*!< Maximum number of high resolution timers */
+#endif
+
+#define HRES_IDLE               0xFFFFFFFFu /*!< heapIndex of a timer that is not running */
+#define HRES_NEVER              0xFFFFFFFFFFFFFFFFull /*!< Deadline of an empty heap */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Structure to represent a high resolution timer
+ */
+typedef struct _AppHres_Timer
+{
+    uint64_t deadline;                  /*!< Expiration in ns since the scheduler started */
+    uint64_t timeout;                   /*!< Timeout in ns */
+    uint64_t due;                       /*!< Expiration before the slack was applied */
+    uint64_t slack;                     /*!< Delay in ns the timer accepts to share a wakeup, 0 for none */
+    void (*callbackPtr)(void *ctx);     /*!< Function called when the timer expires */
+    void *ctx;                          /*!< Context given to callbackPtr */
+    uint32_t heapIndex;                 /*!< Position in the heap, HRES_IDLE if not running */
+    uint32_t nextFree;                  /*!< Next free slot, TIMER_NONE for the last one */
+    uint16_t generation;                /*!< Incremented when the timer is destroyed */
+    uint8_t mode;                       /*!< TIMER_MODE_AUTO_RELOAD or TIMER_MODE_ONE_SHOT */
+    uint8_t used;                       /*!< FALSE while the slot is in the free list */
+} AppHres_Timer;
+
+/**
+ * @brief Structure to represent the heap of high resolution timers
+ */
+typedef struct _AppHres_Heap
+{
+    AppHres_Timer timer[HRES_TIMERS_N]; /*!< Timer slots, the handles refer to them */
+    uint32_t heap[HRES_TIMERS_N];       /*!< Running timers, heap[0] has the earliest deadline */
+    uint32_t count;                     /*!< Running timers in the heap */
+    uint32_t timersCount;               /*!< Slots in use or in the free list */
+    uint32_t freeTimer;                 /*!< First free slot, TIMER_NONE if empty */
+    uint32_t fired;                     /*!< Expirations handled */
+} AppHres_Heap;
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Attaches an empty heap of high resolution timers to the scheduler
+ *
+ * Also lowers the timer slack of the calling thread, which has to be the thread that runs
+ * the scheduler, so a sleep of the monotonic source ends within microseconds of its deadline.
+ *
+ * @param scheduler Pointer to the scheduler
+ * @param heap Pointer to the heap, it has to live as long as the scheduler
+ */
+void AppSched_initHres( AppSched_Scheduler *scheduler, AppHres_Heap *heap );
+
+/**
+ * @brief Creates a stopped high resolution timer
+ *
+ * The handles follow the layout of the software timer handles, a stale handle is rejected.
+ *
+ * @param scheduler Pointer to the scheduler
+ * @param timeout Timeout in nanoseconds, any value above 0
+ * @param mode TIMER_MODE_AUTO_RELOAD or TIMER_MODE_ONE_SHOT
+ * @param callbackPtr Function called with ctx when the timer expires
+ * @param ctx Context given to the callback
+ * @return uint32_t Handle of the timer, FALSE (0) if a parameter is invalid or there is no space
+ */
+uint32_t AppHres_createTimer( AppSched_Scheduler *scheduler, uint64_t timeout, uint8_t mode, void (*callbackPtr)(void *ctx), void *ctx );
+
+/**
+ * @brief Starts a timer one full timeout from now, also when it is already running
+ *
+ * @param scheduler Pointer to the scheduler
+ * @param timer Timer handle
+ * @return uint8_t TRUE if the timer was started, FALSE if the handle is stale or invalid
+ */
+uint8_t AppHres_startTimer( AppSched_Scheduler *scheduler, uint32_t timer );
+
+/**
+ * @brief Changes the timeout of a timer and starts it
+ *
+ * @param scheduler Pointer to the scheduler
+ * @param timer Timer handle
+ * @param timeout New timeout in nanoseconds
+ * @return uint8_t TRUE if the timer was started, FALSE if the handle or the timeout are invalid
+ */
+uint8_t AppHres_reloadTimer( AppSched_Scheduler *scheduler, uint32_t timer, uint64_t timeout );
+
+/**
+ * @brief Sets how late a timer may expire so it can share a wakeup with other timers
+ *
+ * Works like AppSched_slackTimer, a running timer is moved right away.
+ *
+ * @param scheduler Pointer to the scheduler
+ * @param timer Timer handle
+ * @param slack Maximum delay in nanoseconds, 0 expires exactly on time
+ * @return uint8_t TRUE if the slack was set, FALSE if the handle is stale or invalid
+ */
+uint8_t AppHres_slackTimer( AppSched_Scheduler *scheduler, uint32_t timer, uint64_t slack );
+
+/**
+ * @brief Stops a timer
+ *
+ * @param scheduler Pointer to the scheduler
+ * @param timer Timer handle
+ * @return uint8_t TRUE if the timer was stopped, FALSE if the handle is stale or invalid
+ */
+uint8_t AppHres_stopTimer( AppSched_Scheduler *scheduler, uint32_t timer );
+
+/**
+ * @brief Stops a timer and frees its slot, the handle becomes stale
+ *
+ * @param scheduler Pointer to the scheduler
+ * @param timer Timer handle
+ * @return uint8_t TRUE if the timer was destroyed, FALSE if the handle is stale or invalid
+ */
+uint8_t AppHres_destroyTimer( AppSched_Scheduler *scheduler, uint32_t timer );
+
+/**
+ * @brief Gets the time left before a timer expires
+ *
+ * @param scheduler Pointer to the scheduler
+ * @param timer Timer handle
+ * @return uint64_t Nanoseconds left, 0 if the timer is not running or the handle is invalid
+ */
+uint64_t AppHres_getTimer( AppSched_Scheduler *scheduler, uint32_t timer );
+
+/**
+ * @brief Returns the earliest deadline of the running timers
+ *
+ * @param heap Pointer to the heap
+ * @return uint64_t Deadline in ns since the scheduler started, HRES_NEVER if no timer runs
+ */
+uint64_t AppHres_nextDeadline( const AppHres_Heap *heap );
+
+/**
+ * @brief Runs the callbacks of every timer expired at scheduler->now, scheduler thread only
+ *
+ * @param scheduler Pointer to the scheduler
+ * @return uint32_t Number of expirations
+ */
+uint32_t AppHres_expire( AppSched_Scheduler *scheduler );
+
+#endif /* TIMER_HIGHRES_H_ */
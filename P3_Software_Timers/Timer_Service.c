@@ -0,0 +1,113 @@
+/**
+ * \file       Timer_Service.c
+ * \brief      Implementation for the Timer Service (timer daemon)
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "Scheduler.h"
+#include "Timer_Service.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define DEFER_MASK              (SVC_DEFER_N - 1u)
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+void AppSvc_initService( AppSvc_Service *service, uint8_t deferred )
+{
+    AppMpsc_initQueue(&service->queue, service->sequence, SVC_QUEUE_N);
+
+    service->deferred = deferred;
+    service->deferNext = 0;
+    for (uint32_t d = 0; d < SVC_DEFER_N; d++)
+    {
+        atomic_init(&service->defer[d].busy, FALSE);
+    }
+
+    service->applied = 0;
+    service->rejected = 0;
+}
+
+uint8_t AppSvc_post( AppSvc_Service *service, const AppSvc_Command *command )
+{
+    uint32_t pos;
+
+    /* A full queue means the scheduler has not applied the command of the previous round yet */
+    if (AppMpsc_claim(&service->queue, &pos) == FALSE)
+    {
+        return FALSE;
+    }
+
+    service->command[pos & (SVC_QUEUE_N - 1u)] = *command;
+    AppMpsc_publish(&service->queue, pos);
+
+    return TRUE;
+}
+
+uint8_t AppSvc_take( AppSvc_Service *service, AppSvc_Command *command )
+{
+    uint32_t slot;
+
+    /* A claimed cell still being written counts as empty, it is taken on the next wakeup */
+    if (AppMpsc_peek(&service->queue, &slot) == FALSE)
+    {
+        return FALSE;
+    }
+
+    *command = service->command[slot];
+    AppMpsc_release(&service->queue);
+
+    return TRUE;
+}
+
+uint32_t AppSvc_defer( AppSvc_Service *service, const AppSched_Timer *timer )
+{
+    uint32_t slot = service->deferNext & DEFER_MASK;
+    AppSvc_Deferred *defer = &service->defer[slot];
+
+    if (atomic_load_explicit(&defer->busy, memory_order_acquire) == TRUE)
+    {
+        return SVC_DEFER_N;     /* The pool is SVC_DEFER_N callbacks behind */
+    }
+
+    defer->callbackPtr = timer->callbackPtr;
+    defer->ctxCallbackPtr = timer->ctxCallbackPtr;
+    defer->ctx = timer->ctx;
+    atomic_store_explicit(&defer->busy, TRUE, memory_order_relaxed);
+    service->deferNext++;
+
+    return slot;
+}
+
+void AppSvc_cancel( AppSvc_Service *service, uint32_t slot )
+{
+    atomic_store_explicit(&service->defer[slot].busy, FALSE, memory_order_relaxed);
+    service->deferNext--;
+}
+
+void AppSvc_runDeferred( AppSvc_Service *service, uint32_t slot )
+{
+    AppSvc_Deferred *defer = &service->defer[slot];
+
+    if (defer->ctxCallbackPtr != NULL)
+    {
+        defer->ctxCallbackPtr(defer->ctx);
+    }
+    else
+    {
+        defer->callbackPtr();
+    }
+    atomic_store_explicit(&defer->busy, FALSE, memory_order_release);
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
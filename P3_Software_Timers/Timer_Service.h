@@ -0,0 +1,133 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef TIMER_SERVICE_H_
+#define TIMER_SERVICE_H_
+
+/**
+ * \file       Timer_Service.h
+ * \brief      Header file for the Timer Service (timer daemon).
+ *
+ * Only the scheduler thread touches the timers. Other threads post start, stop, reload and
+ * destroy commands into a bounded lock-free queue (many producers, one consumer) and the
+ * scheduler applies them on its next wakeup, like the FreeRTOS timer daemon. Expired
+ * callbacks can also be handed to the worker pool so a slow callback does not delay the tick.
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdatomic.h>
+#include "Software_Timers.h"
+#include "Mpsc_Queue.h"
+
+/*----------------------------------------------------------------------------*/
+/*                             Defines and macros                             */
+/*----------------------------------------------------------------------------*/
+
+#define SVC_QUEUE_N             1024u       /*!< Pending commands, power of two */
+#define SVC_DEFER_N             1024u       /*!< Callbacks running on the pool at the same time, power of two */
+
+#define SVC_CMD_START           0u          /*!< AppSched_startTimer */
+#define SVC_CMD_STOP            1u          /*!< AppSched_stopTimer */
+#define SVC_CMD_RELOAD          2u          /*!< AppSched_reloadTimer with the timeout of the command */
+#define SVC_CMD_DESTROY         3u          /*!< AppSched_destroyTimer */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Structure to represent a timer command
+ */
+typedef struct _AppSvc_Command
+{
+    uint32_t type;                          /*!< SVC_CMD_START, SVC_CMD_STOP, SVC_CMD_RELOAD or SVC_CMD_DESTROY */
+    uint32_t timer;                         /*!< Timer handle */
+    uint32_t timeout;                       /*!< New timeout in milliseconds for SVC_CMD_RELOAD */
+} AppSvc_Command;
+
+/**
+ * @brief Structure to represent a timer callback handed to the worker pool
+ */
+typedef struct _AppSvc_Deferred
+{
+    void (*callbackPtr)(void);              /*!< Callback without context */
+    void (*ctxCallbackPtr)(void *ctx);      /*!< Callback with context, used when not NULL */
+    void *ctx;                              /*!< Context given to ctxCallbackPtr */
+    atomic_uchar busy;                      /*!< TRUE until the worker finished the callback */
+} AppSvc_Deferred;
+
+/**
+ * @brief Structure to represent the timer service
+ */
+typedef struct _AppSvc_Service
+{
+    AppMpsc_Queue queue;                    /*!< Positions of the command queue, full counts the refused posts */
+    _Atomic uint32_t sequence[SVC_QUEUE_N]; /*!< Owner of every command cell */
+    AppSvc_Command command[SVC_QUEUE_N];    /*!< Posted commands */
+    uint8_t deferred;                       /*!< TRUE runs the expired callbacks on the worker pool */
+    uint32_t deferNext;                     /*!< Next deferred slot to use (scheduler thread) */
+    AppSvc_Deferred defer[SVC_DEFER_N];     /*!< Callbacks handed to the pool */
+    uint32_t applied;                       /*!< Commands applied */
+    uint32_t rejected;                      /*!< Commands with a stale handle or an invalid timeout */
+} AppSvc_Service;
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes an empty service
+ *
+ * @param service Pointer to the service
+ * @param deferred TRUE to run the expired callbacks on the worker pool of the scheduler
+ */
+void AppSvc_initService( AppSvc_Service *service, uint8_t deferred );
+
+/**
+ * @brief Posts a command, safe from any thread and lock-free
+ *
+ * @param service Pointer to the service
+ * @param command Command to copy into the queue
+ * @return uint8_t TRUE if the command was queued, FALSE if the queue is full
+ */
+uint8_t AppSvc_post( AppSvc_Service *service, const AppSvc_Command *command );
+
+/**
+ * @brief Takes the oldest command, scheduler thread only
+ *
+ * @param service Pointer to the service
+ * @param command Where to copy the command
+ * @return uint8_t TRUE if there was a command, FALSE if the queue is empty
+ */
+uint8_t AppSvc_take( AppSvc_Service *service, AppSvc_Command *command );
+
+/**
+ * @brief Reserves a deferred slot and copies the callback of a timer into it, scheduler thread only
+ *
+ * The copy lets the worker run the callback while the timer is destroyed, reused or the table
+ * moves. A slot whose previous callback is still running is not reused.
+ *
+ * @param service Pointer to the service
+ * @param timer Pointer to the expired timer
+ * @return uint32_t Slot to send to the pool, SVC_DEFER_N if every slot is busy
+ */
+uint32_t AppSvc_defer( AppSvc_Service *service, const AppSched_Timer *timer );
+
+/**
+ * @brief Gives a deferred slot back without running it, when the pool did not take the job
+ *
+ * @param service Pointer to the service
+ * @param slot Slot returned by AppSvc_defer
+ */
+void AppSvc_cancel( AppSvc_Service *service, uint32_t slot );
+
+/**
+ * @brief Runs a deferred callback and frees its slot, worker thread
+ *
+ * @param service Pointer to the service
+ * @param slot Slot returned by AppSvc_defer
+ */
+void AppSvc_runDeferred( AppSvc_Service *service, uint32_t slot );
+
+#endif /* TIMER_SERVICE_H_ */
@@ -0,0 +1,184 @@
+/**
+ * \file       Timer_Wheel.c
+ * \brief      Implementation for the hierarchical Timer Wheel
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include "Software_Timers.h"
+#include "Timer_Wheel.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define WHEEL_MASK              (WHEEL_SLOTS_N - 1u)
+#define WHEEL_INDEX(t, level)   (((t) >> ((level) * WHEEL_BITS)) & WHEEL_MASK)
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of local functions                       */
+/*----------------------------------------------------------------------------*/
+static void AppWheel_link( AppSched_Wheel *wheel, AppSched_Timer *timers, uint32_t index, uint32_t slot );
+static void AppWheel_unlink( AppSched_Wheel *wheel, AppSched_Timer *timers, uint32_t index );
+static void AppWheel_place( AppSched_Wheel *wheel, AppSched_Timer *timers, uint32_t index );
+static void AppWheel_cascade( AppSched_Wheel *wheel, AppSched_Timer *timers, uint32_t level );
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+void AppWheel_initWheel( AppSched_Wheel *wheel )
+{
+    wheel->now = 0;
+    wheel->count = 0;
+    for (uint32_t s = 0; s <= WHEEL_EXPIRING; s++)
+    {
+        wheel->head[s] = WHEEL_NONE;
+    }
+}
+
+void AppWheel_insert( AppSched_Wheel *wheel, AppSched_Timer *timers, uint32_t index, uint32_t ticks )
+{
+    AppWheel_remove(wheel, timers, index);
+
+    timers[index].expiry = wheel->now + ((ticks > 0u) ? ticks : 1u);
+    AppWheel_place(wheel, timers, index);
+    wheel->count++;
+}
+
+void AppWheel_remove( AppSched_Wheel *wheel, AppSched_Timer *timers, uint32_t index )
+{
+    if (timers[index].wheelSlot != WHEEL_IDLE)
+    {
+        AppWheel_unlink(wheel, timers, index);
+        wheel->count--;
+    }
+}
+
+uint32_t AppWheel_advance( AppSched_Wheel *wheel, AppSched_Timer *const *timers, void (*expire)(void *ctx, uint32_t index), void *ctx )
+{
+    uint32_t t = ++wheel->now;
+    uint32_t slot = WHEEL_INDEX(t, 0u);
+    uint32_t expired = 0;
+    uint32_t index;
+
+    /* Every 256 ticks a level 1 slot moves down, every 65536 a level 2 slot, and so on.
+       The upper levels go first so their timers can continue down in the same tick */
+    if (slot == 0u)
+    {
+        if (WHEEL_INDEX(t, 1u) == 0u)
+        {
+            if (WHEEL_INDEX(t, 2u) == 0u)
+            {
+                AppWheel_cascade(wheel, *timers, 3u);
+            }
+            AppWheel_cascade(wheel, *timers, 2u);
+        }
+        AppWheel_cascade(wheel, *timers, 1u);
+    }
+
+    /* Move the due slot to the expiring list, callbacks may touch any timer meanwhile */
+    wheel->head[WHEEL_EXPIRING] = wheel->head[slot];
+    wheel->head[slot] = WHEEL_NONE;
+    for (index = wheel->head[WHEEL_EXPIRING]; index != WHEEL_NONE; index = (*timers)[index].wheelNext)
+    {
+        (*timers)[index].wheelSlot = WHEEL_EXPIRING;
+    }
+
+    while (wheel->head[WHEEL_EXPIRING] != WHEEL_NONE)
+    {
+        index = wheel->head[WHEEL_EXPIRING];
+        AppWheel_unlink(wheel, *timers, index); /* Read again, a callback may have moved the table */
+        wheel->count--;
+        expired++;
+        expire(ctx, index);
+    }
+
+    return expired;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of local functions                      */
+/*----------------------------------------------------------------------------*/
+
+static void AppWheel_link( AppSched_Wheel *wheel, AppSched_Timer *timers, uint32_t index, uint32_t slot )
+{
+    uint32_t first = wheel->head[slot];
+
+    timers[index].wheelNext = first;
+    timers[index].wheelPrev = WHEEL_NONE;
+    timers[index].wheelSlot = (uint16_t)slot;
+    if (first != WHEEL_NONE)
+    {
+        timers[first].wheelPrev = index;
+    }
+    wheel->head[slot] = index;
+}
+
+static void AppWheel_unlink( AppSched_Wheel *wheel, AppSched_Timer *timers, uint32_t index )
+{
+    AppSched_Timer *timer = &timers[index];
+
+    if (timer->wheelPrev != WHEEL_NONE)
+    {
+        timers[timer->wheelPrev].wheelNext = timer->wheelNext;
+    }
+    else
+    {
+        wheel->head[timer->wheelSlot] = timer->wheelNext;
+    }
+    if (timer->wheelNext != WHEEL_NONE)
+    {
+        timers[timer->wheelNext].wheelPrev = timer->wheelPrev;
+    }
+    timer->wheelSlot = WHEEL_IDLE;
+}
+
+static void AppWheel_place( AppSched_Wheel *wheel, AppSched_Timer *timers, uint32_t index )
+{
+    uint32_t expiry = timers[index].expiry;
+    uint32_t delta = expiry - wheel->now;
+    uint32_t level;
+
+    /* The level is given by the distance, the slot by the bits of the expiry at that level */
+    if (delta < (1u << WHEEL_BITS))
+    {
+        level = 0u;
+    }
+    else if (delta < (1u << (2u * WHEEL_BITS)))
+    {
+        level = 1u;
+    }
+    else if (delta < (1u << (3u * WHEEL_BITS)))
+    {
+        level = 2u;
+    }
+    else
+    {
+        level = 3u;
+    }
+
+    AppWheel_link(wheel, timers, index, (level * WHEEL_SLOTS_N) + WHEEL_INDEX(expiry, level));
+}
+
+static void AppWheel_cascade( AppSched_Wheel *wheel, AppSched_Timer *timers, uint32_t level )
+{
+    uint32_t slot = (level * WHEEL_SLOTS_N) + WHEEL_INDEX(wheel->now, level);
+    uint32_t index = wheel->head[slot];
+    uint32_t next;
+
+    wheel->head[slot] = WHEEL_NONE;
+    while (index != WHEEL_NONE)
+    {
+        next = timers[index].wheelNext;
+        AppWheel_place(wheel, timers, index);   /* Closer to the expiry now, lands in a lower level */
+        index = next;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,92 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef TIMER_WHEEL_H_
+#define TIMER_WHEEL_H_
+
+/**
+ * \file       Timer_Wheel.h
+ * \brief      Header file for the hierarchical Timer Wheel.
+ *
+ * Four levels of 256 slots cover the full 32 bit tick range. Level 0 holds the timers
+ * expiring in the next 256 ticks, one slot per tick, level 1 the next 65536 ticks in slots
+ * of 256 ticks and so on. A tick only looks at one level 0 slot, the upper levels are
+ * cascaded down once every 256, 65536 and 16777216 ticks.
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "Software_Timers.h"
+
+/*----------------------------------------------------------------------------*/
+/*                             Defines and macros                             */
+/*----------------------------------------------------------------------------*/
+
+#define WHEEL_LEVELS_N          4u          /*!< Number of levels */
+#define WHEEL_SLOTS_N           256u        /*!< Slots per level */
+#define WHEEL_BITS              8u          /*!< log2(WHEEL_SLOTS_N) */
+#define WHEEL_EXPIRING          (WHEEL_LEVELS_N * WHEEL_SLOTS_N)   /*!< List of the timers expiring right now */
+#define WHEEL_NONE              0xFFFFFFFFu /*!< End of a slot list */
+#define WHEEL_IDLE              0xFFFFu     /*!< wheelSlot of a timer that is not in the wheel */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Structure to represent the timer wheel
+ *
+ * Slots hold the index of the first timer of a doubly linked list, the links live in the
+ * timers themselves (wheelNext, wheelPrev), so start, stop and reload are O(1).
+ */
+typedef struct _AppSched_Wheel
+{
+    uint32_t now;                                       /*!< Current tick of the wheel */
+    uint32_t count;                                     /*!< Timers in the wheel */
+    uint32_t head[(WHEEL_LEVELS_N * WHEEL_SLOTS_N) + 1u]; /*!< First timer of every slot, plus the expiring list */
+} AppSched_Wheel;
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes an empty wheel
+ * 
+ * @param wheel Pointer to the wheel
+ */
+void AppWheel_initWheel( AppSched_Wheel *wheel );
+
+/**
+ * @brief Puts a timer in the wheel, or moves it if it is already there
+ * 
+ * @param wheel Pointer to the wheel
+ * @param timers Timer array the indexes refer to
+ * @param index Index of the timer in the array
+ * @param ticks Ticks from now until the timer expires, at least 1
+ */
+void AppWheel_insert( AppSched_Wheel *wheel, AppSched_Timer *timers, uint32_t index, uint32_t ticks );
+
+/**
+ * @brief Takes a timer out of the wheel, nothing happens if it is not there
+ * 
+ * @param wheel Pointer to the wheel
+ * @param timers Timer array the indexes refer to
+ * @param index Index of the timer in the array
+ */
+void AppWheel_remove( AppSched_Wheel *wheel, AppSched_Timer *timers, uint32_t index );
+
+/**
+ * @brief Advances the wheel one tick and calls expire for every timer that expires on it
+ * 
+ * The timers are out of the wheel when expire runs, expire can insert or remove any timer.
+ * 
+ * @param wheel Pointer to the wheel
+ * @param timers Pointer to the timer array the indexes refer to, expire may reallocate the array
+ * @param expire Function called with ctx and the index of every expired timer
+ * @param ctx Context given to expire
+ * @return uint32_t Number of timers that expired
+ */
+uint32_t AppWheel_advance( AppSched_Wheel *wheel, AppSched_Timer *const *timers, void (*expire)(void *ctx, uint32_t index), void *ctx );
+
+#endif /* TIMER_WHEEL_H_ */
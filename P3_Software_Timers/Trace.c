@@ -0,0 +1,329 @@
+/**
+ * \file       Trace.c
+ * \brief      Implementation for the binary dispatch trace recorder
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "Scheduler.h"
+#include "Trace.h"
+
+#if (APPSCHED_TRACE == TRUE)
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define TRACE_MASK              (TRACE_EVENTS_N - 1u)
+#define TRACE_MAGIC             0x32525441u     /* "ATR2" in a little endian file, 24 byte events */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/* Ring of one thread, only that thread writes it */
+typedef struct _AppTrace_Ring
+{
+    uint32_t tid;                       /* Thread number shown in the trace viewer */
+    uint64_t head;                      /* Events written since the thread started recording */
+    AppTrace_Event events[TRACE_EVENTS_N];
+} AppTrace_Ring;
+
+/* Events of one thread in chronological order */
+typedef struct _AppTrace_Block
+{
+    uint32_t tid;
+    uint32_t count;
+    AppTrace_Event *events;
+} AppTrace_Block;
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of Global Variables                      */
+/*----------------------------------------------------------------------------*/
+
+static AppTrace_Ring *Rings[TRACE_THREADS_N];  /* Rings of every thread that recorded something */
+static _Atomic uint32_t RingsCount;
+static _Thread_local AppTrace_Ring *Ring;       /* Ring of the calling thread */
+static _Thread_local uint8_t Lost;              /* TRUE when the thread could not get a ring */
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of local functions                       */
+/*----------------------------------------------------------------------------*/
+static uint8_t AppTrace_attach( void );
+static uint32_t AppTrace_snapshot( AppTrace_Block *blocks );
+static void AppTrace_freeBlocks( AppTrace_Block *blocks, uint32_t count );
+static void AppTrace_writeChrome( FILE *out, AppTrace_Block *blocks, uint32_t count );
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+void AppTrace_record( uint32_t type, uint32_t id, uint32_t arg )
+{
+    AppTrace_Event *event;
+
+    if ((Ring == NULL) && (AppTrace_attach() == FALSE))
+    {
+        return;
+    }
+
+    event = &Ring->events[Ring->head & TRACE_MASK];
+    event->time = nanoseconds();
+    event->type = type;
+    event->id = id;
+    event->arg = arg;
+    Ring->head++;
+}
+
+uint8_t AppTrace_dumpBinary( const char *path )
+{
+    AppTrace_Block blocks[TRACE_THREADS_N];
+    uint32_t count = AppTrace_snapshot(blocks);
+    uint32_t header[2] = { TRACE_MAGIC, count };
+    FILE *out = fopen(path, "wb");
+
+    if (out == NULL)
+    {
+        AppTrace_freeBlocks(blocks, count);
+        return FALSE;
+    }
+
+    fwrite(header, sizeof(header), 1, out);
+    for (uint32_t r = 0; r < count; r++)
+    {
+        fwrite(&blocks[r].tid, sizeof(uint32_t), 1, out);
+        fwrite(&blocks[r].count, sizeof(uint32_t), 1, out);
+        fwrite(blocks[r].events, sizeof(AppTrace_Event), blocks[r].count, out);
+    }
+
+    fclose(out);
+    AppTrace_freeBlocks(blocks, count);
+
+    return TRUE;
+}
+
+uint8_t AppTrace_exportChrome( const char *path )
+{
+    AppTrace_Block blocks[TRACE_THREADS_N];
+    uint32_t count = AppTrace_snapshot(blocks);
+    FILE *out = fopen(path, "w");
+
+    if (out == NULL)
+    {
+        AppTrace_freeBlocks(blocks, count);
+        return FALSE;
+    }
+
+    AppTrace_writeChrome(out, blocks, count);
+    fclose(out);
+    AppTrace_freeBlocks(blocks, count);
+
+    return TRUE;
+}
+
+uint8_t AppTrace_convertBinary( const char *binPath, const char *jsonPath )
+{
+    AppTrace_Block blocks[TRACE_THREADS_N];
+    uint32_t header[2];
+    uint32_t count = 0;
+    uint8_t convert_status = FALSE;
+    FILE *in = fopen(binPath, "rb");
+    FILE *out;
+
+    if (in == NULL)
+    {
+        return FALSE;
+    }
+
+    if ((fread(header, sizeof(header), 1, in) == 1u) && (header[0] == TRACE_MAGIC) && (header[1] <= TRACE_THREADS_N))
+    {
+        convert_status = TRUE;
+        for (count = 0; count < header[1]; count++)
+        {
+            AppTrace_Block *block = &blocks[count];
+
+            if ((fread(&block->tid, sizeof(uint32_t), 1, in) != 1u) ||
+                (fread(&block->count, sizeof(uint32_t), 1, in) != 1u) ||
+                (block->count > TRACE_EVENTS_N))
+            {
+                convert_status = FALSE;
+                break;
+            }
+            block->events = malloc((size_t)block->count * sizeof(AppTrace_Event) + 1u);
+            if ((block->events == NULL) ||
+                (fread(block->events, sizeof(AppTrace_Event), block->count, in) != block->count))
+            {
+                count++;    /* The block is freed below */
+                convert_status = FALSE;
+                break;
+            }
+        }
+    }
+    fclose(in);
+
+    if (convert_status == TRUE)
+    {
+        out = fopen(jsonPath, "w");
+        if (out != NULL)
+        {
+            AppTrace_writeChrome(out, blocks, count);
+            fclose(out);
+        }
+        else
+        {
+            convert_status = FALSE;
+        }
+    }
+
+    AppTrace_freeBlocks(blocks, count);
+
+    return convert_status;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of local functions                      */
+/*----------------------------------------------------------------------------*/
+
+static uint8_t AppTrace_attach( void )
+{
+    uint32_t index;
+
+    if (Lost == TRUE)
+    {
+        return FALSE;
+    }
+
+    index = atomic_fetch_add(&RingsCount, 1u);
+    if (index >= TRACE_THREADS_N)
+    {
+        Lost = TRUE;    /* Too many threads, this one does not record */
+        return FALSE;
+    }
+
+    Ring = calloc(1, sizeof(AppTrace_Ring));
+    if (Ring == NULL)
+    {
+        Lost = TRUE;
+        return FALSE;
+    }
+    Ring->tid = index + 1u;
+    Rings[index] = Ring;
+
+    return TRUE;
+}
+
+static uint32_t AppTrace_snapshot( AppTrace_Block *blocks )
+{
+    uint32_t rings = atomic_load(&RingsCount);
+    uint32_t count = 0;
+
+    if (rings > TRACE_THREADS_N)
+    {
+        rings = TRACE_THREADS_N;
+    }
+
+    for (uint32_t r = 0; r < rings; r++)
+    {
+        AppTrace_Ring *ring = Rings[r];
+        uint64_t first;
+
+        if (ring == NULL)
+        {
+            continue;
+        }
+
+        /* Oldest event still in the ring first */
+        first = (ring->head > TRACE_EVENTS_N) ? (ring->head - TRACE_EVENTS_N) : 0u;
+        blocks[count].tid = ring->tid;
+        blocks[count].count = (uint32_t)(ring->head - first);
+        blocks[count].events = malloc((size_t)blocks[count].count * sizeof(AppTrace_Event) + 1u);
+        if (blocks[count].events == NULL)
+        {
+            continue;
+        }
+        for (uint32_t e = 0; e < blocks[count].count; e++)
+        {
+            blocks[count].events[e] = ring->events[(first + e) & TRACE_MASK];
+        }
+        count++;
+    }
+
+    return count;
+}
+
+static void AppTrace_freeBlocks( AppTrace_Block *blocks, uint32_t count )
+{
+    for (uint32_t r = 0; r < count; r++)
+    {
+        free(blocks[r].events);
+    }
+}
+
+static void AppTrace_writeChrome( FILE *out, AppTrace_Block *blocks, uint32_t count )
+{
+    uint64_t base = UINT64_MAX;
+    const char *separator = "";
+
+    /* Timestamps start at the earliest event of any thread */
+    for (uint32_t r = 0; r < count; r++)
+    {
+        if ((blocks[r].count > 0u) && (blocks[r].events[0].time < base))
+        {
+            base = blocks[r].events[0].time;
+        }
+    }
+
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    for (uint32_t r = 0; r < count; r++)
+    {
+        fprintf(out, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+                separator, (unsigned)blocks[r].tid, (blocks[r].tid == 1u) ? "scheduler" : "thread", (unsigned)blocks[r].tid);
+        separator = ",";
+
+        for (uint32_t e = 0; e < blocks[r].count; e++)
+        {
+            AppTrace_Event *event = &blocks[r].events[e];
+            double ts = (double)(event->time - base) / 1000.0;  /* Chrome expects microseconds */
+
+            switch (event->type)
+            {
+                case TRACE_TICK:
+                    fprintf(out, ",\n{\"name\":\"Tick\",\"cat\":\"scheduler\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"tick\":%u}}",
+                            ts, (unsigned)blocks[r].tid, (unsigned)event->arg);
+                    break;
+                case TRACE_TASK_START:
+                case TRACE_TASK_END:
+                    fprintf(out, ",\n{\"name\":\"Task %u\",\"cat\":\"task\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"generation\":%u}}",
+                            (unsigned)(event->id & TASK_INDEX_MASK), (event->type == TRACE_TASK_START) ? "B" : "E", ts,
+                            (unsigned)blocks[r].tid, (unsigned)(event->id >> TASK_INDEX_BITS));
+                    break;
+                case TRACE_TIMER_FIRE:
+                    fprintf(out, ",\n{\"name\":\"%sTimer %u\",\"cat\":\"timer\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+                            (event->arg != 0u) ? "HR " : "", (unsigned)event->id, ts, (unsigned)blocks[r].tid);
+                    break;
+                case TRACE_QUEUE_FULL:
+                    fprintf(out, ",\n{\"name\":\"%s of task %u full\",\"cat\":\"queue\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"generation\":%u}}",
+                            (event->arg == TRACE_QUEUE_POOL) ? "Pool inbox" : "Queue", (unsigned)(event->id & TASK_INDEX_MASK),
+                            ts, (unsigned)blocks[r].tid, (unsigned)(event->id >> TASK_INDEX_BITS));
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    fprintf(out, "\n]}\n");
+}
+
+#endif /* APPSCHED_TRACE */
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,107 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef TRACE_H_
+#define TRACE_H_
+
+/**
+ * \file       Trace.h
+ * \brief      Header file for the binary dispatch trace recorder.
+ *
+ * Events are written into a ring buffer owned by the calling thread, so recording needs
+ * no lock. The recorder is compiled only when APPSCHED_TRACE is TRUE (see make trace),
+ * otherwise TRACE_EVENT expands to nothing.
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "Scheduler.h"
+
+/*----------------------------------------------------------------------------*/
+/*                             Defines and macros                             */
+/*----------------------------------------------------------------------------*/
+
+#ifndef APPSCHED_TRACE
+#define APPSCHED_TRACE          FALSE       /*!< TRUE to record the dispatch trace */
+#endif
+
+#define TRACE_EVENTS_N          65536u      /*!< Events per thread ring, power of two, oldest are overwritten */
+#define TRACE_THREADS_N         16u         /*!< Maximum number of threads that record events */
+
+#define TRACE_TICK              0u          /*!< The loop woke up, arg is the tick count */
+#define TRACE_TASK_START        1u          /*!< A task function starts, id is the task ID with its generation */
+#define TRACE_TASK_END          2u          /*!< A task function returned, id is the task ID with its generation */
+#define TRACE_TIMER_FIRE        3u          /*!< A timer expired, id is the timer slot + 1, arg 1 for a high resolution timer */
+#define TRACE_QUEUE_FULL        4u          /*!< A queue of the scheduler was full, id is the task ID it feeds, arg the queue kind */
+
+#define TRACE_QUEUE_POOL        0u          /*!< Queue kind, the inbox of a pool worker */
+#define TRACE_QUEUE_EVENT       1u          /*!< Queue kind, the queue of an event task, a pipeline stage or a bus subscriber */
+
+#if (APPSCHED_TRACE == TRUE)
+#define TRACE_EVENT(type, id, arg)  AppTrace_record((type), (id), (arg))
+#else
+#define TRACE_EVENT(type, id, arg)
+#endif
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Structure to represent one trace event, 24 bytes
+ */
+typedef struct _AppTrace_Event
+{
+    uint64_t time;                      /*!< Monotonic time in ns */
+    uint32_t type;                      /*!< TRACE_TICK, TRACE_TASK_START, ... */
+    uint32_t id;                        /*!< Task or timer ID, a task ID keeps its generation */
+    uint32_t arg;                       /*!< Extra value that depends on the type */
+} AppTrace_Event;
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+#if (APPSCHED_TRACE == TRUE)
+
+/**
+ * @brief Records one event in the ring of the calling thread
+ * 
+ * @param type Event type
+ * @param id Task or timer ID
+ * @param arg Extra value
+ */
+void AppTrace_record(uint32_t type, uint32_t id, uint32_t arg);
+
+/**
+ * @brief Writes the raw events of every thread to a binary file
+ * 
+ * Must be called once the threads stopped recording, for example after AppSched_startScheduler.
+ * 
+ * @param path File to write
+ * @return uint8_t TRUE if the file was written, FALSE otherwise
+ */
+uint8_t AppTrace_dumpBinary(const char *path);
+
+/**
+ * @brief Writes the events of every thread as Chrome Trace Event JSON
+ * 
+ * The file can be opened with ui.perfetto.dev or chrome://tracing.
+ * 
+ * @param path File to write
+ * @return uint8_t TRUE if the file was written, FALSE otherwise
+ */
+uint8_t AppTrace_exportChrome(const char *path);
+
+/**
+ * @brief Converts a file written by AppTrace_dumpBinary into Chrome Trace Event JSON
+ * 
+ * @param binPath Binary trace to read
+ * @param jsonPath JSON file to write
+ * @return uint8_t TRUE if the file was converted, FALSE otherwise
+ */
+uint8_t AppTrace_convertBinary(const char *binPath, const char *jsonPath);
+
+#endif /* APPSCHED_TRACE */
+
+#endif /* TRACE_H_ */
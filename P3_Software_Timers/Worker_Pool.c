@@ -0,0 +1,393 @@
+/**
+ * \file       Worker_Pool.c
+ * \brief      Implementation for the work-stealing Worker Pool
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include "Scheduler.h"
+#include "Worker_Pool.h"
+
+/*----------------------------------------------------------------------------*/
+/*                               Local defines                                */
+/*----------------------------------------------------------------------------*/
+
+#define DEQUE_MASK              (POOL_DEQUE_N - 1u)
+#define INBOX_MASK              (POOL_INBOX_N - 1u)
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of Global Variables                      */
+/*----------------------------------------------------------------------------*/
+
+static _Thread_local AppPool_Worker *Self;  /* Worker of the calling thread, NULL elsewhere */
+
+/*----------------------------------------------------------------------------*/
+/*                       Declaration of local functions                       */
+/*----------------------------------------------------------------------------*/
+static uint8_t AppPool_push( AppPool_Worker *worker, uint64_t job, uint8_t *first );
+static uint8_t AppPool_take( AppPool_Worker *worker, uint64_t *job );
+static uint8_t AppPool_steal( AppPool_Worker *victim, uint64_t *job );
+static uint8_t AppPool_findJob( AppPool_Worker *worker, uint64_t *job );
+static void AppPool_run( AppPool_Worker *worker, uint64_t job );
+static void AppPool_drainInbox( AppPool_Worker *worker );
+static void AppPool_wake( AppPool_Pool *pool, uint8_t all );
+static void *AppPool_workerThread( void *arg );
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of functions                            */
+/*----------------------------------------------------------------------------*/
+
+uint8_t AppPool_initPool( AppPool_Pool *pool )
+{
+    uint8_t init_status = TRUE;
+
+    if ((pool->workers == 0u) || (pool->workers > POOL_WORKERS_N) || (pool->runFunc == NULL))
+    {
+        return FALSE;
+    }
+
+    pool->next = 0;
+    pool->epoch = 0;
+    atomic_init(&pool->pending, 0u);
+    atomic_init(&pool->sleepers, 0u);
+    atomic_init(&pool->running, TRUE);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+
+    for (uint8_t w = 0; w < pool->workers; w++)
+    {
+        AppPool_Worker *worker = &pool->worker[w];
+
+        atomic_init(&worker->top, 0);
+        atomic_init(&worker->bottom, 0);
+        atomic_init(&worker->inHead, 0u);
+        atomic_init(&worker->inTail, 0u);
+        worker->pool = pool;
+        worker->id = w;
+        worker->executed = 0;
+        worker->stolen = 0;
+    }
+
+    for (uint8_t w = 0; w < pool->workers; w++)
+    {
+        if (pthread_create(&pool->worker[w].thread, NULL, AppPool_workerThread, &pool->worker[w]) != 0)
+        {
+            pool->workers = w;  /* Only the threads created so far are joined */
+            AppPool_stopPool(pool);
+            init_status = FALSE;
+            break;
+        }
+    }
+
+    return init_status;
+}
+
+uint8_t AppPool_submit( AppPool_Pool *pool, uint64_t job, uint8_t worker )
+{
+    AppPool_Worker *target;
+    uint32_t head;
+    uint32_t tail;
+
+    if (worker == POOL_ANY_WORKER)
+    {
+        target = &pool->worker[pool->next];
+        pool->next = (uint8_t)((pool->next + 1u) % pool->workers);
+    }
+    else if (worker < pool->workers)
+    {
+        target = &pool->worker[worker];
+        job |= POOL_JOB_PINNED;
+    }
+    else
+    {
+        return FALSE;   /* No such worker */
+    }
+
+    head = atomic_load_explicit(&target->inHead, memory_order_relaxed);
+    tail = atomic_load_explicit(&target->inTail, memory_order_acquire);
+    if ((head - tail) >= POOL_INBOX_N)
+    {
+        return FALSE;   /* Inbox full, the caller decides to run it or drop it */
+    }
+
+    atomic_fetch_add_explicit(&pool->pending, 1u, memory_order_relaxed);
+    target->inbox[head & INBOX_MASK] = job;
+    atomic_store_explicit(&target->inHead, head + 1u, memory_order_release);
+
+    return TRUE;
+}
+
+uint8_t AppPool_spawn( AppPool_Pool *pool, uint64_t job )
+{
+    AppPool_Worker *worker = Self;
+    uint8_t first;
+
+    if ((worker == NULL) || (worker->pool != pool))
+    {
+        return FALSE;   /* The scheduler thread submits instead */
+    }
+
+    atomic_fetch_add_explicit(&pool->pending, 1u, memory_order_relaxed);
+    if (AppPool_push(worker, job, &first) == FALSE)
+    {
+        atomic_fetch_sub_explicit(&pool->pending, 1u, memory_order_relaxed);
+        return FALSE;
+    }
+
+    /* A job pushed behind others was announced with the first one */
+    if (first == TRUE)
+    {
+        AppPool_wake(pool, FALSE);
+    }
+
+    return TRUE;
+}
+
+void AppPool_signal( AppPool_Pool *pool )
+{
+    AppPool_wake(pool, TRUE);
+}
+
+void AppPool_waitIdle( AppPool_Pool *pool )
+{
+    while (atomic_load_explicit(&pool->pending, memory_order_acquire) != 0u)
+    {
+        sched_yield();
+    }
+}
+
+void AppPool_stopPool( AppPool_Pool *pool )
+{
+    atomic_store(&pool->running, FALSE);
+    AppPool_signal(pool);
+
+    for (uint8_t w = 0; w < pool->workers; w++)
+    {
+        pthread_join(pool->worker[w].thread, NULL);
+    }
+
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+/*----------------------------------------------------------------------------*/
+/*                     Implementation of local functions                      */
+/*----------------------------------------------------------------------------*/
+
+/* Chase-Lev deque: only the owner pushes and takes at the bottom, any worker steals at the top */
+static uint8_t AppPool_push( AppPool_Worker *worker, uint64_t job, uint8_t *first )
+{
+    int64_t b = atomic_load_explicit(&worker->bottom, memory_order_relaxed);
+    int64_t t = atomic_load_explicit(&worker->top, memory_order_acquire);
+
+    if ((b - t) >= (int64_t)POOL_DEQUE_N)
+    {
+        return FALSE;
+    }
+
+    atomic_store_explicit(&worker->deque[b & DEQUE_MASK], job, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&worker->bottom, b + 1, memory_order_relaxed);
+    *first = (b == t) ? TRUE : FALSE;
+
+    return TRUE;
+}
+
+static uint8_t AppPool_take( AppPool_Worker *worker, uint64_t *job )
+{
+    uint8_t take_status = TRUE;
+    int64_t b = atomic_load_explicit(&worker->bottom, memory_order_relaxed) - 1;
+    int64_t t;
+
+    atomic_store_explicit(&worker->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    t = atomic_load_explicit(&worker->top, memory_order_relaxed);
+
+    if (t <= b)
+    {
+        *job = atomic_load_explicit(&worker->deque[b & DEQUE_MASK], memory_order_relaxed);
+        if (t == b)
+        {
+            /* Last job, race against the thieves for it */
+            if (!atomic_compare_exchange_strong_explicit(&worker->top, &t, t + 1,
+                                                         memory_order_seq_cst, memory_order_relaxed))
+            {
+                take_status = FALSE;
+            }
+            atomic_store_explicit(&worker->bottom, b + 1, memory_order_relaxed);
+        }
+    }
+    else
+    {
+        take_status = FALSE;    /* Deque empty */
+        atomic_store_explicit(&worker->bottom, b + 1, memory_order_relaxed);
+    }
+
+    return take_status;
+}
+
+static uint8_t AppPool_steal( AppPool_Worker *victim, uint64_t *job )
+{
+    int64_t t = atomic_load_explicit(&victim->top, memory_order_acquire);
+    int64_t b;
+
+    atomic_thread_fence(memory_order_seq_cst);
+    b = atomic_load_explicit(&victim->bottom, memory_order_acquire);
+
+    if (t >= b)
+    {
+        return FALSE;
+    }
+
+    *job = atomic_load_explicit(&victim->deque[t & DEQUE_MASK], memory_order_relaxed);
+
+    return atomic_compare_exchange_strong_explicit(&victim->top, &t, t + 1,
+                                                   memory_order_seq_cst, memory_order_relaxed) ? TRUE : FALSE;
+}
+
+static uint8_t AppPool_findJob( AppPool_Worker *worker, uint64_t *job )
+{
+    AppPool_Pool *pool = worker->pool;
+
+    AppPool_drainInbox(worker);
+
+    if (AppPool_take(worker, job) == TRUE)
+    {
+        return TRUE;
+    }
+
+    /* Own work is done, try the other workers starting with the next one */
+    for (uint8_t i = 1; i < pool->workers; i++)
+    {
+        AppPool_Worker *victim = &pool->worker[(worker->id + i) % pool->workers];
+
+        if (AppPool_steal(victim, job) == TRUE)
+        {
+            worker->stolen++;
+
+            /* One sleeper is woken per job left behind, it wakes the next one if it steals too */
+            if (atomic_load_explicit(&victim->bottom, memory_order_relaxed) > atomic_load_explicit(&victim->top, memory_order_relaxed))
+            {
+                AppPool_wake(pool, FALSE);
+            }
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+static void AppPool_run( AppPool_Worker *worker, uint64_t job )
+{
+    AppPool_Pool *pool = worker->pool;
+
+    pool->runFunc(pool->owner, job & ~POOL_JOB_PINNED);
+    worker->executed++;
+    atomic_fetch_sub_explicit(&pool->pending, 1u, memory_order_release);
+}
+
+static void AppPool_drainInbox( AppPool_Worker *worker )
+{
+    uint32_t tail = atomic_load_explicit(&worker->inTail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&worker->inHead, memory_order_acquire);
+    uint64_t job;
+    uint8_t first;
+
+    while (tail != head)
+    {
+        job = worker->inbox[tail & INBOX_MASK];
+        tail++;
+        atomic_store_explicit(&worker->inTail, tail, memory_order_release);
+
+        /* Pinned jobs never become stealable, a full deque also runs the job right away */
+        if (((job & POOL_JOB_PINNED) != 0u) || (AppPool_push(worker, job, &first) == FALSE))
+        {
+            AppPool_run(worker, job);
+        }
+        else if (first == TRUE)
+        {
+            /* The deque was empty, a sleeping worker can take the jobs this one does not reach */
+            AppPool_wake(worker->pool, FALSE);
+        }
+    }
+}
+
+static void AppPool_wake( AppPool_Pool *pool, uint8_t all )
+{
+    /* Pairs with the sleeper that counts itself before it looks for jobs a last time: either
+       it sees the new job or this sees it, so the lock is only taken for a real sleeper */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&pool->sleepers, memory_order_relaxed) == 0u)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->epoch++;
+    if (all == TRUE)
+    {
+        pthread_cond_broadcast(&pool->wake);
+    }
+    else
+    {
+        pthread_cond_signal(&pool->wake);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void *AppPool_workerThread( void *arg )
+{
+    AppPool_Worker *worker = (AppPool_Worker *)arg;
+    AppPool_Pool *pool = worker->pool;
+    uint64_t job;
+    uint32_t seen;
+
+    Self = worker;
+
+    for (;;)
+    {
+        if (AppPool_findJob(worker, &job) == TRUE)
+        {
+            AppPool_run(worker, job);
+            continue;
+        }
+
+        if (atomic_load(&pool->running) == FALSE)
+        {
+            break;
+        }
+
+        /* Count as a sleeper, take the epoch and look once more: a job queued after this
+           point finds the sleeper and changes the epoch */
+        pthread_mutex_lock(&pool->lock);
+        atomic_fetch_add(&pool->sleepers, 1u);
+        seen = pool->epoch;
+        pthread_mutex_unlock(&pool->lock);
+
+        if (AppPool_findJob(worker, &job) == TRUE)
+        {
+            atomic_fetch_sub(&pool->sleepers, 1u);
+            AppPool_run(worker, job);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while ((pool->epoch == seen) && (atomic_load(&pool->running) == TRUE))
+        {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        atomic_fetch_sub(&pool->sleepers, 1u);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             END OF FILE                                    */
+/*----------------------------------------------------------------------------*/
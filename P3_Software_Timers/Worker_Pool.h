@@ -0,0 +1,136 @@
+/* ---- Headerswitch on (for prevention of nested includes) ------------------*/
+#ifndef WORKER_POOL_H_
+#define WORKER_POOL_H_
+
+/**
+ * \file       Worker_Pool.h
+ * \brief      Header file for the work-stealing Worker Pool.
+ */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Includes                                   */
+/*----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/*----------------------------------------------------------------------------*/
+/*                             Defines and macros                             */
+/*----------------------------------------------------------------------------*/
+
+#define POOL_WORKERS_N          8u          /*!< Maximum number of worker threads */
+#define POOL_DEQUE_N            1024u       /*!< Jobs per worker deque, power of two */
+#define POOL_INBOX_N            1024u       /*!< Jobs per worker inbox, power of two */
+#define POOL_ANY_WORKER         0xFFu       /*!< The job can run on any worker */
+#define POOL_JOB_PINNED         (1ull << 63) /*!< Job bit, the job never leaves the worker it was sent to */
+
+/*----------------------------------------------------------------------------*/
+/*                                 Data types                                 */
+/*----------------------------------------------------------------------------*/
+
+struct _AppPool_Pool;
+
+/**
+ * @brief Structure to represent one worker thread
+ *
+ * The scheduler thread only writes into the inbox (single producer, single consumer).
+ * The worker moves the jobs into its own deque, works from the bottom of it, and idle
+ * workers steal from the top (Chase-Lev deque).
+ */
+typedef struct _AppPool_Worker
+{
+    _Atomic int64_t top;                    /*!< Steal end of the deque */
+    _Atomic int64_t bottom;                 /*!< Owner end of the deque */
+    _Atomic uint64_t deque[POOL_DEQUE_N];   /*!< Stealable jobs */
+    _Atomic uint32_t inHead;                /*!< Next inbox slot to write (scheduler thread) */
+    _Atomic uint32_t inTail;                /*!< Next inbox slot to read (worker thread) */
+    uint64_t inbox[POOL_INBOX_N];           /*!< Jobs sent by the scheduler thread */
+    struct _AppPool_Pool *pool;             /*!< Pool the worker belongs to */
+    pthread_t thread;                       /*!< Worker thread */
+    uint8_t id;                             /*!< Worker index */
+    uint64_t executed;                      /*!< Jobs executed by this worker */
+    uint64_t stolen;                        /*!< Jobs this worker stole from other workers */
+} AppPool_Worker;
+
+/**
+ * @brief Structure to represent the worker pool
+ */
+typedef struct _AppPool_Pool
+{
+    uint8_t workers;                        /*!< Number of worker threads to use */
+    void *owner;                            /*!< Context given back to runFunc */
+    void (*runFunc)(void *owner, uint64_t job); /*!< Function that executes a job */
+    AppPool_Worker worker[POOL_WORKERS_N];  /*!< Worker control blocks */
+    uint8_t next;                           /*!< Round robin index for jobs without a worker */
+    _Atomic uint64_t pending;               /*!< Jobs submitted and not finished yet */
+    _Atomic uint32_t sleepers;              /*!< Workers waiting or about to wait for new jobs */
+    _Atomic uint8_t running;                /*!< FALSE asks the workers to exit once idle */
+    uint32_t epoch;                         /*!< Incremented on every signal, protected by lock */
+    pthread_mutex_t lock;                   /*!< Protects epoch for the sleeping workers */
+    pthread_cond_t wake;                    /*!< Wakes up sleeping workers */
+} AppPool_Pool;
+
+/*----------------------------------------------------------------------------*/
+/*                           Declaration of functions                         */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Starts the worker threads
+ *
+ * The fields workers, owner and runFunc have to be set before calling this function.
+ *
+ * @param pool Pointer to the pool
+ * @return uint8_t TRUE if all the threads were created, FALSE otherwise
+ */
+uint8_t AppPool_initPool( AppPool_Pool *pool );
+
+/**
+ * @brief Sends a job to the pool
+ *
+ * Must always be called from the same thread (the scheduler thread). The job is a 63 bit value
+ * interpreted by runFunc. Call AppPool_signal once the jobs of a dispatch round were submitted.
+ *
+ * @param pool Pointer to the pool
+ * @param job Job value given to runFunc
+ * @param worker Worker to run the job, POOL_ANY_WORKER lets the pool balance it
+ * @return uint8_t TRUE if the job was queued, FALSE if the inbox of the worker is full or the pool has no such worker
+ */
+uint8_t AppPool_submit( AppPool_Pool *pool, uint64_t job, uint8_t worker );
+
+/**
+ * @brief Sends a job from inside a running job to the deque of the current worker
+ *
+ * Lets a job start the jobs that depend on it without going through the scheduler thread.
+ * The other workers can steal it. A sleeping worker is woken up when the deque was empty,
+ * a worker that steals wakes the next one while jobs are left.
+ *
+ * @param pool Pointer to the pool
+ * @param job Job value given to runFunc
+ * @return uint8_t TRUE if the job was queued, FALSE if not called from a worker or its deque is full
+ */
+uint8_t AppPool_spawn( AppPool_Pool *pool, uint64_t job );
+
+/**
+ * @brief Wakes up the workers sleeping for new jobs
+ *
+ * Lock-free when no worker sleeps.
+ *
+ * @param pool Pointer to the pool
+ */
+void AppPool_signal( AppPool_Pool *pool );
+
+/**
+ * @brief Waits until every submitted job has finished
+ *
+ * @param pool Pointer to the pool
+ */
+void AppPool_waitIdle( AppPool_Pool *pool );
+
+/**
+ * @brief Finishes the pending jobs and joins the worker threads
+ *
+ * @param pool Pointer to the pool
+ */
+void AppPool_stopPool( AppPool_Pool *pool );
+
+#endif /* WORKER_POOL_H_ */